@@ -25,7 +25,9 @@
 
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/api_worker_pool.hpp>
 #include <graphene/app/application.hpp>
+#include <graphene/account_history/account_history_plugin.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/get_config.hpp>
 #include <graphene/utilities/key_conversion.hpp>
@@ -73,11 +75,22 @@ namespace graphene { namespace app {
        return true;
     }
 
+    /// database_api methods that register callbacks or write, they stay on the thread applying blocks
+    static const std::set<std::string> database_api_main_thread_methods = {
+       "set_subscribe_callback", "set_pending_transaction_callback", "set_block_applied_callback",
+       "cancel_all_subscriptions", "subscribe_to_market", "unsubscribe_from_market", "validate_transaction"
+    };
+
     void login_api::enable_api( const std::string& api_name )
     {
+       api_worker_pool* workers = _app.get_api_worker_pool();
        if( api_name == "database_api" )
        {
-          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ), &( _app.get_options() ) );
+          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ), &( _app.get_options() ),
+                                                            _app.get_notification_cache(), _app.get_subscription_router(),
+                                                            _app.get_object_cache() );
+          if( workers )
+             workers->offload( *_database_api, database_api_main_thread_methods );
        }
        else if( api_name == "network_broadcast_api" )
        {
@@ -86,6 +99,8 @@ namespace graphene { namespace app {
        else if( api_name == "history_api" )
        {
           _history_api = std::make_shared< history_api >( _app );
+          if( workers )
+             workers->offload( *_history_api, {} );
        }
        else if( api_name == "network_node_api" )
        {
@@ -203,6 +218,21 @@ namespace graphene { namespace app {
        return _app.p2p_node()->set_advanced_node_parameters(params);
     }
 
+    void network_node_api::set_apply_profiling( bool enabled )
+    {
+       _app.chain_database()->get_apply_profiler().enable( enabled );
+    }
+
+    void network_node_api::reset_apply_profile()
+    {
+       _app.chain_database()->get_apply_profiler().reset();
+    }
+
+    apply_profile network_node_api::get_apply_profile() const
+    {
+       return _app.chain_database()->get_apply_profiler().get_profile();
+    }
+
     fc::api<network_broadcast_api> login_api::network_broadcast()const
     {
        FC_ASSERT(_network_broadcast_api);
@@ -270,7 +300,7 @@ namespace graphene { namespace app {
                                                                        operation_history_id_type start ) const
     {
        return get_account_history_impl(account,
-                                       [](const account_transaction_history_object*) { return true; },
+                                       [](const operation_history_object&) { return true; },
                                        stop,
                                        limit,
                                        start);
@@ -282,14 +312,24 @@ namespace graphene { namespace app {
                                                                       unsigned limit,
                                                                       operation_history_id_type start) const
     {
-       FC_ASSERT( _app.chain_database() );
-       const auto& db = *_app.chain_database();
-       return get_account_history_impl(account,
-                                       [&operation_types, &db](const account_transaction_history_object* node) {
-                                           return operation_types.find(node->operation_id(db).op.which()) != operation_types.end(); },
-                                       stop,
-                                       limit,
-                                       start);
+       FC_ASSERT( limit <= 100 );
+       vector<operation_history_object> result;
+       for( uint32_t operation_type : operation_types )
+       {
+          vector<operation_history_object> r = get_account_history_by_type_impl(account,
+                                                                                operation_type,
+                                                                                [](const operation_history_object&) { return true; },
+                                                                                stop,
+                                                                                limit,
+                                                                                start);
+          std::move(r.begin(), r.end(), std::back_inserter(result));
+       }
+       std::sort(result.begin(), result.end(), [](const operation_history_object& a, const operation_history_object& b){
+           return a.id > b.id;
+       });
+       if( result.size() > limit )
+          result.resize(limit);
+       return result;
     }
 
     vector<operation_history_object> history_api::get_trade_history_for_account( asset_id_type base,
@@ -301,19 +341,13 @@ namespace graphene { namespace app {
     {
        FC_ASSERT( _app.chain_database() );
        FC_ASSERT( limit <= 100 );
-       const auto& db = *_app.chain_database();
        auto fill_operation_type = operation(fill_order_operation()).which();
-       auto f = [&fill_operation_type, &db](const account_transaction_history_object* node, asset_id_type base, asset_id_type quote) {
-           auto& op = node->operation_id(db).op;
-           if(op.which() == fill_operation_type)
-           {
-               fill_order_operation fop = op.get<fill_order_operation>();
-               return fop.pays.asset_id == base && fop.receives.asset_id == quote;
-           }
-           return false;
+       auto f = [](const operation_history_object& op, asset_id_type base, asset_id_type quote) {
+           const fill_order_operation& fop = op.op.get<fill_order_operation>();
+           return fop.pays.asset_id == base && fop.receives.asset_id == quote;
        };
-       vector<operation_history_object> r1 = get_account_history_impl(account, std::bind(f, std::placeholders::_1, base, quote), stop, limit, start);
-       vector<operation_history_object> r2 = get_account_history_impl(account, std::bind(f, std::placeholders::_1, quote, base), stop, limit, start);
+       vector<operation_history_object> r1 = get_account_history_by_type_impl(account, fill_operation_type, std::bind(f, std::placeholders::_1, base, quote), stop, limit, start);
+       vector<operation_history_object> r2 = get_account_history_by_type_impl(account, fill_operation_type, std::bind(f, std::placeholders::_1, quote, base), stop, limit, start);
        vector<operation_history_object> result(r1);
        std::move(r2.begin(), r2.end(), std::back_inserter(result));
        std::sort(result.begin(), result.end(), [](const operation_history_object& a, const operation_history_object& b){
@@ -337,14 +371,37 @@ namespace graphene { namespace app {
        const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
        const auto& by_seq_idx = hist_idx.indices().get<by_seq>();
 
+       // the oldest node of the range (the first one at or above stop) is not returned; when the
+       // account has irreversible history on disk reaching stop, that node is on disk
+       const auto* store = get_history_store();
+       uint64_t disk_position = store ? store->newest_record( account ) : 0;
+       const uint64_t in_memory_from = oldest_operation_in_memory( db, account );
+       while( disk_position != 0 && store->fetch_record( disk_position ).operation >= in_memory_from )
+          disk_position = store->fetch_record( disk_position ).previous;
+       const bool stop_on_disk = disk_position != 0 && store->fetch_record( disk_position ).sequence >= stop;
+
        auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, start ) );
        auto itr_stop = by_seq_idx.lower_bound( boost::make_tuple( account, stop ) );
-       --itr;
-
        while ( itr != itr_stop && result.size() < limit )
        {
-          result.push_back( itr->operation_id(db) );
           --itr;
+          if( itr == itr_stop && !stop_on_disk )
+             break;
+          result.push_back( itr->operation_id(db) );
+       }
+
+       if( !stop_on_disk )
+          return result;
+
+       graphene::account_history::history_store_record record = store->fetch_record( disk_position );
+       while( record.previous != 0 && result.size() < limit )
+       {
+          const graphene::account_history::history_store_record older = store->fetch_record( record.previous );
+          if( older.sequence < stop )
+             break;
+          if( record.sequence <= start )
+             result.push_back( fetch_stored_operation( *store, record.operation ) );
+          record = older;
        }
 
        return result;
@@ -384,7 +441,7 @@ namespace graphene { namespace app {
     } FC_CAPTURE_AND_RETHROW( (a)(b)(bucket_seconds)(start)(end) ) }
 
     vector<operation_history_object> history_api::get_account_history_impl( account_id_type account,
-                                                                            const std::function<bool(const account_transaction_history_object* node)> &selector,
+                                                                            const std::function<bool(const operation_history_object& op)> &selector,
                                                                             operation_history_id_type stop,
                                                                             unsigned limit,
                                                                             operation_history_id_type start ) const
@@ -393,24 +450,146 @@ namespace graphene { namespace app {
         const auto& db = *_app.chain_database();
         FC_ASSERT( limit <= 100 );
         vector<operation_history_object> result;
+        const uint64_t start_instance = start == operation_history_id_type() ? std::numeric_limits<uint64_t>::max()
+                                                                               : start.instance.value;
+
         const auto& stats = account(db).statistics(db);
-        if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
-        const account_transaction_history_object* node = &stats.most_recent_op(db);
-        if( start == operation_history_id_type() )
-            start = node->operation_id;
+        const account_transaction_history_object* node = nullptr;
+        if( stats.most_recent_op != account_transaction_history_id_type() )
+            node = &stats.most_recent_op(db);
 
         while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
         {
-            if( node->operation_id.instance.value <= start.instance.value && selector(node) )
-                result.push_back( node->operation_id(db) );
+            if( node->operation_id.instance.value <= start_instance )
+            {
+                const operation_history_object& op = node->operation_id(db);
+                if( selector(op) )
+                    result.push_back( op );
+            }
             if( node->next == account_transaction_history_id_type() )
                 node = nullptr;
             else node = &node->next(db);
         }
+        if( node != nullptr )
+            return result;
+
+        // the in memory chain ended, older operations of the account are irreversible and on disk
+        const auto* store = get_history_store();
+        if( store == nullptr )
+            return result;
+        const uint64_t in_memory_from = oldest_operation_in_memory( db, account );
+        uint64_t position = store->newest_record( account );
+        while( position != 0 && result.size() < limit )
+        {
+            const graphene::account_history::history_store_record record = store->fetch_record( position );
+            if( record.operation <= stop.instance.value )
+                break;
+            if( record.operation <= start_instance && record.operation < in_memory_from )
+            {
+                const operation_history_object op = fetch_stored_operation( *store, record.operation );
+                if( selector(op) )
+                    result.push_back( op );
+            }
+            position = record.previous;
+        }
 
         return result;
     }
 
+    vector<operation_history_object> history_api::get_account_history_by_type_impl( account_id_type account,
+                                                                                    uint16_t operation_type,
+                                                                                    const std::function<bool(const operation_history_object& op)> &selector,
+                                                                                    operation_history_id_type stop,
+                                                                                    unsigned limit,
+                                                                                    operation_history_id_type start ) const
+    {
+        FC_ASSERT( _app.chain_database() );
+        const auto& db = *_app.chain_database();
+        FC_ASSERT( limit <= 100 );
+        vector<operation_history_object> result;
+        const auto& hist_idx = db.get_index_type<account_transaction_history_index>().indices();
+        const uint64_t start_instance = start == operation_history_id_type() ? std::numeric_limits<uint64_t>::max()
+                                                                               : start.instance.value;
+
+        // operation ids grow with the account sequence, so translate start into the sequence of
+        // the newest node of the account not newer than start
+        bool in_memory = true;
+        uint32_t start_sequence = std::numeric_limits<uint32_t>::max();
+        if( start != operation_history_id_type() )
+        {
+            const auto& by_op_idx = hist_idx.get<by_op>();
+            auto op_itr = by_op_idx.upper_bound( boost::make_tuple( account, start ) );
+            if( op_itr == by_op_idx.begin() || (--op_itr)->account != account )
+                in_memory = false;
+            else
+                start_sequence = op_itr->sequence;
+        }
+
+        if( in_memory )
+        {
+            const auto& by_type_idx = hist_idx.get<by_op_type>();
+            auto range_begin = by_type_idx.lower_bound( boost::make_tuple( account, operation_type ) );
+            auto itr = by_type_idx.upper_bound( boost::make_tuple( account, operation_type, start_sequence ) );
+            while( itr != range_begin && result.size() < limit )
+            {
+                --itr;
+                if( itr->operation_id.instance.value <= stop.instance.value )
+                    return result;
+                const operation_history_object& op = itr->operation_id(db);
+                if( selector(op) )
+                    result.push_back( op );
+            }
+            if( itr != range_begin )
+                return result;
+        }
+
+        // continue with the irreversible operations of this type on disk
+        const auto* store = get_history_store();
+        if( store == nullptr )
+            return result;
+        const uint64_t in_memory_from = oldest_operation_in_memory( db, account );
+        uint64_t position = store->newest_record( account, operation_type );
+        while( position != 0 && result.size() < limit )
+        {
+            const graphene::account_history::history_store_record record = store->fetch_record( position );
+            if( record.operation <= stop.instance.value )
+                break;
+            if( record.operation <= start_instance && record.operation < in_memory_from )
+            {
+                const operation_history_object op = fetch_stored_operation( *store, record.operation );
+                if( selector(op) )
+                    result.push_back( op );
+            }
+            position = record.previous_of_type;
+        }
+
+        return result;
+    }
+
+    const graphene::account_history::history_store* history_api::get_history_store()const
+    {
+        auto plugin = _app.get_plugin<graphene::account_history::account_history_plugin>( "account_history" );
+        return plugin ? plugin->get_history_store() : nullptr;
+    }
+
+    operation_history_object history_api::fetch_stored_operation( const graphene::account_history::history_store& store,
+                                                                  uint64_t operation_instance )
+    {
+        const operation_history_id_type id( operation_instance );
+        optional<operation_history_object> op = store.fetch_operation( id );
+        FC_ASSERT( op.valid(), "Operation ${id} is referenced by the account history store but missing from it", ("id", id) );
+        return *op;
+    }
+
+    uint64_t history_api::oldest_operation_in_memory( const graphene::chain::database& db, account_id_type account )
+    {
+        const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+        auto itr = by_seq_idx.lower_bound( boost::make_tuple( account, 0 ) );
+        if( itr == by_seq_idx.end() || itr->account != account )
+            return std::numeric_limits<uint64_t>::max();
+        return itr->operation_id.instance.value;
+    }
+
     crypto_api::crypto_api(){};
 
     blind_factor_type crypto_api::blind_sum( const std::vector<blind_factor_type>& blinds_in, uint32_t non_neg )
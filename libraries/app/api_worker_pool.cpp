@@ -0,0 +1,47 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/app/api_worker_pool.hpp>
+
+namespace graphene { namespace app {
+
+api_worker_pool::api_worker_pool( const chain::database& db, uint32_t thread_count )
+   : _db( db ), _next_thread( 0 )
+{
+   FC_ASSERT( thread_count > 0 );
+   for( uint32_t i = 0; i < thread_count; ++i )
+      _threads.emplace_back( new fc::thread( "api_worker_" + fc::to_string( i ) ) );
+}
+
+api_worker_pool::~api_worker_pool()
+{
+   for( const auto& thread : _threads )
+      thread->quit();
+}
+
+fc::thread& api_worker_pool::next_worker()
+{
+   return *_threads[ _next_thread++ % _threads.size() ];
+}
+
+} } // graphene::app
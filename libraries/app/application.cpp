@@ -24,8 +24,10 @@
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
 #include <graphene/app/application.hpp>
+#include <graphene/app/json_api_connection.hpp>
 #include <graphene/app/plugin.hpp>
 
+#include <graphene/chain/chain_property_object.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/protocol/types.hpp>
@@ -251,9 +253,9 @@ std::vector<fc::ip::endpoint> application_impl::resolve_string_to_ip_endpoints(c
 
 void application_impl::new_connection( const fc::http::websocket_connection_ptr& c )
 {
-   auto wsc = std::make_shared<fc::rpc::websocket_api_connection>(*c, GRAPHENE_NET_MAX_NESTED_OBJECTS);
    auto login = std::make_shared<graphene::app::login_api>( std::ref(*_self) );
    login->enable_api("database_api");
+   auto wsc = std::make_shared<json_api_connection>(*c, GRAPHENE_NET_MAX_NESTED_OBJECTS, login->database());
 
    wsc->register_api(login->database());
    wsc->register_api(fc::api<graphene::app::login_api>(login));
@@ -390,6 +392,23 @@ void application_impl::startup()
    }
    _chain_db->add_checkpoints( loaded_checkpoints );
 
+   if( _options->count("virtual-op-retention-blocks") )
+      _chain_db->set_virtual_op_retention( _options->at("virtual-op-retention-blocks").as<uint32_t>() );
+
+   if( _options->count("chain-worker-threads") )
+      _chain_db->set_worker_threads( _options->at("chain-worker-threads").as<uint32_t>() );
+
+   if( _options->count("track-state-digest") && _options->at("track-state-digest").as<bool>() )
+      _chain_db->track_state_digest( true );
+
+   if( _options->count("fork-changes-retention-mb") )
+      _chain_db->set_fork_changes_retention( size_t( _options->at("fork-changes-retention-mb").as<uint32_t>() ) * 1024 * 1024 );
+
+   if( _options->count("apply-profile") )
+      _chain_db->get_apply_profiler().enable( true );
+   if( _options->count("apply-profile-replay-dump") )
+      _chain_db->set_apply_profile_replay_dump( _options->at("apply-profile-replay-dump").as<boost::filesystem::path>() );
+
    if( _options->count("replay-blockchain") )
       _chain_db->wipe( _data_dir / "blockchain", false );
 
@@ -442,6 +461,24 @@ void application_impl::startup()
       _apiaccess.permission_map["*"] = wild_access;
    }
 
+   if( _options->count("api-worker-threads") && _options->at("api-worker-threads").as<uint32_t>() > 0 )
+   {
+      _api_workers.reset( new api_worker_pool( *_chain_db, _options->at("api-worker-threads").as<uint32_t>() ) );
+      ilog( "Running read-only API calls on ${n} worker threads", ("n", _api_workers->thread_count()) );
+   }
+   _notification_cache = std::make_shared<notification_cache>( *_chain_db );
+   _subscription_router = std::make_shared<subscription_router>( *_chain_db );
+   _object_cache = std::make_shared<object_cache>( _options->count("object-cache-size")
+                                                   ? _options->at("object-cache-size").as<uint32_t>()
+                                                   : object_cache::default_capacity );
+   _object_cache->observe<chain::global_property_object>( *_chain_db );
+   _object_cache->observe<chain::dynamic_global_property_object>( *_chain_db );
+   _object_cache->observe<chain::chain_property_object>( *_chain_db );
+   _object_cache->observe<chain::asset_object>( *_chain_db );
+   _object_cache->observe<chain::asset_dynamic_data_object>( *_chain_db );
+   _object_cache->observe<chain::license_type_object>( *_chain_db );
+   _object_cache->observe<chain::account_object>( *_chain_db );
+
    reset_p2p_node(_data_dir);
    reset_websocket_server();
    reset_websocket_tls_server();
@@ -939,6 +976,18 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
          ("plugins", bpo::value<string>(), "Space-separated list of plugins to activate")
          ("io-threads", bpo::value<uint16_t>()->implicit_value(0), "Number of IO threads, default to 0 for auto-configuration")
+         ("api-worker-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads running read-only API calls, 0 runs them on the thread applying blocks")
+         ("object-cache-size", bpo::value<uint32_t>()->default_value(graphene::app::object_cache::default_capacity),
+          "Number of encoded objects shared by the API sessions, the least recently read ones are evicted first")
+         ("chain-worker-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads checking the transactions of larger blocks and building large API results, 0 uses one per hardware thread")
+         ("virtual-op-retention-blocks", bpo::value<uint32_t>()->default_value(0),
+          "Number of most recent blocks whose virtual operations are indexed for get_blocks_with_virtual_operations, 0 does not index them and older blocks are looked up in the operation history")
+         ("track-state-digest", bpo::value<bool>()->default_value(false),
+          "Keep a digest of the chain state up to date as objects change, get_state_digest needs it")
+         ("fork-changes-retention-mb", bpo::value<uint32_t>()->default_value(0),
+          "Megabytes of changes kept for the most recent applied blocks, switching back to them after a fork switch redoes the changes instead of applying the blocks, 0 turns this off")
          // TODO uncomment this when GUI is ready
          //("enable-subscribe-to-all", bpo::value<bool>()->implicit_value(false),
          // "Whether allow API clients to subscribe to universal object creation and removal events")
@@ -952,6 +1001,9 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("replay-blockchain", "Rebuild object graph by replaying all blocks")
          ("resync-blockchain", "Delete all blocks and re-sync with network from scratch")
          ("force-validate", "Force validation of all transactions")
+         ("apply-profile", "Time evaluators and block phases from startup, see network_node_api::get_apply_profile")
+         ("apply-profile-replay-dump", bpo::value<boost::filesystem::path>(),
+          "File that receives the apply profile of every block replayed at startup as a line of JSON")
          ("genesis-timestamp", bpo::value<uint32_t>(),
           "Replace timestamp from genesis.json with current time plus this many seconds (experts only!)")
          ;
@@ -1118,5 +1170,30 @@ const application_options& application::get_options()
    return my->_app_options;
 }
 
+const fc::path& application::data_dir()const
+{
+   return my->_data_dir;
+}
+
+api_worker_pool* application::get_api_worker_pool()const
+{
+   return my->_api_workers.get();
+}
+
+std::shared_ptr<notification_cache> application::get_notification_cache()const
+{
+   return my->_notification_cache;
+}
+
+std::shared_ptr<subscription_router> application::get_subscription_router()const
+{
+   return my->_subscription_router;
+}
+
+std::shared_ptr<object_cache> application::get_object_cache()const
+{
+   return my->_object_cache;
+}
+
 // namespace detail
 } }
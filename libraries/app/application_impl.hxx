@@ -3,6 +3,10 @@
 #include <fc/network/http/websocket.hpp>
 #include <graphene/app/application.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/api_worker_pool.hpp>
+#include <graphene/app/notification_cache.hpp>
+#include <graphene/app/object_cache.hpp>
+#include <graphene/app/subscription_router.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/net/message.hpp>
@@ -189,6 +193,10 @@ class application_impl : public net::node_delegate
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
+      std::unique_ptr<api_worker_pool>                 _api_workers;
+      std::shared_ptr<notification_cache>              _notification_cache;
+      std::shared_ptr<subscription_router>             _subscription_router;
+      std::shared_ptr<object_cache>                    _object_cache;
 
       std::map<string, std::shared_ptr<abstract_plugin>> _active_plugins;
       std::map<string, std::shared_ptr<abstract_plugin>> _available_plugins;
@@ -30,8 +30,6 @@
 #include <graphene/chain/withdrawal_limit_object.hpp>
 #include <graphene/chain/issued_asset_record_object.hpp>
 
-#include <fc/bloom_filter.hpp>
-
 #include <fc/crypto/hex.hpp>
 #include <fc/uint128.hpp>
 
@@ -44,6 +42,7 @@
 
 #include <cfenv>
 #include <iostream>
+#include <mutex>
 
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
 
@@ -54,10 +53,14 @@ typedef std::map< std::pair<graphene::chain::asset_id_type, graphene::chain::ass
 class database_api_impl;
 
 
-class database_api_impl : public std::enable_shared_from_this<database_api_impl>
+class database_api_impl : public std::enable_shared_from_this<database_api_impl>,
+                          public subscription_router::subscriber
 {
    public:
-      explicit database_api_impl( graphene::chain::database& db, const application_options* app_options );
+      database_api_impl( graphene::chain::database& db, const application_options* app_options,
+                         std::shared_ptr<notification_cache> notifications,
+                         std::shared_ptr<subscription_router> router,
+                         std::shared_ptr<object_cache> objects );
       ~database_api_impl();
 
       // Objects
@@ -68,6 +71,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void set_pending_transaction_callback( std::function<void(const variant&)> cb );
       void set_block_applied_callback( std::function<void(const variant& block_id)> cb );
       void cancel_all_subscriptions();
+      notification_metrics get_notification_metrics()const;
 
       // Blocks and transactions
       optional<block_header> get_block_header(uint32_t block_num)const;
@@ -77,6 +81,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<signed_block_with_virtual_operations_and_num> get_blocks_with_virtual_operations(uint32_t start_block_num,
                                                                                               uint32_t count,
                                                                                               std::vector<uint16_t>& virtual_operation_ids) const;
+      vector<raw_block> get_raw_blocks(uint32_t start_block_num, uint32_t count) const;
       processed_transaction get_transaction( uint32_t block_num, uint32_t trx_in_block )const;
 
       // Globals
@@ -85,6 +90,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       fc::variant_object get_config()const;
       chain_id_type get_chain_id()const;
       dynamic_global_property_object get_dynamic_global_properties()const;
+      state_digest get_state_digest()const;
       optional<total_cycles_res> get_total_cycles() const;
       optional<queue_projection_res> get_queue_projection() const;
 
@@ -94,6 +100,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       // Accounts
       vector<optional<account_object>> get_accounts(const vector<account_id_type>& account_ids)const;
       std::map<string,full_account> get_full_accounts( const vector<string>& names_or_ids, bool subscribe );
+      std::map<string,full_account> get_full_accounts_with_sections( const vector<string>& names_or_ids,
+                                                                     const vector<string>& sections, bool subscribe );
       optional<account_object> get_account_by_name( string name )const;
       vector<account_id_type> get_account_references( account_id_type account_id )const;
       vector<optional<account_object>> lookup_account_names(const vector<string>& account_names)const;
@@ -192,6 +200,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       // Vault info:
       optional<vault_info_res> get_vault_info(account_id_type vault_id) const;
       vector<acc_id_vault_info_res> get_vaults_info(vector<account_id_type> vault_ids) const;
+      vector<acc_id_vault_dashboard_res> get_vault_dashboards(vector<account_id_type> vault_ids) const;
 
       optional<cycle_price> calculate_cycle_price(share_type cycle_amount, asset_id_type asset_id) const;
 
@@ -218,35 +227,20 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<last_price_object> get_last_prices() const;
       vector<external_price_object> get_external_prices() const;
 
-      template<typename T>
-      void subscribe_to_item( const T& i )const
+      void subscribe_to_item( object_id_type id )const
       {
-         auto vec = fc::raw::pack(i);
-         if( !_subscribe_callback )
-            return;
-
-         if( !is_subscribed_to_item(i) )
-            _subscribe_filter.insert( vec.data(), vec.size() );
+         _router->subscribe_to_object( this, id );
       }
 
-      template<typename T>
-      bool is_subscribed_to_item( const T& i )const
+      template<uint8_t SpaceID, uint8_t TypeID, typename T>
+      void subscribe_to_item( const object_id<SpaceID, TypeID, T>& id )const
       {
-         if( !_subscribe_callback )
-            return false;
-
-         return _subscribe_filter.contains( i );
+         subscribe_to_item( object_id_type( id ) );
       }
 
-      bool is_impacted_account( const flat_set<account_id_type>& accounts)
-      {
-         if( !_subscribed_accounts.size() || !accounts.size() )
-            return false;
-
-         return std::any_of(accounts.begin(), accounts.end(), [this](const account_id_type& account) {
-            return _subscribed_accounts.find(account) != _subscribed_accounts.end();
-         });
-      }
+      /// keys, addresses and lists of ids never show up in object notifications
+      template<typename T>
+      void subscribe_to_item( const T& )const {}
 
       // TODO: figure out some way to use copy.
       template<typename IndexType, typename IndexBy>
@@ -362,36 +356,48 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
          auto sub = _market_subscriptions.find( market );
          if( sub != _market_subscriptions.end() ) {
-            queue[market].emplace_back( full_object ? obj->to_variant() : fc::variant(obj->id, 1) );
+            queue[market].emplace_back( full_object ? _notifications->get( *obj ) : fc::variant(obj->id, 1) );
          }
       }
 
-      void broadcast_updates( const vector<variant>& updates );
+      void broadcast_updates( const vector<variant>& updates, const std::function<void(const fc::variant&)>& callback );
       void broadcast_market_updates( const market_queue_type& queue);
-      void handle_object_changed(bool force_notify, bool full_object, const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts, std::function<const object*(object_id_type id)> find_object);
 
-      /** called every time a block is applied to report the objects that were changed */
-      void on_objects_new(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts);
-      void on_objects_changed(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts);
-      void on_objects_removed(const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts);
+      /** called every time a block or transaction is applied with the changed objects this session subscribed to */
+      void on_objects_routed( bool full_object, const vector<object_id_type>& ids,
+                              const subscription_router::object_lookup& find_object ) override;
+      void on_orders_routed( bool full_object, const vector<object_id_type>& ids,
+                             const subscription_router::object_lookup& find_object ) override;
       void on_applied_block();
 
-      bool _notify_remove_create = false;
-      mutable fc::bloom_filter _subscribe_filter;
+      /// a copy taken under the lock, set_subscribe_callback may replace the callback while it is in use
+      std::function<void(const fc::variant&)> get_subscribe_callback()const
+      {
+         std::lock_guard<std::recursive_mutex> lock( _subscription_mutex );
+         return _subscribe_callback;
+      }
+
+      /// guards the subscription state below, read-only calls may run on API worker threads
+      mutable std::recursive_mutex _subscription_mutex;
       std::set<account_id_type> _subscribed_accounts;
       std::function<void(const fc::variant&)> _subscribe_callback;
       std::function<void(const fc::variant&)> _pending_trx_callback;
       std::function<void(const fc::variant&)> _block_applied_callback;
 
-      boost::signals2::scoped_connection _new_connection;
-      boost::signals2::scoped_connection _change_connection;
-      boost::signals2::scoped_connection _removed_connection;
       boost::signals2::scoped_connection _applied_block_connection;
       boost::signals2::scoped_connection _pending_trx_connection;
       map< pair<asset_id_type,asset_id_type>, std::function<void(const variant&)> > _market_subscriptions;
       graphene::chain::database& _db;
       database_access_layer _dal;
       const application_options* _app_options = nullptr;
+      std::shared_ptr<notification_cache> _notifications;
+      std::shared_ptr<subscription_router> _router;
+      /// shared with the other sessions, null for sessions created outside of the application
+      std::shared_ptr<object_cache> _objects;
+
+      std::map<string,full_account> collect_full_accounts( const vector<string>& names_or_ids, uint32_t sections,
+                                                           bool subscribe );
+      full_account make_full_account( const account_object& account, uint32_t sections )const;
 
       template<typename Iter>
       void func_re_pack(Iter helper_itr, Iter end, std::vector<aggregated_limit_orders_with_same_price_collection>& ret, uint32_t limit_group, uint32_t limit_per_group) const;
@@ -403,24 +409,28 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-database_api::database_api( graphene::chain::database& db, const application_options* app_options )
-   : my( new database_api_impl( db, app_options ) ) {}
+database_api::database_api( graphene::chain::database& db, const application_options* app_options,
+                            std::shared_ptr<notification_cache> notifications,
+                            std::shared_ptr<subscription_router> router,
+                            std::shared_ptr<object_cache> objects )
+   : my( new database_api_impl( db, app_options, std::move( notifications ), std::move( router ), std::move( objects ) ) ) {}
 
 database_api::~database_api() {}
 
-database_api_impl::database_api_impl( graphene::chain::database& db, const application_options* app_options  )
-: _db(db), _dal(db), _app_options(app_options)
+database_api_impl::database_api_impl( graphene::chain::database& db, const application_options* app_options,
+                                      std::shared_ptr<notification_cache> notifications,
+                                      std::shared_ptr<subscription_router> router,
+                                      std::shared_ptr<object_cache> objects )
+: _db(db), _dal(db), _app_options(app_options), _notifications(std::move(notifications)), _router(std::move(router)),
+  _objects(std::move(objects))
 {
+   // sessions created outside of the application encode and route for themselves
+   if( !_notifications )
+      _notifications = std::make_shared<notification_cache>( db );
+   if( !_router )
+      _router = std::make_shared<subscription_router>( db );
+
    wlog("creating database api ${x}", ("x",int64_t(this)) );
-   _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
-                                             on_objects_new(ids, impacted_accounts);
-                                            });
-   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_changed(ids, impacted_accounts);
-                                });
-   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts) {
-                                                     on_objects_removed(ids, objs, impacted_accounts);
-                                                   });
    _applied_block_connection = _db.applied_block.connect([this](const signed_block&){ on_applied_block(); });
 
    _pending_trx_connection = _db.on_pending_transaction.connect([this](const signed_transaction& trx ){
@@ -430,6 +440,7 @@ database_api_impl::database_api_impl( graphene::chain::database& db, const appli
 
 database_api_impl::~database_api_impl()
 {
+   _router->remove( this );
    elog("freeing database api ${x}", ("x",int64_t(this)) );
 }
 
@@ -446,7 +457,7 @@ fc::variants database_api::get_objects(const vector<object_id_type>& ids)const
 
 fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids)const
 {
-   if( _subscribe_callback )  {
+   if( get_subscribe_callback() )  {
       for( auto id : ids )
       {
          if( id.type() == operation_history_object_type && id.space() == protocol_ids ) continue;
@@ -465,6 +476,8 @@ fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids)co
 
    std::transform(ids.begin(), ids.end(), std::back_inserter(result),
                   [this](object_id_type id) -> fc::variant {
+      if(_objects && _objects->is_cached_type(id))
+         return _objects->get(_db, id);
       if(auto obj = _db.find_object(id))
          return obj->to_variant();
       return {};
@@ -492,16 +505,14 @@ void database_api_impl::set_subscribe_callback( std::function<void(const variant
                  "Subscribing to universal object creation and removal is disallowed in this server." );
    }
 
+   std::lock_guard<std::recursive_mutex> lock( _subscription_mutex );
    _subscribe_callback = cb;
-   _notify_remove_create = notify_remove_create;
    _subscribed_accounts.clear();
 
-   static fc::bloom_parameters param;
-   param.projected_element_count    = 10000;
-   param.false_positive_probability = 1.0/100;
-   param.maximum_size = 1024*8*8*2;
-   param.compute_optimal_parameters();
-   _subscribe_filter = fc::bloom_filter(param);
+   if( _subscribe_callback )
+      _router->watch_objects( shared_from_this(), notify_remove_create );
+   else
+      _router->stop_watching_objects( this );
 }
 
 void database_api::set_pending_transaction_callback( std::function<void(const variant&)> cb )
@@ -533,6 +544,17 @@ void database_api_impl::cancel_all_subscriptions()
 {
    set_subscribe_callback( std::function<void(const fc::variant&)>(), true);
    _market_subscriptions.clear();
+   _router->watch_markets( shared_from_this(), false );
+}
+
+notification_metrics database_api::get_notification_metrics()const
+{
+   return my->get_notification_metrics();
+}
+
+notification_metrics database_api_impl::get_notification_metrics()const
+{
+   return _notifications->last_block_metrics();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -603,6 +625,16 @@ vector<signed_block_with_virtual_operations_and_num> database_api_impl::get_bloc
     return _dal.get_blocks_with_virtual_operations(start_block_num, count, virtual_operation_ids);
 }
 
+vector<raw_block> database_api::get_raw_blocks(uint32_t start_block_num, uint32_t count) const
+{
+    return my->get_raw_blocks(start_block_num, count);
+}
+
+vector<raw_block> database_api_impl::get_raw_blocks(uint32_t start_block_num, uint32_t count) const
+{
+    return _dal.get_raw_blocks(start_block_num, count);
+}
+
 processed_transaction database_api::get_transaction( uint32_t block_num, uint32_t trx_in_block )const
 {
    return my->get_transaction( block_num, trx_in_block );
@@ -681,6 +713,20 @@ dynamic_global_property_object database_api_impl::get_dynamic_global_properties(
    return _db.get(dynamic_global_property_id_type());
 }
 
+state_digest database_api::get_state_digest()const
+{
+   return my->get_state_digest();
+}
+
+state_digest database_api_impl::get_state_digest()const
+{
+   state_digest result;
+   result.head_block_num = _db.head_block_num();
+   result.head_block_id = _db.head_block_id();
+   result.digest = _db.head_state_digest();
+   return result;
+}
+
 optional<total_cycles_res> database_api::get_total_cycles() const {
     return my->get_total_cycles();
 }
@@ -742,13 +788,15 @@ vector<vector<account_id_type>> database_api::get_key_references( vector<public_
  */
 vector<vector<account_id_type>> database_api_impl::get_key_references( vector<public_key_type> keys )const
 {
-   wdump( (keys) );
    vector< vector<account_id_type> > final_result;
    final_result.reserve(keys.size());
 
+   const auto& idx = _db.get_index_type<account_index>();
+   const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+   const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
+
    for( auto& key : keys )
    {
-
       address a1( pts_address(key, false, 56) );
       address a2( pts_address(key, true, 56) );
       address a3( pts_address(key, false, 0)  );
@@ -762,31 +810,18 @@ vector<vector<account_id_type>> database_api_impl::get_key_references( vector<pu
       subscribe_to_item( a4 );
       subscribe_to_item( a5 );
 
-      const auto& idx = _db.get_index_type<account_index>();
-      const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
-      const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
-      auto itr = refs.account_to_key_memberships.find(key);
       vector<account_id_type> result;
-
       for( auto& a : {a1,a2,a3,a4,a5} )
       {
           auto itr = refs.account_to_address_memberships.find(a);
           if( itr != refs.account_to_address_memberships.end() )
-          {
-             result.reserve( itr->second.size() );
-             for( auto item : itr->second )
-             {
-                wdump((a)(item)(item(_db).name));
-                result.push_back(item);
-             }
-          }
+             result.insert( result.end(), itr->second.begin(), itr->second.end() );
       }
 
+      auto itr = refs.account_to_key_memberships.find(key);
       if( itr != refs.account_to_key_memberships.end() )
-      {
-         result.reserve( itr->second.size() );
-         for( auto item : itr->second ) result.push_back(item);
-      }
+         result.insert( result.end(), itr->second.begin(), itr->second.end() );
+
       final_result.emplace_back( std::move(result) );
    }
 
@@ -827,11 +862,74 @@ std::map<string,full_account> database_api::get_full_accounts( const vector<stri
    return my->get_full_accounts( names_or_ids, subscribe );
 }
 
+std::map<string,full_account> database_api::get_full_accounts_with_sections( const vector<string>& names_or_ids,
+                                                                             const vector<string>& sections,
+                                                                             bool subscribe )
+{
+   return my->get_full_accounts_with_sections( names_or_ids, sections, subscribe );
+}
+
+namespace {
+
+   enum full_account_section : uint32_t
+   {
+      full_account_statistics       = 1 << 0,
+      full_account_referrer_names   = 1 << 1,
+      full_account_cashback_balance = 1 << 2,
+      full_account_proposals        = 1 << 3,
+      full_account_balances         = 1 << 4,
+      full_account_vesting_balances = 1 << 5,
+      full_account_limit_orders     = 1 << 6,
+      full_account_call_orders      = 1 << 7,
+      full_account_all_sections     = ( 1 << 8 ) - 1
+   };
+
+   const std::map<string, uint32_t>& full_account_section_names()
+   {
+      static const std::map<string, uint32_t> names = {
+         { "statistics",       full_account_statistics },
+         { "referrer_names",   full_account_referrer_names },
+         { "cashback_balance", full_account_cashback_balance },
+         { "proposals",        full_account_proposals },
+         { "balances",         full_account_balances },
+         { "vesting_balances", full_account_vesting_balances },
+         { "limit_orders",     full_account_limit_orders },
+         { "call_orders",      full_account_call_orders }
+      };
+      return names;
+   }
+
+   /// accounts built by one pool thread, smaller batches are not worth handing to another thread
+   const size_t full_accounts_per_shard = 32;
+
+}
+
 std::map<std::string, full_account> database_api_impl::get_full_accounts( const vector<std::string>& names_or_ids, bool subscribe)
+{
+   return collect_full_accounts( names_or_ids, full_account_all_sections, subscribe );
+}
+
+std::map<std::string, full_account> database_api_impl::get_full_accounts_with_sections( const vector<std::string>& names_or_ids,
+                                                                                         const vector<std::string>& sections,
+                                                                                         bool subscribe )
+{
+   uint32_t mask = sections.empty() ? uint32_t( full_account_all_sections ) : 0;
+   for( const auto& section : sections )
+   {
+      auto itr = full_account_section_names().find( section );
+      FC_ASSERT( itr != full_account_section_names().end(), "Unknown full account section ${s}", ("s", section) );
+      mask |= itr->second;
+   }
+   return collect_full_accounts( names_or_ids, mask, subscribe );
+}
+
+std::map<std::string, full_account> database_api_impl::collect_full_accounts( const vector<std::string>& names_or_ids,
+                                                                               uint32_t sections, bool subscribe )
 {
    idump((names_or_ids));
-   std::map<std::string, full_account> results;
 
+   vector<const account_object*> accounts;
+   accounts.reserve( names_or_ids.size() );
    for (const std::string& account_name_or_id : names_or_ids)
    {
       const account_object* account = nullptr;
@@ -844,78 +942,95 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
          if (itr != idx.end())
             account = &*itr;
       }
-      if (account == nullptr)
-         continue;
+      accounts.push_back( account );
 
-      if( subscribe )
+      if( account != nullptr && subscribe )
       {
+         std::lock_guard<std::recursive_mutex> lock( _subscription_mutex );
          if(_subscribed_accounts.size() < 100) {
             _subscribed_accounts.insert( account->get_id() );
             subscribe_to_item( account->id );
+            _router->subscribe_to_account( this, account->get_id() );
          }
       }
+   }
 
-      // fc::mutable_variant_object full_account;
-      full_account acnt;
-      acnt.account = *account;
-      acnt.statistics = account->statistics(_db);
-      acnt.registrar_name = account->registrar(_db).name;
-      acnt.referrer_name = account->referrer(_db).name;
-      acnt.lifetime_referrer_name = account->lifetime_referrer(_db).name;
-      acnt.votes.clear();
-
-      // Add the account itself, its statistics object, cashback balance, and referral account names
-      /*
-      full_account("account", *account)("statistics", account->statistics(_db))
-            ("registrar_name", account->registrar(_db).name)("referrer_name", account->referrer(_db).name)
-            ("lifetime_referrer_name", account->lifetime_referrer(_db).name);
-            */
-      if (account->cashback_vb)
-      {
-         acnt.cashback_balance = account->cashback_balance(_db);
-      }
-      // Add the account's proposals
+   // The shards only read, on the state the caller sees: either the thread applying blocks waits for this
+   // call, or the call holds the chain state lock of an API worker for its whole duration.  They must not
+   // lock it themselves, a block waiting for the lock would stall them behind this call.
+   vector<full_account> built( accounts.size() );
+   const auto build_range = [this, &accounts, &built, sections]( size_t first, size_t last ) {
+      for( size_t i = first; i < last; ++i )
+         if( accounts[i] != nullptr )
+            built[i] = make_full_account( *accounts[i], sections );
+   };
+
+   _db.get_worker_pool().run_shards( accounts.size(), full_accounts_per_shard, build_range );
+
+   std::map<std::string, full_account> results;
+   for( size_t i = 0; i < accounts.size(); ++i )
+      if( accounts[i] != nullptr )
+         results[names_or_ids[i]] = std::move( built[i] );
+   return results;
+}
+
+full_account database_api_impl::make_full_account( const account_object& account, uint32_t sections )const
+{
+   full_account acnt;
+   acnt.account = account;
+
+   if( sections & full_account_statistics )
+      acnt.statistics = account.statistics(_db);
+
+   if( sections & full_account_referrer_names )
+   {
+      acnt.registrar_name = account.registrar(_db).name;
+      acnt.referrer_name = account.referrer(_db).name;
+      acnt.lifetime_referrer_name = account.lifetime_referrer(_db).name;
+   }
+
+   if( (sections & full_account_cashback_balance) && account.cashback_vb )
+      acnt.cashback_balance = account.cashback_balance(_db);
+
+   if( sections & full_account_proposals )
+   {
       const auto& proposal_idx = _db.get_index_type<proposal_index>();
       const auto& pidx = dynamic_cast<const primary_index<proposal_index>&>(proposal_idx);
       const auto& proposals_by_account = pidx.get_secondary_index<graphene::chain::required_approval_index>();
-      auto  required_approvals_itr = proposals_by_account._account_to_proposals.find( account->id );
+      auto required_approvals_itr = proposals_by_account._account_to_proposals.find( account.id );
       if( required_approvals_itr != proposals_by_account._account_to_proposals.end() )
       {
          acnt.proposals.reserve( required_approvals_itr->second.size() );
          for( auto proposal_id : required_approvals_itr->second )
             acnt.proposals.push_back( proposal_id(_db) );
       }
+   }
 
+   if( sections & full_account_balances )
+   {
+      auto balance_range = _db.get_index_type<account_balance_index>().indices().get<by_account_asset>().equal_range(boost::make_tuple(account.id));
+      acnt.balances.assign( balance_range.first, balance_range.second );
+   }
 
-      // Add the account's balances
-      auto balance_range = _db.get_index_type<account_balance_index>().indices().get<by_account_asset>().equal_range(boost::make_tuple(account->id));
-      //vector<account_balance_object> balances;
-      std::for_each(balance_range.first, balance_range.second,
-                    [&acnt](const account_balance_object& balance) {
-                       acnt.balances.emplace_back(balance);
-                    });
+   if( sections & full_account_vesting_balances )
+   {
+      auto vesting_range = _db.get_index_type<vesting_balance_index>().indices().get<by_account>().equal_range(account.id);
+      acnt.vesting_balances.assign( vesting_range.first, vesting_range.second );
+   }
 
-      // Add the account's vesting balances
-      auto vesting_range = _db.get_index_type<vesting_balance_index>().indices().get<by_account>().equal_range(account->id);
-      std::for_each(vesting_range.first, vesting_range.second,
-                    [&acnt](const vesting_balance_object& balance) {
-                       acnt.vesting_balances.emplace_back(balance);
-                    });
+   if( sections & full_account_limit_orders )
+   {
+      auto order_range = _db.get_index_type<limit_order_index>().indices().get<by_account>().equal_range(account.id);
+      acnt.limit_orders.assign( order_range.first, order_range.second );
+   }
 
-      // Add the account's orders
-      auto order_range = _db.get_index_type<limit_order_index>().indices().get<by_account>().equal_range(account->id);
-      std::for_each(order_range.first, order_range.second,
-                    [&acnt] (const limit_order_object& order) {
-                       acnt.limit_orders.emplace_back(order);
-                    });
-      auto call_range = _db.get_index_type<call_order_index>().indices().get<by_account>().equal_range(account->id);
-      std::for_each(call_range.first, call_range.second,
-                    [&acnt] (const call_order_object& call) {
-                       acnt.call_orders.emplace_back(call);
-                    });
-      results[account_name_or_id] = acnt;
+   if( sections & full_account_call_orders )
+   {
+      auto call_range = _db.get_index_type<call_order_index>().indices().get<by_account>().equal_range(account.id);
+      acnt.call_orders.assign( call_range.first, call_range.second );
    }
-   return results;
+
+   return acnt;
 }
 
 optional<account_object> database_api::get_account_by_name( string name )const
@@ -1576,6 +1691,7 @@ void database_api_impl::subscribe_to_market(std::function<void(const variant&)>
    if(a > b) std::swap(a,b);
    FC_ASSERT(a != b);
    _market_subscriptions[ std::make_pair(a,b) ] = callback;
+   _router->watch_markets( shared_from_this(), true );
 }
 
 void database_api::unsubscribe_from_market(asset_id_type a, asset_id_type b)
@@ -1588,6 +1704,8 @@ void database_api_impl::unsubscribe_from_market(asset_id_type a, asset_id_type b
    if(a > b) std::swap(a,b);
    FC_ASSERT(a != b);
    _market_subscriptions.erase(std::make_pair(a,b));
+   if( _market_subscriptions.empty() )
+      _router->watch_markets( shared_from_this(), false );
 }
 
 market_ticker database_api::get_ticker( const string& base, const string& quote )const
@@ -2780,6 +2898,16 @@ vector<acc_id_vault_info_res> database_api_impl::get_vaults_info(vector<account_
     return _dal.get_vaults_info(vault_ids);
 }
 
+vector<acc_id_vault_dashboard_res> database_api::get_vault_dashboards(vector<account_id_type> vault_ids) const
+{
+    return my->get_vault_dashboards(vault_ids);
+}
+
+vector<acc_id_vault_dashboard_res> database_api_impl::get_vault_dashboards(vector<account_id_type> vault_ids) const
+{
+    return _dal.get_vault_dashboards(vault_ids);
+}
+
 optional<cycle_price> database_api::calculate_cycle_price(share_type cycle_amount, asset_id_type asset_id) const
 {
     return my->calculate_cycle_price(cycle_amount, asset_id);
@@ -3265,13 +3393,16 @@ vector<external_price_object> database_api_impl::get_external_prices() const
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-void database_api_impl::broadcast_updates( const vector<variant>& updates )
+void database_api_impl::broadcast_updates( const vector<variant>& updates,
+                                           const std::function<void(const fc::variant&)>& callback )
 {
-   if( updates.size() && _subscribe_callback ) {
+   if( updates.size() && callback ) {
+      _notifications->record_broadcast( updates.size() );
       auto capture_this = shared_from_this();
-      fc::async([capture_this,updates](){
-          if(capture_this->_subscribe_callback)
-             capture_this->_subscribe_callback( fc::variant(updates) );
+      fc::async([capture_this,updates,callback](){
+          // skip updates for a session that cancelled its subscriptions in the meantime
+          if( capture_this->get_subscribe_callback() )
+             callback( fc::variant(updates) );
       });
    }
 }
@@ -3292,81 +3423,46 @@ void database_api_impl::broadcast_market_updates( const market_queue_type& queue
    }
 }
 
-void database_api_impl::on_objects_removed( const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts )
+void database_api_impl::on_objects_routed( bool full_object, const vector<object_id_type>& ids,
+                                           const subscription_router::object_lookup& find_object )
 {
-   handle_object_changed(_notify_remove_create, false, ids, impacted_accounts, 
-      [objs](object_id_type id) -> const object* {
-         auto it = std::find_if(objs.begin(), objs.end(), [id](const object* o) {return o != nullptr && o->id == id;});
-         if (it != objs.end())
-         {
-            return *it;
-         }
-         return nullptr;
-   });
-}
-
-void database_api_impl::on_objects_new(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts)
-{
-   handle_object_changed(_notify_remove_create, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
-   );
-}
-
-void database_api_impl::on_objects_changed(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts)
-{
-   handle_object_changed(false, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
-   );
-}
+   const auto callback = get_subscribe_callback();
+   if( !callback )
+      return;
 
-void database_api_impl::handle_object_changed(bool force_notify, bool full_object, const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts, std::function<const object*(object_id_type id)> find_object)
-{
-   if( _subscribe_callback )
+   vector<variant> updates;
+   updates.reserve( ids.size() );
+   for( auto id : ids )
    {
-      vector<variant> updates;
-
-      for(auto id : ids)
+      if( full_object )
       {
-         const object* obj = nullptr;
-         if( force_notify || is_subscribed_to_item(id) || is_impacted_account(impacted_accounts) )
-         {
-            if ( full_object )
-            {
-               obj = find_object(id);
-               if( obj )
-               {
-                  updates.emplace_back( obj->to_variant() );
-               }
-            }
-            else
-            {
-               updates.emplace_back( fc::variant( id, 1 ) );
-            }
-         }
+         if( const object* obj = find_object(id) )
+            updates.emplace_back( _notifications->get( *obj ) );
       }
-
-      if( updates.size() )
-         broadcast_updates(updates);
+      else
+         updates.emplace_back( fc::variant( id, 1 ) );
    }
-   if( _market_subscriptions.size() )
-   {
-      market_queue_type broadcast_queue;
 
-      for(auto id : ids)
-      {
-         if( id.is<call_order_object>() )
-         {
-            enqueue_if_subscribed_to_market<call_order_object>( find_object(id), broadcast_queue, full_object );
-         }
-         else if( id.is<limit_order_object>() )
-         {
-            enqueue_if_subscribed_to_market<limit_order_object>( find_object(id), broadcast_queue, full_object );
-         }
-      }
+   broadcast_updates(updates, callback);
+}
 
-      if( broadcast_queue.size() )
-         broadcast_market_updates(broadcast_queue);
+void database_api_impl::on_orders_routed( bool full_object, const vector<object_id_type>& ids,
+                                          const subscription_router::object_lookup& find_object )
+{
+   if( _market_subscriptions.empty() )
+      return;
+
+   market_queue_type broadcast_queue;
+   for( auto id : ids )
+   {
+      if( id.is<call_order_object>() )
+         enqueue_if_subscribed_to_market<call_order_object>( find_object(id), broadcast_queue, full_object );
+      else if( id.is<limit_order_object>() )
+         enqueue_if_subscribed_to_market<limit_order_object>( find_object(id), broadcast_queue, full_object );
    }
+
+   if( broadcast_queue.size() )
+      broadcast_market_updates(broadcast_queue);
 }
 
 /** note: this method cannot yield because it is called in the middle of
@@ -46,6 +46,8 @@
 #include <string>
 #include <vector>
 
+namespace graphene { namespace account_history { class history_store; } }
+
 namespace graphene { namespace app {
    using namespace graphene::chain;
    using namespace graphene::market_history;
@@ -140,10 +142,28 @@ namespace graphene { namespace app {
 
       protected:
          vector<operation_history_object> get_account_history_impl(account_id_type account,
-                                                                   const std::function<bool(const account_transaction_history_object* node)> &selector,
+                                                                   const std::function<bool(const operation_history_object& op)> &selector,
                                                                    operation_history_id_type stop = operation_history_id_type(),
                                                                    unsigned limit = 100,
                                                                    operation_history_id_type start = operation_history_id_type())const;
+         /// Like get_account_history_impl but seeks directly to the account's operations of one type
+         vector<operation_history_object> get_account_history_by_type_impl(account_id_type account,
+                                                                           uint16_t operation_type,
+                                                                           const std::function<bool(const operation_history_object& op)> &selector,
+                                                                           operation_history_id_type stop,
+                                                                           unsigned limit,
+                                                                           operation_history_id_type start)const;
+         /// Irreversible history kept on disk by the account_history plugin, nullptr if it is kept in memory
+         const graphene::account_history::history_store* get_history_store()const;
+         /// The operation a record of the disk history points to, throws if the store does not hold it
+         static operation_history_object fetch_stored_operation( const graphene::account_history::history_store& store,
+                                                                 uint64_t operation_instance );
+         /**
+          * The instance of the oldest operation of the account still in memory, the maximum if there is none.
+          * Disk records from there on are in memory too, which happens while a block that moved them to disk
+          * is popped, and are skipped.
+          */
+         static uint64_t oldest_operation_in_memory( const graphene::chain::database& db, account_id_type account );
 
       private:
          application& _app;
@@ -247,6 +267,22 @@ namespace graphene { namespace app {
           */
          std::vector<net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Turn the timing of evaluators and block phases on or off, samples collected so far are kept
+          */
+         void set_apply_profiling( bool enabled );
+
+         /**
+          * @brief Drop the samples collected by the apply profiler
+          */
+         void reset_apply_profile();
+
+         /**
+          * @brief Get the time spent per operation type and per phase of applying blocks since the last reset,
+          *        in ticks of the CPU timestamp counter
+          */
+         apply_profile get_apply_profile() const;
+
       private:
          application& _app;
    };
@@ -359,6 +395,9 @@ FC_API(graphene::app::network_node_api,
        (get_potential_peers)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
+       (set_apply_profiling)
+       (reset_apply_profile)
+       (get_apply_profile)
      )
 FC_API(graphene::app::crypto_api,
        (blind_sum)
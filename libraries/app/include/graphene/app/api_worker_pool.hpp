@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/api.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <boost/thread/locks.hpp>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   /**
+    * @brief Runs read-only API calls on a set of worker threads
+    *
+    * Every call holds the database's chain state mutex shared for its duration, so it sees the
+    * state between two blocks or transactions and never a half applied one, while the thread
+    * applying blocks keeps going instead of waiting for slow queries.  The calling fc context
+    * waits for the result, other tasks of the calling thread keep running meanwhile.
+    *
+    * Calls that register callbacks or otherwise write must stay on the calling thread.
+    */
+   class api_worker_pool
+   {
+      public:
+         api_worker_pool( const chain::database& db, uint32_t thread_count );
+         ~api_worker_pool();
+
+         uint32_t thread_count()const { return _threads.size(); }
+
+         /** runs f on the next worker with the chain state locked shared and returns its result */
+         template<typename Functor>
+         auto run( Functor&& f ) -> decltype( f() )
+         {
+            const chain::database* db = &_db;
+            return next_worker().async( [db, &f]() {
+               boost::shared_lock<boost::shared_mutex> lock( db->chain_state_mutex() );
+               return f();
+            }, "api_worker_call" ).wait();
+         }
+
+         /**
+          * Replaces the methods of an API object by versions running on the pool, except for those
+          * named in main_thread_methods.
+          */
+         template<typename Interface>
+         void offload( fc::api<Interface>& api, const std::set<std::string>& main_thread_methods );
+
+      private:
+         struct offload_visitor
+         {
+            api_worker_pool&             pool;
+            const std::set<std::string>& main_thread_methods;
+
+            template<typename R, typename... Args>
+            void operator()( const char* name, std::function<R(Args...)>& method )const
+            {
+               if( main_thread_methods.find( name ) != main_thread_methods.end() )
+                  return;
+               std::function<R(Args...)> call = method;
+               api_worker_pool* p = &pool;
+               method = [p, call]( Args... args ) -> R {
+                  return p->run( [&]() -> R { return call( args... ); } );
+               };
+            }
+         };
+
+         fc::thread& next_worker();
+
+         const chain::database&                    _db;
+         std::vector< std::unique_ptr<fc::thread> > _threads;
+         std::atomic<uint32_t>                     _next_thread;
+   };
+
+   template<typename Interface>
+   void api_worker_pool::offload( fc::api<Interface>& api, const std::set<std::string>& main_thread_methods )
+   {
+      api->visit( offload_visitor{ *this, main_thread_methods } );
+   }
+
+} } // graphene::app
@@ -34,6 +34,10 @@ namespace graphene { namespace app {
    using std::string;
 
    class abstract_plugin;
+   class api_worker_pool;
+   class notification_cache;
+   class subscription_router;
+   class object_cache;
 
    class application_options
    {
@@ -99,6 +103,21 @@ namespace graphene { namespace app {
 
          const application_options& get_options();
 
+         /// Directory the node keeps its state in, plugins place their own files below it
+         const fc::path& data_dir()const;
+
+         /// Threads running read-only API calls, nullptr when they run on the thread applying blocks
+         api_worker_pool* get_api_worker_pool()const;
+
+         /// Encodings of changed objects shared by the database_api sessions of this node
+         std::shared_ptr<notification_cache> get_notification_cache()const;
+
+         /// Routes object notifications to the database_api sessions of this node
+         std::shared_ptr<subscription_router> get_subscription_router()const;
+
+         /// Encodings of frequently requested objects shared by the database_api sessions of this node
+         std::shared_ptr<object_cache> get_object_cache()const;
+
       private:
          void enable_plugin( const string& name );
          void add_available_plugin( std::shared_ptr<abstract_plugin> p );
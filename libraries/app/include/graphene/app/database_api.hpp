@@ -24,6 +24,9 @@
 #pragma once
 
 #include <graphene/app/full_account.hpp>
+#include <graphene/app/notification_cache.hpp>
+#include <graphene/app/object_cache.hpp>
+#include <graphene/app/subscription_router.hpp>
 
 #include <graphene/chain/protocol/types.hpp>
 
@@ -198,6 +201,13 @@ struct withdrawal_limit
    time_point_sec last_withdrawal;
 };
 
+struct state_digest
+{
+   uint32_t                   head_block_num;
+   block_id_type              head_block_id;
+   fc::sha256                 digest;
+};
+
 /**
  * @brief The database_api class implements the RPC API for the chain database.
  *
@@ -208,7 +218,17 @@ struct withdrawal_limit
 class database_api
 {
    public:
-      database_api( graphene::chain::database& db, const application_options* app_options );
+      /**
+       * @param notifications encodings of changed objects shared with the other sessions, a private cache
+       *        is created when null
+       * @param router subscription index shared with the other sessions, a private one is created when null
+       * @param objects encodings of frequently requested objects shared with the other sessions, nothing is
+       *        cached when null
+       */
+      database_api( graphene::chain::database& db, const application_options* app_options,
+                    std::shared_ptr<notification_cache> notifications = std::shared_ptr<notification_cache>(),
+                    std::shared_ptr<subscription_router> router = std::shared_ptr<subscription_router>(),
+                    std::shared_ptr<object_cache> objects = std::shared_ptr<object_cache>() );
       ~database_api();
 
       /////////////
@@ -238,6 +258,14 @@ class database_api
        */
       void cancel_all_subscriptions();
 
+      /**
+       * @brief Get the cost of the object notifications sent for the last block
+       * @return Objects encoded, encodings shared between sessions and updates queued
+       *
+       * Covers all sessions sharing this node's notification cache, not only the calling one.
+       */
+      notification_metrics get_notification_metrics()const;
+
       /////////////////////////////
       // Blocks and transactions //
       /////////////////////////////
@@ -278,6 +306,17 @@ class database_api
       vector<signed_block_with_virtual_operations_and_num> get_blocks_with_virtual_operations(uint32_t start_block_num,
                                                                                               uint32_t count,
                                                                                               std::vector<uint16_t> virtual_operation_ids) const;
+
+      /**
+       * @brief Return packed blocks with their ids straight from the block log, for indexers that parse blocks themselves.
+       * @param start_block_num Height of the starting block.
+       * @param count Number of blocks to return, at most 10000.
+       * @return Array of raw blocks, cut short after 16 MiB; continue from the block after the last one returned.
+       *
+       * Over HTTP the blocks can also be fetched with binary framing, see json_api_connection.
+       */
+      vector<raw_block> get_raw_blocks(uint32_t start_block_num, uint32_t count) const;
+
       /**
        * @brief used to fetch an individual transaction.
        */
@@ -319,6 +358,15 @@ class database_api
        */
       dynamic_global_property_object get_dynamic_global_properties() const;
 
+      /**
+       * @brief Get a digest of the chain state at the head block, equal on all nodes in the same state
+       *
+       * Covers the protocol and implementation objects, but not the operation history, the virtual operation
+       * index or the history fields of account statistics, which depend on the plugins and options of a node.
+       * Pending transactions are not part of it.  Only available on nodes started with track-state-digest.
+       */
+      state_digest get_state_digest() const;
+
       /**
        * @brief Get the total amount of cycles and total potential amount of dascoin
        */
@@ -361,6 +409,20 @@ class database_api
        */
       std::map<string,full_account> get_full_accounts( const vector<string>& names_or_ids, bool subscribe );
 
+      /**
+       * @brief Same as @ref get_full_accounts, but fills only the requested sections
+       * @param names_or_ids Each item must be the name or ID of an account to retrieve
+       * @param sections Any of statistics, referrer_names, cashback_balance, proposals, balances,
+       *        vesting_balances, limit_orders and call_orders, the account object itself is always included.
+       *        An empty list fills them all.
+       * @param subscribe Whether to subscribe to updates of the accounts
+       * @return Map of string from @ref names_or_ids to the corresponding account
+       *
+       * Large batches are built on several threads.
+       */
+      std::map<string,full_account> get_full_accounts_with_sections( const vector<string>& names_or_ids,
+                                                                     const vector<string>& sections, bool subscribe );
+
       optional<account_object> get_account_by_name( string name )const;
 
       /**
@@ -937,6 +999,15 @@ class database_api
        */
       vector<acc_id_vault_info_res> get_vaults_info(vector<account_id_type> vault_ids) const;
 
+      /**
+       * @brief Get everything a vault dashboard shows for a list of vaults in one call.
+       * @param vault_ids A list of vault ID's.
+       * @result For each vault id, its vault information, cycle balances and queue submissions with positions (if vault
+       * exists). The same as get_vaults_info, get_all_cycle_balances_for_accounts and
+       * get_queue_submissions_with_pos_for_accounts together, resolving each vault once.
+       */
+      vector<acc_id_vault_dashboard_res> get_vault_dashboards(vector<account_id_type> vault_ids) const;
+
       /**
        * @brief Calculates and returns the amount of asset one needs to pay to get the given amount of cycles
        * @param cycle_amount Desired amount of cycles to get
@@ -1084,6 +1155,7 @@ FC_REFLECT( graphene::app::daspay_authority, (payment_provider)(daspay_public_ke
 FC_REFLECT( graphene::app::tethered_accounts_balance, (account)(name)(kind)(balance)(reserved) );
 FC_REFLECT( graphene::app::tethered_accounts_balances_collection, (asset_id)(total)(details) );
 FC_REFLECT( graphene::app::withdrawal_limit, (limit)(spent)(start_of_withdrawal)(last_withdrawal) );
+FC_REFLECT( graphene::app::state_digest, (head_block_num)(head_block_id)(digest) );
 
 FC_API( graphene::app::database_api,
    // Objects
@@ -1094,12 +1166,14 @@ FC_API( graphene::app::database_api,
    (set_pending_transaction_callback)
    (set_block_applied_callback)
    (cancel_all_subscriptions)
+   (get_notification_metrics)
 
    // Blocks and transactions
    (get_block_header)
    (get_block)
    (get_blocks)
    (get_blocks_with_virtual_operations)
+   (get_raw_blocks)
    (get_transaction)
    (get_recent_transaction_by_id)
 
@@ -1109,6 +1183,7 @@ FC_API( graphene::app::database_api,
    (get_config)
    (get_chain_id)
    (get_dynamic_global_properties)
+   (get_state_digest)
    (get_total_cycles)
    (get_queue_projection)
 
@@ -1118,6 +1193,7 @@ FC_API( graphene::app::database_api,
    // Accounts
    (get_accounts)
    (get_full_accounts)
+   (get_full_accounts_with_sections)
    (get_account_by_name)
    (get_account_references)
    (lookup_account_names)
@@ -1222,6 +1298,7 @@ FC_API( graphene::app::database_api,
    // Vaults
    (get_vault_info)
    (get_vaults_info)
+   (get_vault_dashboards)
 
    // Calculate cycle price
    (calculate_cycle_price)
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/database_api.hpp>
+#include <graphene/app/json_writer.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <fc/api.hpp>
+#include <fc/rpc/websocket_api.hpp>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace graphene { namespace app {
+
+   namespace detail {
+      template<typename T> struct is_callback : std::false_type {};
+      template<typename R, typename... Args> struct is_callback<std::function<R(Args...)>> : std::true_type {};
+
+      template<typename... Args> struct any_callback : std::false_type {};
+      template<typename A, typename... Args>
+      struct any_callback<A, Args...> : std::integral_constant<bool, is_callback<typename std::decay<A>::type>::value ||
+                                                                     any_callback<Args...>::value> {};
+   }
+
+   /**
+    * Calls the methods of an API from JSON parameters and writes their typed results with
+    * json_writer.  Methods taking callbacks or returning nothing are left to fc's generic path.
+    */
+   template<typename Interface>
+   class json_method_table
+   {
+      public:
+         typedef std::function<void(const fc::variants& params, json_writer& out)> method_type;
+
+         json_method_table( fc::api<Interface> api, uint32_t max_depth )
+            : _api( api ), _max_depth( max_depth )
+         {
+            _api->visit( builder{ *this } );
+         }
+
+         /// nullptr if the method is not handled here
+         const method_type* find( const std::string& name )const
+         {
+            auto itr = _methods.find( name );
+            return itr == _methods.end() ? nullptr : &itr->second;
+         }
+
+      private:
+         struct builder
+         {
+            json_method_table& table;
+
+            template<typename R, typename... Args>
+            void operator()( const char* name, std::function<R(Args...)>& method )const
+            {
+               add( name, method, std::integral_constant<bool, std::is_void<R>::value || detail::any_callback<Args...>::value>() );
+            }
+
+            template<typename R, typename... Args>
+            void add( const char*, const std::function<R(Args...)>&, std::true_type )const {}
+
+            template<typename R, typename... Args>
+            void add( const char* name, const std::function<R(Args...)>& method, std::false_type )const
+            {
+               const uint32_t max_depth = table._max_depth;
+               table._methods[ name ] = [method, max_depth]( const fc::variants& params, json_writer& out ) {
+                  FC_ASSERT( params.size() >= sizeof...(Args), "too few arguments passed to method" );
+                  out.write( invoke( method, params, max_depth, graphene::chain::detail::gen_seq<sizeof...(Args)>() ) );
+               };
+            }
+
+            template<typename R, typename... Args, int... Is>
+            static R invoke( const std::function<R(Args...)>& method, const fc::variants& params, uint32_t max_depth,
+                             graphene::chain::detail::seq<Is...> )
+            {
+               return method( params[Is].as<typename std::decay<Args>::type>( max_depth )... );
+            }
+         };
+
+         fc::api<Interface>                            _api;
+         uint32_t                                      _max_depth;
+         std::unordered_map<std::string, method_type>  _methods;
+   };
+
+   /**
+    * @brief Websocket API connection answering database_api calls without fc::variant trees
+    *
+    * "call" requests for API id 0, which every session registers as the database API, are
+    * answered by serializing the typed result straight to JSON.  Everything else (login,
+    * other APIs, callbacks) goes through the fc connection unchanged.  A call that fails here
+    * is answered with an error response in fc's format, it is never run a second time.
+    *
+    * An HTTP get_raw_blocks call with "framing":"binary" next to its params is answered with
+    * the blocks back to back, each as its number (4 bytes, little endian), its 20 byte id, its
+    * size (4 bytes, little endian) and the packed block.
+    */
+   class json_api_connection : public fc::rpc::websocket_api_connection
+   {
+      public:
+         json_api_connection( fc::http::websocket_connection& c, uint32_t max_depth, const fc::api<database_api>& db_api );
+
+      private:
+         void handle_message( const std::string& message );
+         std::string handle_http( const std::string& request );
+         /// the JSON response, or nothing when the request is left to fc
+         fc::optional<std::string> try_call( const fc::variant& request );
+         fc::optional<std::string> try_binary_raw_blocks( const fc::variant& request );
+
+         fc::http::websocket_connection&   _socket;
+         fc::api<database_api>             _database_api;
+         uint32_t                          _max_depth;
+         json_method_table<database_api>   _database_methods;
+   };
+
+} } // graphene::app
@@ -0,0 +1,312 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/config.hpp>
+#include <graphene/chain/protocol/address.hpp>
+#include <graphene/chain/protocol/types.hpp>
+#include <graphene/chain/protocol/vote.hpp>
+#include <graphene/chain/pts_address.hpp>
+#include <graphene/db/object_id.hpp>
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/static_variant.hpp>
+#include <fc/time.hpp>
+#include <fc/variant.hpp>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   class json_writer;
+
+   /**
+    * Writes one type as JSON.  The primary template handles reflected structs member by member
+    * and sends everything else through fc::variant; the specializations below write containers
+    * and the common leaf types directly.
+    */
+   template<typename T, typename Enable = void>
+   struct json_serializer;
+
+   /** true for reflected structs written member by member, false for those with their own to_variant */
+   template<typename T>
+   struct json_reflected : std::integral_constant<bool, fc::reflector<T>::is_defined::value &&
+                                                        !fc::reflector<T>::is_enum::value> {};
+   template<typename T> struct json_reflected<fc::safe<T>> : std::false_type {};
+   template<> struct json_reflected<chain::public_key_type> : std::false_type {};
+   template<> struct json_reflected<chain::extended_public_key_type> : std::false_type {};
+   template<> struct json_reflected<chain::extended_private_key_type> : std::false_type {};
+   template<> struct json_reflected<chain::address> : std::false_type {};
+   template<> struct json_reflected<chain::pts_address> : std::false_type {};
+   template<> struct json_reflected<chain::vote_id_type> : std::false_type {};
+
+   /**
+    * @brief Serializes values to JSON text without building an fc::variant tree
+    *
+    * The output is the same as fc::json::to_string( fc::variant( value ) ) with the default
+    * formatting: integers above 32 bits are quoted and null optional members are left out.
+    */
+   class json_writer
+   {
+      public:
+         explicit json_writer( uint32_t max_depth = GRAPHENE_MAX_NESTED_OBJECTS );
+
+         template<typename T>
+         void write( const T& value ) { json_serializer<T>::write( *this, value ); }
+
+         void write_raw( char c ) { _buffer += c; }
+         void write_raw( const char* text ) { _buffer += text; }
+         void write_string( const std::string& s );
+         void write_int64( int64_t i );
+         void write_uint64( uint64_t u );
+         void write_variant( const fc::variant& v );
+
+         uint32_t           max_depth()const { return _max_depth; }
+         const std::string& str()const { return _buffer; }
+         void               reserve( size_t size ) { _buffer.reserve( size ); }
+
+      private:
+         std::string _buffer;
+         uint32_t    _max_depth;
+   };
+
+   namespace detail {
+      template<typename T> bool is_null_optional( const T& ) { return false; }
+      template<typename T> bool is_null_optional( const fc::optional<T>& v ) { return !v.valid(); }
+
+      template<typename Class>
+      struct json_member_writer
+      {
+         json_writer& w;
+         const Class& obj;
+         mutable bool first;
+
+         template<typename Member, class Base, Member (Base::*member)>
+         void operator()( const char* name )const
+         {
+            const Member& value = obj.*member;
+            if( is_null_optional( value ) )
+               return;
+            if( !first )
+               w.write_raw( ',' );
+            first = false;
+            w.write_raw( '"' );
+            w.write_raw( name );
+            w.write_raw( "\":" );
+            w.write( value );
+         }
+      };
+
+      struct json_static_variant_writer
+      {
+         typedef void result_type;
+         json_writer& w;
+
+         template<typename T>
+         void operator()( const T& value )const { w.write( value ); }
+      };
+
+      template<typename Container>
+      void write_json_array( json_writer& w, const Container& items )
+      {
+         w.write_raw( '[' );
+         bool first = true;
+         for( const auto& item : items )
+         {
+            if( !first )
+               w.write_raw( ',' );
+            first = false;
+            w.write( item );
+         }
+         w.write_raw( ']' );
+      }
+   }
+
+   template<typename T, typename Enable>
+   struct json_serializer
+   {
+      static void write( json_writer& w, const T& value )
+      {
+         write( w, value, std::integral_constant<bool, json_reflected<T>::value>() );
+      }
+
+      static void write( json_writer& w, const T& value, std::true_type )
+      {
+         w.write_raw( '{' );
+         fc::reflector<T>::visit( detail::json_member_writer<T>{ w, value, true } );
+         w.write_raw( '}' );
+      }
+
+      static void write( json_writer& w, const T& value, std::false_type )
+      {
+         w.write_variant( fc::variant( value, w.max_depth() ) );
+      }
+   };
+
+   template<>
+   struct json_serializer<fc::variant>
+   {
+      static void write( json_writer& w, const fc::variant& value ) { w.write_variant( value ); }
+   };
+
+   template<>
+   struct json_serializer<bool>
+   {
+      static void write( json_writer& w, bool value ) { w.write_raw( value ? "true" : "false" ); }
+   };
+
+   template<typename T>
+   struct json_serializer<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+   {
+      static void write( json_writer& w, T value ) { w.write_int64( value ); }
+   };
+
+   template<typename T>
+   struct json_serializer<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type>
+   {
+      static void write( json_writer& w, T value ) { w.write_uint64( value ); }
+   };
+
+   template<>
+   struct json_serializer<std::string>
+   {
+      static void write( json_writer& w, const std::string& value ) { w.write_string( value ); }
+   };
+
+   template<typename T>
+   struct json_serializer<fc::safe<T>>
+   {
+      static void write( json_writer& w, const fc::safe<T>& value ) { w.write( value.value ); }
+   };
+
+   template<>
+   struct json_serializer<fc::time_point_sec>
+   {
+      static void write( json_writer& w, const fc::time_point_sec& value ) { w.write_string( value.to_iso_string() ); }
+   };
+
+   template<>
+   struct json_serializer<db::object_id_type>
+   {
+      static void write( json_writer& w, const db::object_id_type& value ) { w.write_string( std::string( value ) ); }
+   };
+
+   template<uint8_t SpaceID, uint8_t TypeID, typename T>
+   struct json_serializer<db::object_id<SpaceID, TypeID, T>>
+   {
+      static void write( json_writer& w, const db::object_id<SpaceID, TypeID, T>& value )
+      {
+         w.write_string( std::string( db::object_id_type( value ) ) );
+      }
+   };
+
+   template<typename T>
+   struct json_serializer<fc::optional<T>>
+   {
+      static void write( json_writer& w, const fc::optional<T>& value )
+      {
+         if( value.valid() )
+            w.write( *value );
+         else
+            w.write_raw( "null" );
+      }
+   };
+
+   /// vector<char> is written as hex like fc does
+   template<>
+   struct json_serializer<std::vector<char>>
+   {
+      static void write( json_writer& w, const std::vector<char>& value ) { w.write_variant( fc::variant( value, w.max_depth() ) ); }
+   };
+
+   template<typename T>
+   struct json_serializer<std::vector<T>>
+   {
+      static void write( json_writer& w, const std::vector<T>& value ) { detail::write_json_array( w, value ); }
+   };
+
+   template<typename T>
+   struct json_serializer<std::deque<T>>
+   {
+      static void write( json_writer& w, const std::deque<T>& value ) { detail::write_json_array( w, value ); }
+   };
+
+   template<typename T>
+   struct json_serializer<std::set<T>>
+   {
+      static void write( json_writer& w, const std::set<T>& value ) { detail::write_json_array( w, value ); }
+   };
+
+   template<typename T, typename... A>
+   struct json_serializer<boost::container::flat_set<T, A...>>
+   {
+      static void write( json_writer& w, const boost::container::flat_set<T, A...>& value ) { detail::write_json_array( w, value ); }
+   };
+
+   template<typename K, typename V>
+   struct json_serializer<std::pair<K, V>>
+   {
+      static void write( json_writer& w, const std::pair<K, V>& value )
+      {
+         w.write_raw( '[' );
+         w.write( value.first );
+         w.write_raw( ',' );
+         w.write( value.second );
+         w.write_raw( ']' );
+      }
+   };
+
+   /// maps become arrays of [key, value] pairs
+   template<typename K, typename V, typename... A>
+   struct json_serializer<std::map<K, V, A...>>
+   {
+      static void write( json_writer& w, const std::map<K, V, A...>& value ) { detail::write_json_array( w, value ); }
+   };
+
+   template<typename K, typename V, typename... A>
+   struct json_serializer<boost::container::flat_map<K, V, A...>>
+   {
+      static void write( json_writer& w, const boost::container::flat_map<K, V, A...>& value ) { detail::write_json_array( w, value ); }
+   };
+
+   /// static variants become [which, value]
+   template<typename... Types>
+   struct json_serializer<fc::static_variant<Types...>>
+   {
+      static void write( json_writer& w, const fc::static_variant<Types...>& value )
+      {
+         w.write_raw( '[' );
+         w.write_int64( value.which() );
+         w.write_raw( ',' );
+         value.visit( detail::json_static_variant_writer{ w } );
+         w.write_raw( ']' );
+      }
+   };
+
+} } // graphene::app
@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/variant.hpp>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace graphene { namespace app {
+
+   using graphene::db::object;
+   using graphene::db::object_id_type;
+
+   /// Cost of the object notifications sent for one block
+   struct notification_metrics
+   {
+      uint32_t block_num = 0;
+      /// notify_changed_objects calls while the block was head: its own and those of pending transactions
+      uint32_t rounds = 0;
+      /// objects converted to variants, each at most once per round
+      uint32_t objects_serialized = 0;
+      /// conversions saved because another session had already encoded the object
+      uint32_t cache_hits = 0;
+      /// update batches queued to subscribed sessions
+      uint32_t sessions_notified = 0;
+      /// objects in those batches
+      uint32_t updates_sent = 0;
+      int64_t  serialize_time_us = 0;
+   };
+
+   /**
+    * @brief Encodes changed objects once for all API sessions
+    *
+    * Every database_api session listens to the database's object signals and filters the ids by
+    * its own subscriptions; instead of converting the objects it keeps, it takes the shared
+    * encoding from here.  The cache connects in front of the sessions, so it starts a new round
+    * before any of them sees the ids of the next notify_changed_objects call.
+    */
+   class notification_cache
+   {
+      public:
+         explicit notification_cache( chain::database& db );
+
+         /** the full object encoding of obj for the current round */
+         const fc::variant& get( const object& obj );
+
+         /** counts a batch of updates queued to one session */
+         void record_broadcast( size_t updates );
+
+         /** metrics of the last block whose notifications are complete */
+         notification_metrics last_block_metrics()const;
+
+      private:
+         void begin_round();
+
+         chain::database&                                   _db;
+         std::unordered_map<object_id_type, fc::variant>    _encoded;
+         mutable std::mutex                                 _metrics_mutex;
+         notification_metrics                               _current;
+         notification_metrics                               _last;
+
+         boost::signals2::scoped_connection                 _new_connection;
+         boost::signals2::scoped_connection                 _change_connection;
+         boost::signals2::scoped_connection                 _removed_connection;
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::notification_metrics,
+            (block_num)(rounds)(objects_serialized)(cache_hits)(sessions_notified)(updates_sent)(serialize_time_us) )
@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/database.hpp>
+#include <graphene/db/index.hpp>
+
+#include <fc/variant.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace graphene { namespace app {
+
+   using graphene::db::object;
+   using graphene::db::object_id_type;
+
+   /**
+    * @brief Serialized objects shared by all API sessions
+    *
+    * Keeps the variant encoding of frequently requested objects (global properties, assets, license types,
+    * accounts) keyed by id, so get_objects neither looks them up nor converts them again while they are
+    * unchanged.  Only types registered with observe() are cached; the cache listens on their indexes and
+    * drops an entry whenever the object is added, modified or removed, undo included.
+    *
+    * Entries are filled by readers, possibly on API worker threads.  Each invalidation bumps a version, an
+    * encoding made before a change is never stored after it.  At most capacity entries are kept, the least
+    * recently read one is evicted to make room for a new one.
+    */
+   class object_cache : public graphene::db::index_observer, public std::enable_shared_from_this<object_cache>
+   {
+      public:
+         static const size_t default_capacity = 10000;
+
+         explicit object_cache( size_t capacity = default_capacity ) : _capacity( std::max<size_t>( capacity, 1 ) ) {}
+
+         /** starts caching objects of type T, call before the cache is shared with sessions */
+         template<typename T>
+         void observe( chain::database& db )
+         {
+            db.add_index_observer<T>( shared_from_this() );
+            _cached_types.insert( type_key( T::space_id, T::type_id ) );
+         }
+
+         bool is_cached_type( object_id_type id )const { return _cached_types.count( type_key( id.space(), id.type() ) ) > 0; }
+
+         /** the encoding of the object with this id, null when it does not exist */
+         fc::variant get( const chain::database& db, object_id_type id );
+
+         size_t   size()const;
+         size_t   capacity()const  { return _capacity; }
+         uint64_t hits()const      { return _hits; }
+         uint64_t misses()const    { return _misses; }
+         uint64_t evictions()const { return _evictions; }
+
+         virtual void on_add( const object& obj ) override    { invalidate( obj.id ); }
+         virtual void on_remove( const object& obj ) override { invalidate( obj.id ); }
+         virtual void on_modify( const object& obj ) override { invalidate( obj.id ); }
+
+      private:
+         static uint16_t type_key( uint8_t space_id, uint8_t type_id ) { return uint16_t( space_id ) << 8 | type_id; }
+
+         void invalidate( object_id_type id );
+
+         struct entry
+         {
+            fc::variant                           encoded;
+            std::list<object_id_type>::iterator   recent;
+         };
+
+         const size_t                                       _capacity;
+         std::unordered_set<uint16_t>                       _cached_types;
+         mutable std::mutex                                 _mutex;
+         std::unordered_map<object_id_type, entry>          _encoded;
+         /// ids of the entries, most recently read first
+         std::list<object_id_type>                          _recent;
+         uint64_t                                           _version = 0;
+         std::atomic<uint64_t>                              _hits{ 0 };
+         std::atomic<uint64_t>                              _misses{ 0 };
+         std::atomic<uint64_t>                              _evictions{ 0 };
+   };
+
+} } // graphene::app
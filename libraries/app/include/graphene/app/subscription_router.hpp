@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   using graphene::db::object;
+   using graphene::db::object_id_type;
+
+   /**
+    * @brief Routes the database's object notifications to the API sessions interested in them
+    *
+    * Keeps inverted indexes from object ids and account ids to the sessions subscribed to them,
+    * so the work per notification is proportional to the matches instead of sessions times changed
+    * objects.  Sessions are held weakly, one going away mid-notification is simply skipped.
+    */
+   class subscription_router
+   {
+      public:
+         typedef std::function<const object*(object_id_type)> object_lookup;
+
+         /// A session receiving routed notifications
+         class subscriber
+         {
+            public:
+               virtual ~subscriber() {}
+
+               /** objects the session subscribed to, in notification order */
+               virtual void on_objects_routed( bool full_object, const std::vector<object_id_type>& ids,
+                                               const object_lookup& find_object ) = 0;
+
+               /** changed call and limit orders, the session filters them by its markets */
+               virtual void on_orders_routed( bool full_object, const std::vector<object_id_type>& ids,
+                                              const object_lookup& find_object ) = 0;
+         };
+
+         /// objects one session may subscribe to individually, as many as its bloom filter used to be sized for
+         static const size_t max_objects_per_session = 10000;
+
+         explicit subscription_router( chain::database& db );
+
+         /** starts routing objects to s, dropping the objects and accounts it subscribed to before */
+         void watch_objects( const std::shared_ptr<subscriber>& s, bool notify_remove_create );
+         void stop_watching_objects( const subscriber* s );
+
+         void watch_markets( const std::shared_ptr<subscriber>& s, bool enabled );
+
+         /** ignored unless s watches objects */
+         void subscribe_to_object( const subscriber* s, object_id_type id );
+         /** every notification impacting account goes to s in full, ignored unless s watches objects */
+         void subscribe_to_account( const subscriber* s, chain::account_id_type account );
+
+         void remove( const subscriber* s );
+
+         size_t session_count()const;
+
+      private:
+         struct session_entry
+         {
+            std::weak_ptr<subscriber>          session;
+            bool                               watching_objects = false;
+            bool                               notify_remove_create = false;
+            bool                               markets = false;
+            std::set<object_id_type>           objects;
+            std::set<chain::account_id_type>   accounts;
+         };
+
+         void route( bool force_notify, bool full_object, const std::vector<object_id_type>& ids,
+                     const fc::flat_set<chain::account_id_type>& impacted_accounts, const object_lookup& find_object );
+         void clear_objects( const subscriber* s, session_entry& entry );
+         void erase_if_idle( const subscriber* s );
+
+         chain::database&                                                          _db;
+         mutable std::mutex                                                        _mutex;
+         std::unordered_map<const subscriber*, session_entry>                      _sessions;
+         std::unordered_map<object_id_type, std::set<const subscriber*>>           _by_object;
+         std::map<chain::account_id_type, std::set<const subscriber*>>             _by_account;
+         std::set<const subscriber*>                                               _notify_remove_create;
+         std::set<const subscriber*>                                               _market_sessions;
+
+         boost::signals2::scoped_connection                                        _new_connection;
+         boost::signals2::scoped_connection                                        _change_connection;
+         boost::signals2::scoped_connection                                        _removed_connection;
+   };
+
+} } // graphene::app
@@ -0,0 +1,201 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/app/json_api_connection.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+namespace graphene { namespace app {
+
+json_api_connection::json_api_connection( fc::http::websocket_connection& c, uint32_t max_depth,
+                                          const fc::api<database_api>& db_api )
+   : fc::rpc::websocket_api_connection( c, max_depth ),
+     _socket( c ),
+     _database_api( db_api ),
+     _max_depth( max_depth ),
+     _database_methods( db_api, max_depth )
+{
+   // takes over from the handlers installed by the base class, which stay the fallback
+   _socket.on_message_handler( [this]( const std::string& message ) { handle_message( message ); } );
+   _socket.on_http_handler( [this]( const std::string& request ) { return handle_http( request ); } );
+}
+
+void json_api_connection::handle_message( const std::string& message )
+{
+   fc::optional<std::string> response;
+   try
+   {
+      response = try_call( fc::json::from_string( message, fc::json::legacy_parser, _max_depth ) );
+   }
+   catch( const fc::exception& )
+   {
+   }
+   catch( const std::exception& )
+   {
+   }
+   // only requests that could not be parsed get here without a response, nothing has run for them yet and fc
+   // answers them; a database call that failed already carries its error response and must not run twice
+   if( response.valid() )
+      _socket.send_message( *response );
+   else
+      on_message( message, true );
+}
+
+std::string json_api_connection::handle_http( const std::string& request )
+{
+   fc::optional<std::string> response;
+   try
+   {
+      const fc::variant parsed = fc::json::from_string( request, fc::json::legacy_parser, _max_depth );
+      response = try_binary_raw_blocks( parsed );
+      if( !response.valid() )
+         response = try_call( parsed );
+   }
+   catch( const fc::exception& )
+   {
+   }
+   catch( const std::exception& )
+   {
+   }
+   // as for websocket messages, only requests that could not be parsed are left to fc
+   if( response.valid() )
+      return *response;
+   return on_message( request, false );
+}
+
+namespace {
+
+   /// the database API method requested by a JSON-RPC "call" on API id 0, or nullptr
+   const fc::variants* database_call( const fc::variant& request, std::string& method )
+   {
+      if( !request.is_object() )
+         return nullptr;
+      const fc::variant_object& obj = request.get_object();
+      if( !obj.contains( "id" ) || !obj.contains( "method" ) || !obj.contains( "params" ) )
+         return nullptr;
+      if( obj["method"].as_string() != "call" )
+         return nullptr;
+
+      const fc::variants& call = obj["params"].get_array();
+      if( call.size() != 3 || !call[0].is_numeric() || call[0].as_uint64() != 0 || !call[1].is_string() )
+         return nullptr;
+      method = call[1].as_string();
+      return &call[2].get_array();
+   }
+
+   /// a JSON-RPC error response in the format fc uses for failed calls
+   std::string error_response( const fc::variant& id, const fc::exception& e, uint32_t max_depth )
+   {
+      fc::mutable_variant_object error;
+      error( "code", 1 )( "message", e.to_string() )( "data", fc::variant( e, max_depth ) );
+
+      json_writer out( max_depth );
+      out.write_raw( "{\"id\":" );
+      out.write_variant( id );
+      out.write_raw( ",\"jsonrpc\":\"2.0\",\"error\":" );
+      out.write_variant( fc::variant( error ) );
+      out.write_raw( '}' );
+      return out.str();
+   }
+
+   void append_le32( std::string& out, uint32_t value )
+   {
+      for( int i = 0; i < 4; ++i )
+         out.push_back( char( ( value >> ( 8 * i ) ) & 0xff ) );
+   }
+
+}
+
+fc::optional<std::string> json_api_connection::try_binary_raw_blocks( const fc::variant& request )
+{
+   std::string name;
+   const fc::variants* params = database_call( request, name );
+   if( params == nullptr || name != "get_raw_blocks" || params->size() < 2 )
+      return {};
+   const fc::variant_object& obj = request.get_object();
+   if( !obj.contains( "framing" ) || obj["framing"].as_string() != "binary" )
+      return {};
+
+   vector<graphene::chain::raw_block> blocks;
+   try
+   {
+      blocks = _database_api->get_raw_blocks( (*params)[0].as_uint64(), (*params)[1].as_uint64() );
+   }
+   catch( const fc::exception& e )
+   {
+      return error_response( obj["id"], e, _max_depth );
+   }
+   catch( const std::exception& e )
+   {
+      return error_response( obj["id"], fc::std_exception_wrapper::from_current_exception( e ), _max_depth );
+   }
+
+   size_t size = 0;
+   for( const auto& block : blocks )
+      size += 8 + block.block_id.data_size() + block.data.size();
+
+   std::string out;
+   out.reserve( size );
+   for( const auto& block : blocks )
+   {
+      append_le32( out, block.block_num );
+      out.append( block.block_id.data(), block.block_id.data_size() );
+      append_le32( out, block.data.size() );
+      out.append( block.data.data(), block.data.size() );
+   }
+   return out;
+}
+
+fc::optional<std::string> json_api_connection::try_call( const fc::variant& request )
+{
+   std::string name;
+   const fc::variants* params = database_call( request, name );
+   if( params == nullptr )
+      return {};
+   const auto* method = _database_methods.find( name );
+   if( method == nullptr )
+      return {};
+   const fc::variant& id = request.get_object()["id"];
+
+   try
+   {
+      json_writer out( _max_depth );
+      out.write_raw( "{\"id\":" );
+      out.write_variant( id );
+      out.write_raw( ",\"jsonrpc\":\"2.0\",\"result\":" );
+      (*method)( *params, out );
+      out.write_raw( '}' );
+      return out.str();
+   }
+   catch( const fc::exception& e )
+   {
+      return error_response( id, e, _max_depth );
+   }
+   catch( const std::exception& e )
+   {
+      return error_response( id, fc::std_exception_wrapper::from_current_exception( e ), _max_depth );
+   }
+}
+
+} } // graphene::app
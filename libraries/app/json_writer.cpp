@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/app/json_writer.hpp>
+
+#include <fc/io/json.hpp>
+
+namespace graphene { namespace app {
+
+json_writer::json_writer( uint32_t max_depth )
+   : _max_depth( max_depth )
+{
+}
+
+void json_writer::write_string( const std::string& s )
+{
+   static const char* hex = "0123456789abcdef";
+   _buffer += '"';
+   for( char c : s )
+   {
+      switch( c )
+      {
+         case '"':  _buffer += "\\\""; break;
+         case '\\': _buffer += "\\\\"; break;
+         case '\b': _buffer += "\\b"; break;
+         case '\f': _buffer += "\\f"; break;
+         case '\n': _buffer += "\\n"; break;
+         case '\r': _buffer += "\\r"; break;
+         case '\t': _buffer += "\\t"; break;
+         default:
+            if( uint8_t(c) < 0x20 )
+            {
+               _buffer += "\\u00";
+               _buffer += hex[ uint8_t(c) >> 4 ];
+               _buffer += hex[ uint8_t(c) & 0xf ];
+            }
+            else
+               _buffer += c;
+      }
+   }
+   _buffer += '"';
+}
+
+// fc::json quotes integers that do not fit in 32 bits so javascript clients do not lose precision
+void json_writer::write_int64( int64_t i )
+{
+   if( i > 0xffffffff || i < -int64_t(0xffffffff) )
+   {
+      _buffer += '"';
+      _buffer += std::to_string( i );
+      _buffer += '"';
+   }
+   else
+      _buffer += std::to_string( i );
+}
+
+void json_writer::write_uint64( uint64_t u )
+{
+   if( u > 0xffffffff )
+   {
+      _buffer += '"';
+      _buffer += std::to_string( u );
+      _buffer += '"';
+   }
+   else
+      _buffer += std::to_string( u );
+}
+
+void json_writer::write_variant( const fc::variant& v )
+{
+   _buffer += fc::json::to_string( v, fc::json::stringify_large_ints_and_doubles, _max_depth );
+}
+
+} } // graphene::app
@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/app/notification_cache.hpp>
+
+#include <fc/time.hpp>
+
+namespace graphene { namespace app {
+
+notification_cache::notification_cache( chain::database& db )
+   : _db( db )
+{
+   _new_connection = _db.new_objects.connect( [this]( const std::vector<object_id_type>&,
+                                                      const fc::flat_set<chain::account_id_type>& ) {
+      begin_round();
+   }, boost::signals2::at_front );
+   _change_connection = _db.changed_objects.connect( [this]( const std::vector<object_id_type>&,
+                                                             const fc::flat_set<chain::account_id_type>& ) {
+      begin_round();
+   }, boost::signals2::at_front );
+   _removed_connection = _db.removed_objects.connect( [this]( const std::vector<object_id_type>&,
+                                                              const std::vector<const object*>&,
+                                                              const fc::flat_set<chain::account_id_type>& ) {
+      begin_round();
+   }, boost::signals2::at_front );
+}
+
+void notification_cache::begin_round()
+{
+   // the three signals of one notify_changed_objects call carry distinct ids, so dropping the
+   // encodings between them costs nothing and keeps removed objects from being served
+   _encoded.clear();
+
+   std::lock_guard<std::mutex> lock( _metrics_mutex );
+   const uint32_t block_num = _db.head_block_num();
+   if( block_num != _current.block_num )
+   {
+      if( _current.rounds )
+         _last = _current;
+      _current = notification_metrics();
+      _current.block_num = block_num;
+   }
+   ++_current.rounds;
+}
+
+const fc::variant& notification_cache::get( const object& obj )
+{
+   auto itr = _encoded.find( obj.id );
+   if( itr != _encoded.end() )
+   {
+      std::lock_guard<std::mutex> lock( _metrics_mutex );
+      ++_current.cache_hits;
+      return itr->second;
+   }
+
+   const fc::time_point start = fc::time_point::now();
+   const fc::variant& encoded = _encoded.emplace( obj.id, obj.to_variant() ).first->second;
+
+   std::lock_guard<std::mutex> lock( _metrics_mutex );
+   ++_current.objects_serialized;
+   _current.serialize_time_us += ( fc::time_point::now() - start ).count();
+   return encoded;
+}
+
+void notification_cache::record_broadcast( size_t updates )
+{
+   std::lock_guard<std::mutex> lock( _metrics_mutex );
+   ++_current.sessions_notified;
+   _current.updates_sent += updates;
+}
+
+notification_metrics notification_cache::last_block_metrics()const
+{
+   std::lock_guard<std::mutex> lock( _metrics_mutex );
+   return _last;
+}
+
+} } // graphene::app
@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/app/object_cache.hpp>
+
+namespace graphene { namespace app {
+
+const size_t object_cache::default_capacity;
+
+fc::variant object_cache::get( const chain::database& db, object_id_type id )
+{
+   uint64_t version;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      auto itr = _encoded.find( id );
+      if( itr != _encoded.end() )
+      {
+         ++_hits;
+         _recent.splice( _recent.begin(), _recent, itr->second.recent );
+         return itr->second.encoded;
+      }
+      version = _version;
+   }
+
+   ++_misses;
+   const object* obj = db.find_object( id );
+   if( obj == nullptr )
+      return {};
+   fc::variant encoded = obj->to_variant();
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( version == _version && _encoded.find( id ) == _encoded.end() )
+   {
+      if( _encoded.size() >= _capacity )
+      {
+         _encoded.erase( _recent.back() );
+         _recent.pop_back();
+         ++_evictions;
+      }
+      _recent.push_front( id );
+      _encoded.emplace( id, entry{ encoded, _recent.begin() } );
+   }
+   return encoded;
+}
+
+size_t object_cache::size()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _encoded.size();
+}
+
+void object_cache::invalidate( object_id_type id )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   ++_version;
+   auto itr = _encoded.find( id );
+   if( itr == _encoded.end() )
+      return;
+   _recent.erase( itr->second.recent );
+   _encoded.erase( itr );
+}
+
+} } // graphene::app
@@ -0,0 +1,235 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/app/subscription_router.hpp>
+
+#include <graphene/chain/market_object.hpp>
+
+namespace graphene { namespace app {
+
+namespace {
+
+   /// what one notification carries to one session
+   struct delivery
+   {
+      std::shared_ptr<subscription_router::subscriber> session;
+      bool                                             all_ids = false;
+      std::vector<object_id_type>                      ids;
+   };
+
+}
+
+subscription_router::subscription_router( chain::database& db )
+   : _db( db )
+{
+   _new_connection = _db.new_objects.connect( [this]( const std::vector<object_id_type>& ids,
+                                                      const fc::flat_set<chain::account_id_type>& impacted_accounts ) {
+      route( true, true, ids, impacted_accounts, std::bind( &chain::database::find_object, &_db, std::placeholders::_1 ) );
+   } );
+   _change_connection = _db.changed_objects.connect( [this]( const std::vector<object_id_type>& ids,
+                                                             const fc::flat_set<chain::account_id_type>& impacted_accounts ) {
+      route( false, true, ids, impacted_accounts, std::bind( &chain::database::find_object, &_db, std::placeholders::_1 ) );
+   } );
+   _removed_connection = _db.removed_objects.connect( [this]( const std::vector<object_id_type>& ids,
+                                                              const std::vector<const object*>& objs,
+                                                              const fc::flat_set<chain::account_id_type>& impacted_accounts ) {
+      route( true, false, ids, impacted_accounts, [&objs]( object_id_type id ) -> const object* {
+         auto itr = std::find_if( objs.begin(), objs.end(), [id]( const object* o ) { return o != nullptr && o->id == id; } );
+         return itr != objs.end() ? *itr : nullptr;
+      } );
+   } );
+}
+
+void subscription_router::watch_objects( const std::shared_ptr<subscriber>& s, bool notify_remove_create )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   session_entry& entry = _sessions[s.get()];
+   entry.session = s;
+   clear_objects( s.get(), entry );
+   entry.watching_objects = true;
+   entry.notify_remove_create = notify_remove_create;
+   if( notify_remove_create )
+      _notify_remove_create.insert( s.get() );
+}
+
+void subscription_router::stop_watching_objects( const subscriber* s )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _sessions.find( s );
+   if( itr == _sessions.end() )
+      return;
+   clear_objects( s, itr->second );
+   itr->second.watching_objects = false;
+   erase_if_idle( s );
+}
+
+void subscription_router::watch_markets( const std::shared_ptr<subscriber>& s, bool enabled )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( enabled )
+   {
+      session_entry& entry = _sessions[s.get()];
+      entry.session = s;
+      entry.markets = true;
+      _market_sessions.insert( s.get() );
+      return;
+   }
+   auto itr = _sessions.find( s.get() );
+   if( itr == _sessions.end() )
+      return;
+   itr->second.markets = false;
+   _market_sessions.erase( s.get() );
+   erase_if_idle( s.get() );
+}
+
+void subscription_router::subscribe_to_object( const subscriber* s, object_id_type id )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _sessions.find( s );
+   if( itr == _sessions.end() || !itr->second.watching_objects )
+      return;
+   session_entry& entry = itr->second;
+   if( entry.objects.size() >= max_objects_per_session )
+      return;
+   if( entry.objects.insert( id ).second )
+      _by_object[id].insert( s );
+}
+
+void subscription_router::subscribe_to_account( const subscriber* s, chain::account_id_type account )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _sessions.find( s );
+   if( itr == _sessions.end() || !itr->second.watching_objects )
+      return;
+   if( itr->second.accounts.insert( account ).second )
+      _by_account[account].insert( s );
+}
+
+void subscription_router::remove( const subscriber* s )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _sessions.find( s );
+   if( itr == _sessions.end() )
+      return;
+   clear_objects( s, itr->second );
+   _market_sessions.erase( s );
+   _sessions.erase( itr );
+}
+
+size_t subscription_router::session_count()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _sessions.size();
+}
+
+void subscription_router::clear_objects( const subscriber* s, session_entry& entry )
+{
+   for( const object_id_type& id : entry.objects )
+   {
+      auto itr = _by_object.find( id );
+      itr->second.erase( s );
+      if( itr->second.empty() )
+         _by_object.erase( itr );
+   }
+   for( const chain::account_id_type& account : entry.accounts )
+   {
+      auto itr = _by_account.find( account );
+      itr->second.erase( s );
+      if( itr->second.empty() )
+         _by_account.erase( itr );
+   }
+   entry.objects.clear();
+   entry.accounts.clear();
+   entry.notify_remove_create = false;
+   _notify_remove_create.erase( s );
+}
+
+void subscription_router::erase_if_idle( const subscriber* s )
+{
+   auto itr = _sessions.find( s );
+   if( itr != _sessions.end() && !itr->second.watching_objects && !itr->second.markets )
+      _sessions.erase( itr );
+}
+
+void subscription_router::route( bool force_notify, bool full_object, const std::vector<object_id_type>& ids,
+                                 const fc::flat_set<chain::account_id_type>& impacted_accounts,
+                                 const object_lookup& find_object )
+{
+   std::map<const subscriber*, delivery> objects;
+   std::vector<std::shared_ptr<subscriber>> market_sessions;
+   std::vector<object_id_type> orders;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      auto deliver_all = [&]( const subscriber* s ) {
+         objects[s].all_ids = true;
+      };
+
+      if( force_notify )
+         std::for_each( _notify_remove_create.begin(), _notify_remove_create.end(), deliver_all );
+      // like before, a subscribed account impacted by any of the objects gets all of them
+      for( const chain::account_id_type& account : impacted_accounts )
+      {
+         auto itr = _by_account.find( account );
+         if( itr != _by_account.end() )
+            std::for_each( itr->second.begin(), itr->second.end(), deliver_all );
+      }
+      if( !_by_object.empty() )
+      {
+         for( const object_id_type& id : ids )
+         {
+            auto itr = _by_object.find( id );
+            if( itr == _by_object.end() )
+               continue;
+            for( const subscriber* s : itr->second )
+            {
+               delivery& d = objects[s];
+               if( !d.all_ids )
+                  d.ids.push_back( id );
+            }
+         }
+      }
+
+      for( auto& item : objects )
+         item.second.session = _sessions[item.first].session.lock();
+
+      if( !_market_sessions.empty() )
+      {
+         for( const object_id_type& id : ids )
+            if( id.is<chain::call_order_object>() || id.is<chain::limit_order_object>() )
+               orders.push_back( id );
+         if( !orders.empty() )
+            for( const subscriber* s : _market_sessions )
+               market_sessions.push_back( _sessions[s].session.lock() );
+      }
+   }
+
+   // the sessions take their own locks, so they are called with the router unlocked
+   for( const auto& item : objects )
+      if( item.second.session )
+         item.second.session->on_objects_routed( full_object, item.second.all_ids ? ids : item.second.ids, find_object );
+   for( const auto& session : market_sessions )
+      if( session )
+         session->on_orders_routed( full_object, orders, find_object );
+}
+
+} } // graphene::app
@@ -78,6 +78,24 @@ vector<signed_block_with_virtual_operations_and_num> database_access_layer::get_
     return result;
 }
 
+vector<raw_block> database_access_layer::get_raw_blocks(uint32_t start_block_num, uint32_t count) const
+{
+    // Raw blocks cost no conversion on the node, only the reply size needs bounding:
+    const uint32_t max_count = 10000;
+    const size_t max_bytes = 16 * 1024 * 1024;
+
+    FC_ASSERT(count > 0, "Must fetch at least one block");
+    FC_ASSERT(count <= max_count, "Too many blocks to fetch, limit is ${max}", ("max", max_count));
+    FC_ASSERT(start_block_num > 0, "Starting block must be higher than 0.");
+    auto head_block_num = _db.head_block_num();
+    FC_ASSERT(start_block_num <= head_block_num,
+              "Starting block ${start_n} is higher than current block height ${head_n}",
+              ("start_n", start_block_num)
+              ("head_n", head_block_num));
+
+    return _db.fetch_raw_blocks_by_number(start_block_num, count, max_bytes);
+}
+
 // Balances:
 acc_id_share_t_res database_access_layer::get_free_cycle_balance(account_id_type id) const
 {
@@ -447,6 +465,89 @@ vector<acc_id_vault_info_res> database_access_layer::get_vaults_info(vector<acco
     });
 }
 
+vector<acc_id_vault_dashboard_res> database_access_layer::get_vault_dashboards(const vector<account_id_type>& vault_ids) const
+{
+    const auto& accounts = _db.get_index_type<account_index>().indices().get<by_id>();
+    const auto& licenses = _db.get_index_type<license_information_index>().indices().get<by_account_id>();
+    const auto& queue = _db.get_index_type<reward_queue_index>().indices();
+    const auto& queue_by_account = queue.get<by_account>();
+    const auto web_asset_id = _db.get_web_asset_id();
+    const auto dascoin_asset_id = _db.get_dascoin_asset_id();
+
+    vector<acc_id_vault_dashboard_res> result;
+    result.reserve(vault_ids.size());
+
+    // Results waiting for queue positions, by account:
+    flat_map<account_id_type, vector<size_t>> with_submissions;
+    size_t submission_count = 0;
+
+    for (auto vault_id : vault_ids) {
+        const auto account_it = accounts.find(vault_id);
+        if (account_it == accounts.end() || !account_it->is_vault()) {
+            result.emplace_back(vault_id);
+            continue;
+        }
+        const account_object& account = *account_it;
+
+        result.emplace_back(vault_id, vault_dashboard_res{});
+        vault_dashboard_res& dashboard = *result.back().result;
+        vault_info_res& info = dashboard.info;
+
+        const auto& webeur_balance = _db.get_balance_object(vault_id, web_asset_id);
+        const auto& dascoin_balance = _db.get_balance_object(vault_id, dascoin_asset_id);
+        const auto license_it = licenses.find(vault_id);
+        if (license_it != licenses.end())
+            info.license_information = *license_it;
+
+        info.cash_balance = webeur_balance.balance;
+        info.reserved_balance = webeur_balance.reserved;
+        info.dascoin_balance = dascoin_balance.balance;
+        info.free_cycle_balance = _db.get_cycle_balance(vault_id);
+        info.dascoin_limit = dascoin_balance.limit;
+        info.eur_limit = _db.get_eur_limit(info.license_information);
+        info.spent = dascoin_balance.spent;
+        info.is_tethered = account.is_tethered();
+        info.owner_change_counter = account.owner_change_counter;
+        info.active_change_counter = account.active_change_counter;
+
+        dashboard.cycle_balances.emplace_back(info.free_cycle_balance, 0);
+        size_t entries = 0;
+        const auto range = queue_by_account.equal_range(vault_id);
+        for (auto it = range.first; it != range.second; ++it, ++entries)
+            dashboard.cycle_balances.emplace_back(it->amount, it->frequency);
+        if (entries > 0) {
+            auto& waiting = with_submissions[vault_id];
+            if (waiting.empty())
+                submission_count += entries;
+            waiting.push_back(result.size() - 1);
+        }
+    }
+
+    // A position is the rank in the time ordered queue, one walk over it serves every submission in the batch
+    // instead of counting from the front for each one:
+    uint32_t position = 0;
+    const auto& queue_by_time = queue.get<by_time>();
+    for (auto it = queue_by_time.begin(); submission_count > 0 && it != queue_by_time.end(); ++it, ++position) {
+        const auto wanted = with_submissions.find(it->account);
+        if (wanted == with_submissions.end())
+            continue;
+        for (auto index : wanted->second)
+            result[index].result->queue_submissions.emplace_back(position, *it);
+        --submission_count;
+    }
+
+    // Same order as get_queue_submissions_with_pos:
+    for (const auto& wanted : with_submissions)
+        for (auto index : wanted.second) {
+            auto& submissions = result[index].result->queue_submissions;
+            std::sort(submissions.begin(), submissions.end(), [](const sub_w_pos& a, const sub_w_pos& b) {
+                return a.submission.id < b.submission.id;
+            });
+        }
+
+    return result;
+}
+
 optional<asset_object> database_access_layer::lookup_asset_symbol(const string& symbol_or_id) const
 {
     return get_asset_symbol(_db.get_index_type<asset_index>(), symbol_or_id);
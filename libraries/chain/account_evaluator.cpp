@@ -89,31 +89,11 @@ void verify_account_votes( const database& db, const account_options& options )
 }
 
 
-void_result account_create_evaluator::do_evaluate( const account_create_operation& op )
-{ try {
-   database& d = db();
-   account_id_type registrar_id = d.get_global_properties().authorities.registrar;
-
-   if( d.head_block_time() < HARDFORK_516_TIME )
-   {
-      FC_ASSERT( !op.extensions.value.owner_special_authority.valid() );
-      FC_ASSERT( !op.extensions.value.active_special_authority.valid() );
-   }
-   if( d.head_block_time() < HARDFORK_599_TIME )
-   {
-      FC_ASSERT( !op.extensions.value.null_ext.valid() );
-      FC_ASSERT( !op.extensions.value.owner_special_authority.valid() );
-      FC_ASSERT( !op.extensions.value.active_special_authority.valid() );
-      FC_ASSERT( !op.extensions.value.buyback_options.valid() );
-   }
-
+void verify_account_create( const database& d, const account_create_operation& op )
+{
    FC_ASSERT( d.find_object(op.options.voting_account), "Invalid proxy account specified." );
    FC_ASSERT( op.referrer(d).is_member(d.head_block_time()), "The referrer must be either a lifetime or annual subscriber." );
 
-   // Check for validity of chain authorities:
-   if ( !skip_chain_authority_check() )
-      FC_ASSERT( fee_paying_account->id == registrar_id, "Account can only be registered by current registrar chain authority" );
-
    try
    {
       verify_authority_accounts( d, op.owner );
@@ -137,33 +117,10 @@ void_result account_create_evaluator::do_evaluate( const account_create_operatio
       FC_ASSERT( current_account_itr == acnt_indx.indices().get<by_name>().end(),
                  "Account '${a}' already exists.", ("a",op.name) );
    }
+}
 
-   return void_result();
-} FC_CAPTURE_AND_RETHROW( (op) ) }
-
-object_id_type account_create_evaluator::do_apply( const account_create_operation& o )
-{ try {
-
-   database& d = db();
-   uint16_t referrer_percent = o.referrer_percent;
-   bool has_small_percent = (
-         (db().head_block_time() <= HARDFORK_453_TIME)
-      && (o.referrer != o.registrar  )
-      && (o.referrer_percent != 0    )
-      && (o.referrer_percent <= 0x100)
-      );
-
-   if( has_small_percent )
-   {
-      if( referrer_percent >= 100 )
-      {
-         wlog( "between 100% and 0x100%:  ${o}", ("o", o) );
-      }
-      referrer_percent = referrer_percent*100;
-      if( referrer_percent > GRAPHENE_100_PERCENT )
-         referrer_percent = GRAPHENE_100_PERCENT;
-   }
-
+const account_object& create_account_objects( database& d, const account_create_operation& o, uint16_t referrer_percent )
+{
    const auto& global_properties = d.get_global_properties();
 
    const auto& new_acnt_object = d.create<account_object>( [&o,&d,&global_properties,referrer_percent]( account_object& obj )
@@ -209,6 +166,70 @@ object_id_type account_create_evaluator::do_apply( const account_create_operatio
             obj.disable_vault_to_wallet_limit = true;
    });
 
+   // Each account is more or less guaranteed to have some cycles assigned to it.
+   d.create_empty_cycle_balance(new_acnt_object.id);
+
+   // Same goes for dascoin and web asset(s):
+   // TODO: this needs to be done of every kind of web asset there is!
+   d.create_empty_balance(new_acnt_object.id, d.get_dascoin_asset_id());
+   d.create_empty_balance(new_acnt_object.id, d.get_web_asset_id());
+   d.create_empty_balance(new_acnt_object.id, d.get_cycle_asset_id());
+
+   return new_acnt_object;
+}
+
+void_result account_create_evaluator::do_evaluate( const account_create_operation& op )
+{ try {
+   database& d = db();
+   account_id_type registrar_id = d.get_global_properties().authorities.registrar;
+
+   if( d.head_block_time() < HARDFORK_516_TIME )
+   {
+      FC_ASSERT( !op.extensions.value.owner_special_authority.valid() );
+      FC_ASSERT( !op.extensions.value.active_special_authority.valid() );
+   }
+   if( d.head_block_time() < HARDFORK_599_TIME )
+   {
+      FC_ASSERT( !op.extensions.value.null_ext.valid() );
+      FC_ASSERT( !op.extensions.value.owner_special_authority.valid() );
+      FC_ASSERT( !op.extensions.value.active_special_authority.valid() );
+      FC_ASSERT( !op.extensions.value.buyback_options.valid() );
+   }
+
+   // Check for validity of chain authorities:
+   if ( !skip_chain_authority_check() )
+      FC_ASSERT( fee_paying_account->id == registrar_id, "Account can only be registered by current registrar chain authority" );
+
+   verify_account_create( d, op );
+
+   return void_result();
+} FC_CAPTURE_AND_RETHROW( (op) ) }
+
+object_id_type account_create_evaluator::do_apply( const account_create_operation& o )
+{ try {
+
+   database& d = db();
+   uint16_t referrer_percent = o.referrer_percent;
+   bool has_small_percent = (
+         (db().head_block_time() <= HARDFORK_453_TIME)
+      && (o.referrer != o.registrar  )
+      && (o.referrer_percent != 0    )
+      && (o.referrer_percent <= 0x100)
+      );
+
+   if( has_small_percent )
+   {
+      if( referrer_percent >= 100 )
+      {
+         wlog( "between 100% and 0x100%:  ${o}", ("o", o) );
+      }
+      referrer_percent = referrer_percent*100;
+      if( referrer_percent > GRAPHENE_100_PERCENT )
+         referrer_percent = GRAPHENE_100_PERCENT;
+   }
+
+   const auto& new_acnt_object = create_account_objects( d, o, referrer_percent );
+
    if( has_small_percent )
    {
       wlog( "Account affected by #453 registered in block ${n}:  ${na} reg=${reg} ref=${ref}:${refp} ltr=${ltr}:${ltrp}",
@@ -255,15 +276,6 @@ object_id_type account_create_evaluator::do_apply( const account_create_operatio
       } );
    }
 
-   // Each account is more or less guaranteed to have some cycles assigned to it.
-   db().create_empty_cycle_balance(new_acnt_object.id);
-
-   // Same goes for dascoin and web asset(s):
-   // TODO: this needs to be done of every kind of web asset there is!
-   db().create_empty_balance(new_acnt_object.id, db().get_dascoin_asset_id());
-   db().create_empty_balance(new_acnt_object.id, db().get_web_asset_id());
-   db().create_empty_balance(new_acnt_object.id, db().get_cycle_asset_id());
-
    if ( new_acnt_object.is_vault() )
    {
       const auto daily_price = dynamic_properties.last_daily_dascoin_price;
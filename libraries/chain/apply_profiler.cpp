@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/apply_profiler.hpp>
+#include <graphene/chain/protocol/operations.hpp>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+   const size_t phase_count = static_cast<size_t>( apply_phase::APPLY_PHASE_COUNT );
+
+   struct operation_name_visitor
+   {
+      typedef string result_type;
+
+      template<typename Type>
+      result_type operator()( const Type& )const
+      {
+         string name = fc::get_typename<Type>::name();
+         size_t p = name.rfind(':');
+         if( p != string::npos )
+            name = name.substr( p+1 );
+         return name;
+      }
+   };
+
+}
+
+void apply_profiler::tick_stats::add( uint64_t ticks )
+{
+   ++count;
+   total += ticks;
+   max = std::max( max, ticks );
+   size_t bucket = 0;
+   while( (ticks >>= 1) && bucket + 1 < histogram_buckets )
+      ++bucket;
+   ++histogram[bucket];
+}
+
+apply_profiler::apply_profiler()
+{
+   reset();
+}
+
+void apply_profiler::enable( bool on )
+{
+   _enabled.store( on, std::memory_order_relaxed );
+}
+
+void apply_profiler::reset()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _totals = profile_data();
+   _totals.slots.resize( phase_count + operation::count() );
+   _block = _totals;
+   _reset_ticks = now_ticks();
+   _reset_time = fc::time_point::now();
+}
+
+void apply_profiler::keep_block_profiles( bool on )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _keep_block_profiles = on;
+}
+
+void apply_profiler::begin_block( uint32_t block_num )
+{
+   if( !enabled() )
+      return;
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( !_totals.first_block )
+      _totals.first_block = block_num;
+   _totals.last_block = block_num;
+   if( _keep_block_profiles )
+   {
+      for( tick_stats& s : _block.slots )
+         s = tick_stats();
+      _block.first_block = _block.last_block = block_num;
+   }
+}
+
+apply_profile apply_profiler::take_block_profile()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   apply_profile result = to_profile( _block );
+   for( tick_stats& s : _block.slots )
+      s = tick_stats();
+   _block.first_block = _block.last_block = 0;
+   return result;
+}
+
+apply_profile apply_profiler::get_profile()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return to_profile( _totals );
+}
+
+void apply_profiler::record_phase( apply_phase phase, uint64_t ticks )
+{
+   record( static_cast<size_t>( phase ), ticks );
+}
+
+void apply_profiler::record_operation( int which, uint64_t ticks )
+{
+   record( phase_count + which, ticks );
+}
+
+void apply_profiler::record( size_t slot, uint64_t ticks )
+{
+   if( !enabled() )
+      return;
+   std::lock_guard<std::mutex> lock( _mutex );
+   _totals.slots[slot].add( ticks );
+   if( _keep_block_profiles )
+      _block.slots[slot].add( ticks );
+}
+
+apply_profile apply_profiler::to_profile( const profile_data& data )const
+{
+   apply_profile result;
+   result.enabled = enabled();
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+   result.tick_unit = "tsc";
+#else
+   result.tick_unit = "ns";
+#endif
+   result.first_block = data.first_block;
+   result.last_block = data.last_block;
+   result.elapsed_ticks = now_ticks() - _reset_ticks;
+   result.elapsed_us = ( fc::time_point::now() - _reset_time ).count();
+
+   operation op;
+   for( size_t slot = 0; slot < data.slots.size(); ++slot )
+   {
+      const tick_stats& s = data.slots[slot];
+      if( !s.count )
+         continue;
+
+      apply_profile_entry entry;
+      if( slot < phase_count )
+         entry.name = fc::reflector<apply_phase>::to_string( static_cast<apply_phase>( slot ) );
+      else
+      {
+         op.set_which( slot - phase_count );
+         entry.name = op.visit( operation_name_visitor() );
+      }
+      entry.count = s.count;
+      entry.total_ticks = s.total;
+      entry.max_ticks = s.max;
+      // trailing empty buckets are left out
+      size_t used = histogram_buckets;
+      while( used > 0 && !s.histogram[used - 1] )
+         --used;
+      entry.histogram.assign( s.histogram.begin(), s.histogram.begin() + used );
+
+      ( slot < phase_count ? result.phases : result.operations ).push_back( std::move( entry ) );
+   }
+   return result;
+}
+
+} } // graphene::chain
@@ -40,20 +40,22 @@ namespace graphene { namespace chain {
 
 void block_database::open( const fc::path& dbdir )
 { try {
+   std::lock_guard<std::mutex> lock( _mutex );
    fc::create_directories(dbdir);
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
    _index_filename = dbdir / "index";
+   _blocks_filename = dbdir / "blocks";
    if( !fc::exists( _index_filename ) )
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
    }
    else
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
    }
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
@@ -64,18 +66,21 @@ bool block_database::is_open()const
 
 void block_database::close()
 {
+   std::lock_guard<std::mutex> lock( _mutex );
   _blocks.close();
   _block_num_to_pos.close();
 }
 
 void block_database::flush()
 {
+   std::lock_guard<std::mutex> lock( _mutex );
   _blocks.flush();
   _block_num_to_pos.flush();
 }
 
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
+   std::lock_guard<std::mutex> lock( _mutex );
    block_id_type id = _id;
    if( id == block_id_type() )
    {
@@ -95,6 +100,7 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
 
 void block_database::remove( const block_id_type& id )
 { try {
+   std::lock_guard<std::mutex> lock( _mutex );
    index_entry e;
    int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -114,6 +120,7 @@ void block_database::remove( const block_id_type& id )
 
 bool block_database::contains( const block_id_type& id )const
 {
+   std::lock_guard<std::mutex> lock( _mutex );
    if( id == block_id_type() )
       return false;
 
@@ -130,6 +137,7 @@ bool block_database::contains( const block_id_type& id )const
 
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
+   std::lock_guard<std::mutex> lock( _mutex );
    assert( block_num != 0 );
    index_entry e;
    int64_t index_pos = sizeof(e) * int64_t(block_num);
@@ -146,6 +154,7 @@ block_id_type block_database::fetch_block_id( uint32_t block_num )const
 
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
 {
+   std::lock_guard<std::mutex> lock( _mutex );
    try
    {
       index_entry e;
@@ -178,6 +187,7 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
 
 optional<signed_block> block_database::fetch_by_number( uint32_t block_num )const
 {
+   std::lock_guard<std::mutex> lock( _mutex );
    try
    {
       index_entry e;
@@ -207,6 +217,7 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
 }
 
 optional<index_entry> block_database::last_index_entry()const {
+   std::lock_guard<std::mutex> lock( _mutex );
    try
    {
       index_entry e;
@@ -257,6 +268,58 @@ optional<index_entry> block_database::last_index_entry()const {
    return optional<index_entry>();
 }
 
+vector<raw_block> block_database::fetch_raw_range( uint32_t first_block_num, uint32_t count, size_t max_bytes )const
+{ try {
+   vector<raw_block> result;
+   vector<index_entry> entries;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
+      const int64_t stored = int64_t(_block_num_to_pos.tellg()) / int64_t(sizeof(index_entry));
+      if( count == 0 || stored <= int64_t(first_block_num) )
+         return result;
+      count = std::min<int64_t>( count, stored - first_block_num );
+
+      // the index entries of the range sit next to each other
+      entries.resize( count );
+      _block_num_to_pos.seekg( sizeof(index_entry) * int64_t(first_block_num) );
+      _block_num_to_pos.read( (char*)entries.data(), sizeof(index_entry) * count );
+
+      // blocks still buffered by store() must reach the file before it is read through another stream
+      _blocks.flush();
+   }
+
+   size_t total = 0;
+   for( uint32_t i = 0; i < count; ++i )
+   {
+      const index_entry& e = entries[i];
+      if( e.block_size == 0 || e.block_id == block_id_type() )
+         break;
+      if( !result.empty() && total + e.block_size > max_bytes )
+         break;
+      total += e.block_size;
+      result.emplace_back();
+      result.back().block_num = first_block_num + i;
+      result.back().block_id = e.block_id;
+   }
+
+   // stored blocks never change, so a range of up to max_bytes is read through a stream of its own and
+   // without the mutex, which would otherwise hold up store() on the thread applying blocks
+   std::ifstream blocks;
+   blocks.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   blocks.open( _blocks_filename.generic_string().c_str(), std::ios_base::binary | std::ios_base::in );
+
+   // consecutive blocks are usually back to back in the log, read such a run with a single seek
+   for( size_t i = 0; i < result.size(); ++i )
+   {
+      if( i == 0 || entries[i].block_pos != entries[i-1].block_pos + entries[i-1].block_size )
+         blocks.seekg( entries[i].block_pos );
+      result[i].data.resize( entries[i].block_size );
+      blocks.read( result[i].data.data(), entries[i].block_size );
+   }
+   return result;
+} FC_CAPTURE_AND_RETHROW( (first_block_num)(count) ) }
+
 optional<signed_block> block_database::last()const
 {
    optional<index_entry> entry = last_index_entry();
@@ -31,11 +31,15 @@
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/transaction_object.hpp>
+#include <graphene/chain/virtual_op_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/evaluator.hpp>
 
+#include <algorithm>
+#include <future>
+
 namespace graphene { namespace chain {
 
 bool database::is_known_block( const block_id_type& id )const
@@ -76,6 +80,15 @@ optional<signed_block> database::fetch_block_by_number( uint32_t num )const
    return optional<signed_block>();
 }
 
+vector<raw_block> database::fetch_raw_blocks_by_number( uint32_t first_num, uint32_t count, size_t max_bytes )const
+{
+   // every pushed block is stored, a fork switch overwrites the numbers it replaces
+   if( first_num > head_block_num() )
+      return {};
+   count = std::min( count, head_block_num() - first_num + 1 );
+   return _block_id_to_block.fetch_raw_range( first_num, count, max_bytes );
+}
+
 optional<signed_block_with_virtual_operations> database::fetch_block_with_virtual_operations_by_number( uint32_t block_num, std::vector<uint16_t> virtual_op_id_vec)const
 {
    auto results = _fork_db.fetch_block_by_number(block_num);
@@ -87,6 +100,29 @@ optional<signed_block_with_virtual_operations> database::fetch_block_with_virtua
 
    signed_block_with_virtual_operations ret_v(*ret);
 
+   // the index only covers the retention window, and only from the block it was first filled at
+   const auto& vop_idx = get_index_type<virtual_op_index>().indices().get<by_block_type>();
+   if( _virtual_op_retention > 0 && block_num + _virtual_op_retention > head_block_num()
+       && !vop_idx.empty() && vop_idx.begin()->block_num <= block_num )
+   {
+      // one range per requested type, merged back into the order the operations were applied in
+      vector<const virtual_op_object*> found;
+      for( auto vop_id : flat_set<uint16_t>( virtual_op_id_vec.begin(), virtual_op_id_vec.end() ) )
+      {
+         auto range = vop_idx.equal_range( boost::make_tuple( block_num, vop_id ) );
+         for( auto itr = range.first; itr != range.second; ++itr )
+            found.push_back( &*itr );
+      }
+      std::sort( found.begin(), found.end(), []( const virtual_op_object* a, const virtual_op_object* b ) {
+         return a->op_in_block < b->op_in_block;
+      });
+      ret_v.virtual_operations.reserve( found.size() );
+      for( const auto* vop : found )
+         ret_v.virtual_operations.push_back( vop->op );
+      return ret_v;
+   }
+
+   // not in the virtual op store, fall back to whatever the history plugins kept
    const auto& hist_idx = get_index_type<operation_history_index>();
    const auto& by_blnum_idx = hist_idx.indices().get<by_blnum>();
    auto itr = by_blnum_idx.lower_bound( block_num );
@@ -144,6 +180,7 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
 bool database::push_block(const signed_block& new_block, uint32_t skip)
 {
    //idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
+   detail::chain_state_writer writer( *this );
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -188,10 +225,7 @@ bool database::_push_block(const signed_block& new_block)
                 ilog( "pushing block from fork #${n} ${id}", ("n",(*ritr)->data.block_num())("id",(*ritr)->id) );
                 optional<fc::exception> except;
                 try {
-                   undo_database::session session = _undo_db.start_undo_session();
-                   apply_block( (*ritr)->data, skip );
-                   _block_id_to_block.store( (*ritr)->id, (*ritr)->data );
-                   session.commit();
+                   apply_fork_block( *ritr, skip );
                 }
                 catch ( const fc::exception& e ) { except = e; }
                 if( except )
@@ -218,10 +252,7 @@ bool database::_push_block(const signed_block& new_block)
                    for( auto ritr2 = branches.second.rbegin(); ritr2 != branches.second.rend(); ++ritr2 )
                    {
                       ilog( "pushing block #${n} ${id}", ("n",(*ritr2)->data.block_num())("id",(*ritr2)->id) );
-                      auto session = _undo_db.start_undo_session();
-                      apply_block( (*ritr2)->data, skip );
-                      _block_id_to_block.store( (*ritr2)->id, (*ritr2)->data );
-                      session.commit();
+                      apply_fork_block( *ritr2, skip );
                    }
                    throw *except;
                 }
@@ -257,6 +288,7 @@ bool database::_push_block(const signed_block& new_block)
  */
 processed_transaction database::push_transaction( const signed_transaction& trx, uint32_t skip )
 { try {
+   detail::chain_state_writer writer( *this );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -280,6 +312,7 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    auto temp_session = _undo_db.start_undo_session();
    auto processed_trx = _apply_transaction( trx );
    _pending_tx.push_back(processed_trx);
+   ++_pending_tx_version;
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
@@ -292,6 +325,8 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
 
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
+   // the transaction is applied and undone, pooled API readers must not see it half way
+   detail::chain_state_writer writer( *this );
    auto session = _undo_db.start_undo_session();
    return _apply_transaction( trx );
 }
@@ -323,6 +358,7 @@ processed_transaction database::push_proposal(const proposal_object& proposal)
       }
       else
       {
+         _applied_op_seq -= _applied_ops.size() - old_applied_ops_size;
          _applied_ops.resize( old_applied_ops_size );
       }
       wlog( "${e}", ("e",e.to_detail_string() ) );
@@ -340,6 +376,7 @@ signed_block database::generate_block(
    uint32_t skip /* = 0 */
    )
 { try {
+   detail::chain_state_writer writer( *this );
    signed_block result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -386,11 +423,23 @@ signed_block database::_generate_block(
    _pending_tx_session.reset();
    _pending_tx_session = _undo_db.start_undo_session();
 
+   // the checks that do not depend on chain state, unless prevalidate_pending_transactions() did them
+   const auto checked = prevalidate_transactions( _pending_tx );
+
    uint64_t postponed_tx_count = 0;
    // pop pending state (reset to head block state)
-   for( const processed_transaction& tx : _pending_tx )
+   for( size_t i = 0; i < _pending_tx.size(); ++i )
    {
-      size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+      const processed_transaction& tx = _pending_tx[i];
+      if( checked[i]->error )
+      {
+         // Do nothing, transaction will not be re-applied
+         wlog( "Transaction was not processed while generating block due to ${e}", ("e", *checked[i]->error) );
+         wlog( "The transaction was ${t}", ("t", tx) );
+         continue;
+      }
+
+      size_t new_total_size = total_block_size + checked[i]->packed_size;
 
       // postpone transaction if it would make block too big
       if( new_total_size >= maximum_block_size )
@@ -402,14 +451,13 @@ signed_block database::_generate_block(
       try
       {
          auto temp_session = _undo_db.start_undo_session();
-         processed_transaction ptx = _apply_transaction( tx );
+         processed_transaction ptx = _apply_transaction( tx, checked[i] );
          temp_session.merge();
 
-         // We have to recompute pack_size(ptx) because it may be different
-         // than pack_size(tx) (i.e. if one or more results increased
-         // their size)
-         total_block_size += fc::raw::pack_size( ptx );
-         pending_block.transactions.push_back( ptx );
+         // The size of ptx may differ from that of tx if one or more results
+         // changed their size, only the results have to be packed again
+         total_block_size += checked[i]->signed_size + fc::raw::pack_size( ptx.operation_results );
+         pending_block.transactions.push_back( std::move( ptx ) );
       }
       catch ( const fc::exception& e )
       {
@@ -446,16 +494,156 @@ signed_block database::_generate_block(
    }
 
    push_block( pending_block, skip );
+   _prevalidated_tx.clear();
 
    return pending_block;
 } FC_CAPTURE_AND_RETHROW( (witness_id) ) }
 
+namespace {
+
+   /// transactions checked by one pool thread, smaller batches are not worth handing to another thread
+   const size_t prevalidated_transactions_per_shard = 16;
+   /// the same without recovering signature keys, which leaves only validate() and the id: blocks of up to
+   /// this many transactions are checked on the thread applying them alone
+   const size_t validated_transactions_per_shard = 128;
+
+}
+
+void database::prevalidate_pending_transactions()
+{
+   collect_prevalidated_transactions( false );
+   if( _background_prevalidation.valid() || _prevalidated_pending_version == _pending_tx_version )
+      return;
+   _prevalidated_pending_version = _pending_tx_version;
+
+   const uint32_t skip = get_node_properties().skip_flags;
+   const bool check_signatures = !( skip & ( skip_transaction_signatures | skip_authority_check ) );
+
+   // the pool threads work on copies, _pending_tx and _prevalidated_tx keep changing meanwhile
+   auto unchecked = std::make_shared< vector<processed_transaction> >();
+   for( const auto& trx : _pending_tx )
+   {
+      const auto earlier = _prevalidated_tx.find( prevalidation_key( trx, trx.id() ) );
+      if( earlier == _prevalidated_tx.end() || ( check_signatures && !earlier->second.has_signature_keys ) )
+         unchecked->push_back( trx );
+   }
+   if( unchecked->empty() )
+      return;
+
+   worker_pool& pool = *_worker_pool;
+   const chain_id_type chain_id = get_chain_id();
+   auto task = std::make_shared< std::packaged_task< vector<prevalidated_transaction>() > >(
+      [&pool, unchecked, chain_id, check_signatures]() {
+         vector<prevalidated_transaction> checked( unchecked->size() );
+         pool.run_shards( unchecked->size(), prevalidated_transactions_per_shard, [&]( size_t first, size_t last ) {
+            for( size_t i = first; i < last; ++i )
+               checked[i] = check_transaction( (*unchecked)[i], prevalidation_key( (*unchecked)[i], (*unchecked)[i].id() ),
+                                               chain_id, check_signatures );
+         });
+         return checked;
+      });
+   _background_prevalidation = task->get_future();
+   pool.post( [task]() { (*task)(); } );
+}
+
+void database::collect_prevalidated_transactions( bool wait )
+{
+   if( !_background_prevalidation.valid() )
+      return;
+   if( !wait && _background_prevalidation.wait_for( std::chrono::seconds(0) ) != std::future_status::ready )
+      return;
+   try
+   {
+      for( auto& result : _background_prevalidation.get() )
+         _prevalidated_tx[ std::make_pair( result.id, result.signatures_digest ) ] = std::move( result );
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Checking pending transactions ahead of block production failed: ${e}", ("e", e.to_detail_string()) );
+   }
+}
+
+vector<const database::prevalidated_transaction*> database::prevalidate_transactions( const vector<processed_transaction>& trxs )
+{
+   collect_prevalidated_transactions( true );
+
+   const uint32_t skip = get_node_properties().skip_flags;
+   vector<prevalidated_transaction> checked = check_transactions( trxs, !( skip & ( skip_transaction_signatures | skip_authority_check ) ) );
+
+   // keep the results of trxs only, which drops those of transactions that left the pending pool
+   std::map< prevalidated_key, prevalidated_transaction > results;
+   vector<const prevalidated_transaction*> in_order;
+   in_order.reserve( trxs.size() );
+   for( auto& result : checked )
+   {
+      const prevalidated_key key( result.id, result.signatures_digest );
+      auto kept = results.find( key );
+      if( kept == results.end() )
+         kept = results.emplace( key, std::move( result ) ).first;
+      in_order.push_back( &kept->second );
+   }
+   _prevalidated_tx = std::move( results );
+   return in_order;
+}
+
+vector<database::prevalidated_transaction> database::check_transactions( const vector<processed_transaction>& trxs,
+                                                                         bool check_signatures )
+{
+   const chain_id_type& chain_id = get_chain_id();
+
+   // the pool threads only read trxs and the results kept so far, each writes its own slots of checked
+   vector<prevalidated_transaction> checked( trxs.size() );
+   const size_t per_shard = check_signatures ? prevalidated_transactions_per_shard : validated_transactions_per_shard;
+   _worker_pool->run_shards( trxs.size(), per_shard, [&]( size_t first, size_t last ) {
+      for( size_t i = first; i < last; ++i )
+      {
+         const prevalidated_key key = prevalidation_key( trxs[i], trxs[i].id() );
+         const auto earlier = _prevalidated_tx.find( key );
+         if( earlier != _prevalidated_tx.end() && ( earlier->second.has_signature_keys || !check_signatures ) )
+            checked[i] = earlier->second;
+         else
+            checked[i] = check_transaction( trxs[i], key, chain_id, check_signatures );
+      }
+   });
+   return checked;
+}
+
+database::prevalidated_key database::prevalidation_key( const signed_transaction& trx, const transaction_id_type& id )
+{
+   return prevalidated_key( id, fc::sha256::hash( trx.signatures ) );
+}
+
+database::prevalidated_transaction database::check_transaction( const processed_transaction& trx, const prevalidated_key& key,
+                                                                const chain_id_type& chain_id, bool check_signatures )
+{
+   prevalidated_transaction result;
+   result.id = key.first;
+   result.signatures_digest = key.second;
+   try
+   {
+      trx.validate();
+      result.packed_size = fc::raw::pack_size( trx );
+      result.signed_size = fc::raw::pack_size( static_cast<const signed_transaction&>( trx ) );
+      if( check_signatures )
+      {
+         result.signature_keys = trx.get_signature_keys( chain_id );
+         result.has_signature_keys = true;
+      }
+   }
+   catch( const fc::exception& e )
+   {
+      result.error = e.dynamic_copy_exception();
+   }
+   return result;
+}
+
 /**
  * Removes the most recent block from the database and
  * undoes any changes it made.
  */
 void database::pop_block()
 { try {
+   detail::chain_state_writer writer( *this );
    _pending_tx_session.reset();
    auto head_id = head_block_id();
    optional<signed_block> head_block = fetch_block_by_id( head_id );
@@ -468,10 +656,102 @@ void database::pop_block()
 
 } FC_CAPTURE_AND_RETHROW() }
 
+void database::set_fork_changes_retention( size_t max_bytes )
+{
+   detail::chain_state_writer writer( *this );
+   _fork_changes_retention = max_bytes;
+   while( _retained_fork_changes_size > _fork_changes_retention )
+      forget_fork_changes( _retained_fork_changes.front().first );
+}
+
+void database::apply_fork_block( const item_ptr& item, uint32_t skip )
+{
+   // the changes were taken on the state the block was applied to first, which popping the fork restored
+   const shared_ptr<block_changes> changes = item->applied_changes;
+   forget_fork_changes( item->id );
+   if( changes && item->data.previous == head_block_id() )
+   {
+      applied_ops_to_virtual_ops();
+      _undo_db.redo( std::move(changes->changes) );
+      _block_id_to_block.store( item->id, item->data );
+
+      // the limits update_global_dynamic_data() sets when the block is applied
+      const dynamic_global_property_object& dgp = get_dynamic_global_properties();
+      _undo_db.set_max_size( dgp.head_block_number - dgp.last_irreversible_block_num + 1 );
+      _fork_db.set_max_size( dgp.head_block_number - dgp.last_irreversible_block_num + 1 );
+
+      // the redone state is what the block left before the signal, the observers apply their part again;
+      // the operations count as applied anew, the next block collects their virtual operations
+      _applied_ops = std::move( changes->applied_ops );
+      _applied_op_seq += _applied_ops.size();
+      _current_block_num = item->num;
+      if( _fork_changes_retention > 0 )
+         capture_block_changes( item );
+      notify_applied_block( item->data ); //emit
+      _applied_ops.clear();
+      if( tracks_state_digest() )
+      {
+         _head_state_digest = state_digest();
+         _head_state_digest_block = item->id;
+      }
+
+      notify_changed_objects();
+      return;
+   }
+
+   undo_database::session session = _undo_db.start_undo_session();
+   apply_block( item->data, skip );
+   _block_id_to_block.store( item->id, item->data );
+   session.commit();
+}
+
+void database::capture_block_changes( const item_ptr& item )
+{
+   forget_fork_changes( item->id );
+   // blocks the fork database dropped took their changes along
+   for( size_t i = 0; i < _retained_fork_changes.size(); )
+   {
+      if( _fork_db.fetch_block( _retained_fork_changes[i].first ) )
+         ++i;
+      else
+         forget_fork_changes( _retained_fork_changes[i].first );
+   }
+
+   auto result = std::make_shared<block_changes>();
+   result->changes = _undo_db.capture_head();
+   result->applied_ops = _applied_ops;
+   result->size = result->changes.size + fc::raw::pack_size( result->applied_ops );
+   if( result->size > _fork_changes_retention )
+      return;
+
+   // every capture counts against the budget, the oldest blocks are the least likely to be switched back to
+   item->applied_changes = result;
+   _retained_fork_changes.emplace_back( item->id, result->size );
+   _retained_fork_changes_size += result->size;
+   while( _retained_fork_changes_size > _fork_changes_retention )
+      forget_fork_changes( _retained_fork_changes.front().first );
+}
+
+void database::forget_fork_changes( const block_id_type& id )
+{
+   auto itr = std::find_if( _retained_fork_changes.begin(), _retained_fork_changes.end(),
+                            [&id]( const std::pair<block_id_type, size_t>& entry ) { return entry.first == id; } );
+   if( itr == _retained_fork_changes.end() )
+      return;
+   // the item is gone when the fork database dropped the block
+   const item_ptr item = _fork_db.fetch_block( id );
+   if( item )
+      item->applied_changes.reset();
+   _retained_fork_changes_size -= itr->second;
+   _retained_fork_changes.erase( itr );
+}
+
 void database::clear_pending()
 { try {
+   detail::chain_state_writer writer( *this );
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
+   ++_pending_tx_version;
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -483,6 +763,7 @@ uint32_t database::push_applied_operation( const operation& op )
    oh.trx_in_block = _current_trx_in_block;
    oh.op_in_trx    = _current_op_in_trx;
    oh.virtual_op   = _current_virtual_op++;
+   ++_applied_op_seq;
    return _applied_ops.size() - 1;
 }
 void database::set_applied_operation_result( uint32_t op_id, const operation_result& result )
@@ -525,32 +806,39 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
 
 void database::applied_ops_to_virtual_ops( )
 {
-   for(auto& ooho : _applied_ops)
+   // sequence number of _applied_ops[0], everything at or below the watermark was captured before
+   uint64_t seq = _applied_op_seq - _applied_ops.size() + 1;
+   for( const auto& ooho : _applied_ops )
    {
-      if(ooho.valid())
+      if( ooho.valid() && seq > _last_captured_virtual_op_seq
+          && operation_type_limits::is_virtual_operation(ooho->op) )
       {
-         operation_history_object& oho = *ooho;
-         if( operation_type_limits::is_virtual_operation(oho.op) )
+         if( _virtual_ops.full() )
          {
-            vector<optional< operation_history_object > >::iterator it = std::find_if(_virtual_ops.begin(),_virtual_ops.end(),
-                  [&oho](optional<operation_history_object > const& e){
-                     return e->virtual_op == oho.virtual_op;
-            });
-
-            if(it == _virtual_ops.end())
-            {
-               _virtual_ops.push_back(ooho);
-            }
+            // nothing drained the buffer, the oldest entry is overwritten and its consumers miss it
+            if( _virtual_ops_dropped_since_drain++ == 0 )
+               wlog( "More than ${n} virtual operations collected without being drained, dropping the oldest ones",
+                     ("n", _virtual_ops.capacity()) );
+            ++_dropped_virtual_ops;
          }
+         _virtual_ops.push_back(ooho);
       }
+      ++seq;
    }
+   _last_captured_virtual_op_seq = _applied_op_seq;
 }
 
 vector<optional< operation_history_object > > database::get_virtual_ops_and_clear_collection( )
 {
-   vector<optional< operation_history_object > > ret;
-   std::swap(ret, _virtual_ops);
-   return std::move(ret);
+   vector<optional< operation_history_object > > ret( std::make_move_iterator(_virtual_ops.begin()),
+                                                      std::make_move_iterator(_virtual_ops.end()) );
+   _virtual_ops.clear();
+   if( _virtual_ops_dropped_since_drain > 0 )
+   {
+      wlog( "${n} virtual operations were dropped before this drain", ("n", _virtual_ops_dropped_since_drain) );
+      _virtual_ops_dropped_since_drain = 0;
+   }
+   return ret;
 }
 
 void database::_apply_block( const signed_block& next_block )
@@ -569,61 +857,128 @@ void database::_apply_block( const signed_block& next_block )
 
    _current_block_num    = next_block_num;
    _current_trx_in_block = 0;
+   _apply_profiler.begin_block( next_block_num );
+   typedef apply_profiler::scoped_phase scoped_phase;
 
-   for( const auto& trx : next_block.transactions )
    {
-      /* We do not need to push the undo state for each transaction
-       * because they either all apply and are valid or the
-       * entire block fails to apply.  We only need an "undo" state
-       * for transactions when validating broadcast transactions or
-       * when building a block.
-       */
-      apply_transaction( trx, skip | skip_transaction_signatures );
-      ++_current_trx_in_block;
+      scoped_phase timer( _apply_profiler, apply_phase::transactions );
+      // validate() and the ids of the transactions of larger blocks on the worker pool, reusing what
+      // generate_block() checked.  The evaluators stay serial: object ids follow creation order, most
+      // operations modify the dynamic global and asset dynamic data objects, and all changes share one undo
+      // session, so no order but the block's reproduces its state.
+      const auto checked = check_transactions( next_block.transactions, false );
+      detail::with_skip_flags( *this, skip | skip_transaction_signatures, [&]()
+      {
+         for( const auto& trx : next_block.transactions )
+         {
+            /* We do not need to push the undo state for each transaction
+             * because they either all apply and are valid or the
+             * entire block fails to apply.  We only need an "undo" state
+             * for transactions when validating broadcast transactions or
+             * when building a block.
+             */
+            _apply_transaction( trx, &checked[_current_trx_in_block] );
+            ++_current_trx_in_block;
+         }
+      });
    }
 
-   update_global_dynamic_data(next_block);
-   update_signing_witness(signing_witness, next_block);
-   update_last_irreversible_block();
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::global_dynamic_data );
+      update_global_dynamic_data(next_block);
+      update_signing_witness(signing_witness, next_block);
+      update_last_irreversible_block();
+   }
 
    // Are we at the maintenance interval?
    if( maint_needed )
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::chain_maintenance );
       perform_chain_maintenance(next_block, global_props);
+   }
 
-   create_block_summary(next_block);
-   clear_expired_transactions();
-   clear_expired_proposals();
-   clear_expired_orders();
-   update_expired_feeds();
-   update_withdraw_permissions();
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::block_summary );
+      create_block_summary(next_block);
+   }
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::clear_expired );
+      clear_expired_transactions();
+      clear_expired_proposals();
+      clear_expired_orders();
+   }
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::update_feeds_and_withdrawals );
+      update_expired_feeds();
+      update_withdraw_permissions();
+   }
 
-   // n.b., update_maintenance_flag() happens this late
-   // because get_slot_time() / get_slot_at_time() is needed above
-   // TODO:  figure out if we could collapse this function into
-   // update_global_dynamic_data() as perhaps these methods only need
-   // to be called for header validation?
-   update_maintenance_flag( maint_needed );
-   update_witnesses();
-   update_witness_schedule();
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::witness_schedule );
+      // n.b., update_maintenance_flag() happens this late
+      // because get_slot_time() / get_slot_at_time() is needed above
+      // TODO:  figure out if we could collapse this function into
+      // update_global_dynamic_data() as perhaps these methods only need
+      // to be called for header validation?
+      update_maintenance_flag( maint_needed );
+      update_witnesses();
+      update_witness_schedule();
+   }
 
-   reset_spending_limits();
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::reset_spending_limits );
+      reset_spending_limits();
+   }
 
    if ( global_props.parameters.enable_dascoin_queue )
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::mint_dascoin_rewards );
       mint_dascoin_rewards();
+   }
 
    if ( global_props.daspay_parameters.clearing_enabled )
-     daspay_clearing_start();
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::daspay_clearing );
+      daspay_clearing_start();
+   }
 
    if ( global_props.delayed_operations_resolver_enabled )
-     resolve_delayed_operations();
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::resolve_delayed_operations );
+      resolve_delayed_operations();
+   }
 
    if( !_node_property_object.debug_updates.empty() )
       apply_debug_updates();
 
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::store_virtual_operations );
+      store_virtual_operations( next_block_num );
+   }
+
+   if( _fork_changes_retention > 0 && _undo_db.enabled() )
+   {
+      // taken before the observers change the state, a redo of the block emits the signal again
+      const item_ptr item = _fork_db.fetch_block( next_block.id() );
+      if( item )
+         capture_block_changes( item );
+   }
+
    // notify observers that the block has been applied
-   notify_applied_block( next_block ); //emit
+   {
+      scoped_phase timer( _apply_profiler, apply_phase::notify_applied_block );
+      notify_applied_block( next_block ); //emit
+   }
    _applied_ops.clear();
 
+   // the head state before pending transactions are applied on top of it again
+   if( tracks_state_digest() )
+   {
+      _head_state_digest = state_digest();
+      _head_state_digest_block = next_block.id();
+   }
+
+   scoped_phase timer( _apply_profiler, apply_phase::notify_changed_objects );
    notify_changed_objects();
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  }
 
@@ -637,16 +992,19 @@ processed_transaction database::apply_transaction(const signed_transaction& trx,
    return result;
 }
 
-processed_transaction database::_apply_transaction(const signed_transaction& trx)
+processed_transaction database::_apply_transaction(const signed_transaction& trx, const prevalidated_transaction* checked)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
 
-   if( true || !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
+   // a transaction checked by check_transactions() has passed validate()
+   if( checked == nullptr )   /* issue #505 explains why the skip_validate flag is disabled */
       trx.validate();
+   else if( checked->error )
+      checked->error->dynamic_rethrow_exception();
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = get_chain_id();
-   auto trx_id = trx.id();
+   auto trx_id = checked ? checked->id : trx.id();
    FC_ASSERT( (skip & skip_transaction_dupe_check) ||
               trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
    transaction_evaluation_state eval_state(this);
@@ -657,7 +1015,11 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    {
       auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
       auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
-      trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
+      if( checked && checked->has_signature_keys )
+         graphene::chain::verify_authority( trx.operations, checked->signature_keys, get_active, get_owner,
+                                            get_global_properties().parameters.max_authority_depth );
+      else
+         trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -716,11 +1078,14 @@ operation_result database::apply_operation(transaction_evaluation_state& eval_st
       assert( "Negative operation tag" && false );
    if( u_which >= _operation_evaluators.size() )
       assert( "No registered evaluator for this operation" && false );
-   unique_ptr<op_evaluator>& eval = _operation_evaluators[ u_which ];
+   const operation_evaluator eval = _operation_evaluators[ u_which ];
    if( !eval )
       assert( "No registered evaluator for this operation" && false );
    auto op_id = push_applied_operation( op );
-   auto result = eval->evaluate( eval_state, op, true );
+   const uint64_t start = _apply_profiler.enabled() ? apply_profiler::now_ticks() : 0;
+   auto result = eval( eval_state, op, true );
+   if( start )
+      _apply_profiler.record_operation( i_which, apply_profiler::now_ticks() - start );
    set_applied_operation_result( op_id, result );
    return result;
 } FC_CAPTURE_AND_RETHROW(  ) }
@@ -756,6 +1121,42 @@ void database::create_block_summary(const signed_block& next_block)
    });
 }
 
+void database::store_virtual_operations(uint32_t block_num)
+{
+   // opt-in: the objects live in the chain state and in every undo state
+   if( _virtual_op_retention == 0 )
+      return;
+
+   for( uint32_t i = 0; i < _applied_ops.size(); ++i )
+   {
+      const auto& oho = _applied_ops[i];
+      if( !oho.valid() || !operation_type_limits::is_virtual_operation( oho->op ) )
+         continue;
+      create<virtual_op_object>( [&]( virtual_op_object& vop ) {
+         vop.block_num    = block_num;
+         vop.op_type      = oho->op.which();
+         vop.op_in_block  = i;
+         vop.trx_in_block = oho->trx_in_block;
+         vop.op_in_trx    = oho->op_in_trx;
+         vop.op           = oho->op;
+      });
+   }
+
+   if( block_num <= _virtual_op_retention )
+      return;
+
+   // ordered by block number first, everything up to the cutoff sits at the front
+   const auto& vop_idx = get_index_type<virtual_op_index>().indices().get<by_block_type>();
+   const uint32_t cutoff = block_num - _virtual_op_retention;
+   auto itr = vop_idx.begin();
+   while( itr != vop_idx.end() && itr->block_num <= cutoff )
+   {
+      const auto& vop = *itr;
+      ++itr;
+      remove( vop );
+   }
+}
+
 void database::add_checkpoints( const flat_map<uint32_t,block_id_type>& checkpts )
 {
    for( const auto& i : checkpts )
@@ -51,6 +51,7 @@
 #include <graphene/chain/wire_out_with_fee_object.hpp>
 #include <graphene/chain/withdraw_permission_object.hpp>
 #include <graphene/chain/withdrawal_limit_object.hpp>
+#include <graphene/chain/virtual_op_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 #include <graphene/chain/witness_schedule_object.hpp>
 #include <graphene/chain/worker_object.hpp>
@@ -182,6 +183,9 @@ const uint8_t upgrade_event_object::type_id;
 const uint8_t withdrawal_limit_object::space_id;
 const uint8_t withdrawal_limit_object::type_id;
 
+const uint8_t virtual_op_object::space_id;
+const uint8_t virtual_op_object::type_id;
+
 void database::initialize_genesis_transaction_state()
 {
   // Since this is the database initialization, skip checking signatures:
@@ -191,7 +195,7 @@ void database::initialize_genesis_transaction_state()
 
 void database::initialize_evaluators()
 {
-   _operation_evaluators.resize(255);
+   _operation_evaluators.resize( operation::count() );
    register_evaluator<account_create_evaluator>();
    register_evaluator<account_update_evaluator>();
    register_evaluator<account_upgrade_evaluator>();
@@ -369,6 +373,7 @@ void database::initialize_indexes()
    add_index<primary_index<das33_pledge_holder_index>>();
    add_index<primary_index<delayed_operations_index>>();
    add_index<primary_index<withdrawal_limit_index>>();
+   add_index<primary_index<virtual_op_index>>();
 }
 
 account_id_type database::initialize_chain_authority(const string& kind_name, const string& acc_name)
@@ -738,7 +743,9 @@ void database::init_genesis(const genesis_state_type& genesis_state)
    } );
    create<block_summary_object>([&](block_summary_object&) {});
 
-   // Create initial accounts
+   // Create initial accounts.  Large genesis states have millions of them, so instead of evaluating an operation
+   // for each, they get the checks of account_create_evaluator that depend on chain state and are created as
+   // do_apply() creates special accounts.  The operations still go to the applied operations for the history.
    for( const auto& account : genesis_state.initial_accounts )
    {
       account_create_operation cop;
@@ -756,7 +763,11 @@ void database::init_genesis(const genesis_state_type& genesis_state)
          cop.active = authority(1, account.active_key, 1);
          cop.options.memo_key = account.active_key;
       }
-      account_id_type account_id(apply_operation(_genesis_eval_state, cop).get<object_id_type>());
+      verify_account_create( *this, cop );
+
+      const auto op_id = push_applied_operation( cop );
+      const account_id_type account_id = create_account_objects( *this, cop, cop.referrer_percent ).id;
+      set_applied_operation_result( op_id, object_id_type( account_id ) );
 
       if( account.is_lifetime_member )
       {
@@ -766,6 +777,9 @@ void database::init_genesis(const genesis_state_type& genesis_state)
           apply_operation(_genesis_eval_state, op);
       }
    }
+   modify( get_dynamic_global_properties(), [&]( dynamic_global_property_object& p ) {
+      p.accounts_registered_this_interval += genesis_state.initial_accounts.size();
+   });
 
    map<asset_id_type, share_type> total_supplies;
    map<asset_id_type, share_type> total_debts;
@@ -836,11 +850,20 @@ void database::init_genesis(const genesis_state_type& genesis_state)
       });
    }
 
+   // the handouts name their asset by symbol, most of them the same few
+   map<string, asset_id_type> asset_ids_by_symbol;
+   const auto handout_asset_id = [&]( const string& symbol ) {
+      auto itr = asset_ids_by_symbol.find( symbol );
+      if( itr == asset_ids_by_symbol.end() )
+         itr = asset_ids_by_symbol.emplace( symbol, get_asset_id( symbol ) ).first;
+      return itr->second;
+   };
+
    // Create initial balances
    share_type total_allocation;
    for( const auto& handout : genesis_state.initial_balances )
    {
-      const auto asset_id = get_asset_id(handout.asset_symbol);
+      const auto asset_id = handout_asset_id(handout.asset_symbol);
       create<balance_object>([&handout,total_allocation,asset_id](balance_object& b) {
          b.balance = asset(handout.amount, asset_id);
          b.owner = handout.owner;
@@ -852,7 +875,7 @@ void database::init_genesis(const genesis_state_type& genesis_state)
    // Create initial vesting balances
    for( const genesis_state_type::initial_vesting_balance_type& vest : genesis_state.initial_vesting_balances )
    {
-      const auto asset_id = get_asset_id(vest.asset_symbol);
+      const auto asset_id = handout_asset_id(vest.asset_symbol);
       create<balance_object>([&](balance_object& b) {
          b.owner = vest.owner;
          b.balance = asset(vest.amount, asset_id);
@@ -23,11 +23,13 @@
  */
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/db_with.hpp>
 
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
 #include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
 
 #include <fstream>
 #include <functional>
@@ -37,6 +39,7 @@ namespace graphene { namespace chain {
 
 database::database()
 {
+   set_state_digest_filter( &database::state_digest_covers );
    initialize_indexes();
    initialize_evaluators();
    initialize_genesis_transaction_state();
@@ -44,9 +47,38 @@ database::database()
 
 database::~database()
 {
+   // checks started ahead of block production run on the worker pool, which goes away with the database
+   if( _background_prevalidation.valid() )
+      _background_prevalidation.wait();
    clear_pending();
 }
 
+void database::set_worker_threads( size_t thread_count )
+{
+   detail::chain_state_writer writer( *this );
+   if( _background_prevalidation.valid() )
+      _background_prevalidation.wait();
+   _worker_pool.reset( new worker_pool( thread_count ) );
+}
+
+bool database::state_digest_covers( uint8_t space_id, uint8_t type_id )
+{
+   if( space_id == protocol_ids )
+      return type_id != operation_history_object_type;
+   if( space_id == implementation_ids )
+      return type_id != impl_account_transaction_history_object_type && type_id != impl_virtual_op_object_type;
+   return false;
+}
+
+fc::sha256 database::head_state_digest()const
+{
+   FC_ASSERT( tracks_state_digest(), "the state digest is not tracked, start the node with track-state-digest" );
+   if( _head_state_digest_block == head_block_id() )
+      return _head_state_digest;
+   FC_ASSERT( !_pending_tx_session.valid(), "the digest of the head state is available from the next block on" );
+   return state_digest();
+}
+
 void database::reindex(fc::path data_dir)
 { try {
    auto last_block = _block_id_to_block.last();
@@ -71,6 +103,17 @@ void database::reindex(fc::path data_dir)
    }
    else
       _undo_db.disable();
+
+   std::ofstream profile_dump;
+   const bool was_profiling = _apply_profiler.enabled();
+   if( !_apply_profile_replay_dump.empty() )
+   {
+      profile_dump.open( _apply_profile_replay_dump.generic_string(), std::ios::app );
+      FC_ASSERT( profile_dump, "Cannot open ${f} for the replay profile", ("f", _apply_profile_replay_dump) );
+      _apply_profiler.keep_block_profiles( true );
+      _apply_profiler.enable( true );
+   }
+
    for( uint32_t i = head_block_num() + 1; i <= last_block_num; ++i )
    {
       if( i % 10000 == 0 ) std::cerr << "   " << double(i*100)/last_block_num << "%   "<<i << " of " <<last_block_num<<"   \n";
@@ -120,6 +163,13 @@ void database::reindex(fc::path data_dir)
                             skip_witness_schedule_check |
                             skip_authority_check);
       }
+      if( profile_dump.is_open() )
+         profile_dump << fc::json::to_string( _apply_profiler.take_block_profile() ) << '\n';
+   }
+   if( profile_dump.is_open() )
+   {
+      _apply_profiler.keep_block_profiles( false );
+      _apply_profiler.enable( was_profiling );
    }
    _undo_db.enable();
    auto end = fc::time_point::now();
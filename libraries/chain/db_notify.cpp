@@ -742,7 +742,9 @@ void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accoun
                 assert( aobj != nullptr );
                 accounts.insert( aobj->account );
                 break;
-             } case impl_block_summary_object_type:
+             } case impl_virtual_op_object_type:
+               break;
+             case impl_block_summary_object_type:
                break;
             case impl_account_transaction_history_object_type:
                break;
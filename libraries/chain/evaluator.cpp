@@ -50,17 +50,21 @@ database& generic_evaluator::db()const { return trx_state->db(); }
       return result;
    } FC_CAPTURE_AND_RETHROW() }
 
-   void generic_evaluator::prepare_fee(account_id_type account_id, asset fee, operation op)
+   void generic_evaluator::prepare_fee(account_id_type account_id, asset fee, const operation& op)
    {
       const database& d = db();
       const auto& gbo = d.get_global_properties();
-      const auto current_fee_asset = gbo.parameters.current_fees->fee_asset_id(d);
 
       FC_ASSERT( fee.amount >= 0 );
       fee_paying_account = &account_id(d);
 
-      fee_asset = &fee.asset_id(d);
-      fee_asset_dyn_data = &fee_asset->dynamic_asset_data_id(d);
+      if( trx_state->fee_asset == nullptr || trx_state->fee_asset->id != fee.asset_id )
+      {
+         trx_state->fee_asset = &fee.asset_id(d);
+         trx_state->fee_asset_dyn_data = &trx_state->fee_asset->dynamic_asset_data_id(d);
+      }
+      fee_asset = trx_state->fee_asset;
+      fee_asset_dyn_data = trx_state->fee_asset_dyn_data;
 
       fee_paid = calculate_fee_for_operation(op);
 
@@ -69,7 +73,7 @@ database& generic_evaluator::db()const { return trx_state->db(); }
           FC_ASSERT( fee.amount == fee_paid, "Attempted to pay wrong amount of fee. Expected ${expected} payed ${payed}.",
                      ("expected", fee_paid)("payed", fee.amount) );
           FC_ASSERT( fee.asset_id == gbo.parameters.current_fees->fee_asset_id, "Attempted to pay fee by using asset ${a} '${sym}', which is unauthorized. Fee must be payed in ${f}.",
-                     ("a", fee.asset_id)("sym", fee_asset->symbol)("f", current_fee_asset.symbol) );
+                     ("a", fee.asset_id)("sym", fee_asset->symbol)("f", gbo.parameters.current_fees->fee_asset_id(d).symbol) );
       }
 
       // if asset is core just leave this part
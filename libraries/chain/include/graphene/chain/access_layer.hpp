@@ -280,6 +280,24 @@ struct acc_id_vault_info_res : public acc_id_res {
     result_t result;
 };
 
+struct vault_dashboard_res {
+    vault_info_res info;
+    // Free cycle balance first, then the queue entries, as in get_all_cycle_balances:
+    vector<cycle_agreement> cycle_balances;
+    vector<sub_w_pos> queue_submissions;
+};
+
+struct acc_id_vault_dashboard_res : public acc_id_res {
+
+    using result_t = optional<vault_dashboard_res>;
+
+    acc_id_vault_dashboard_res() = default;
+    explicit acc_id_vault_dashboard_res(account_id_type account_id, result_t result = {})
+        : acc_id_res(account_id), result(result) {}
+
+    result_t result;
+};
+
 struct license_types_grouped_by_kind_res {
     struct license_name_and_id {
         string name;
@@ -361,6 +379,7 @@ class database_access_layer {
     vector<signed_block_with_virtual_operations_and_num> get_blocks_with_virtual_operations(uint32_t start_block_num,
                                                                                             uint32_t count,
                                                                                             std::vector<uint16_t>& virtual_operation_ids) const;
+    vector<raw_block> get_raw_blocks(uint32_t start_block_num, uint32_t count) const;
     // Global objects:
     global_property_object get_global_properties() const;
 
@@ -396,6 +415,7 @@ class database_access_layer {
     // Vaults:
     optional<vault_info_res> get_vault_info(account_id_type vault_id) const;
     vector<acc_id_vault_info_res> get_vaults_info(vector<account_id_type> vault_ids) const;
+    vector<acc_id_vault_dashboard_res> get_vault_dashboards(const vector<account_id_type>& vault_ids) const;
 
     // Assets:
     optional<asset_object> lookup_asset_symbol(const string& symbol_or_id) const;
@@ -502,6 +522,13 @@ FC_REFLECT(graphene::chain::vault_info_res,
 
 FC_REFLECT_DERIVED(graphene::chain::acc_id_vault_info_res, (graphene::chain::acc_id_res), (result))
 
+FC_REFLECT(graphene::chain::vault_dashboard_res,
+           (info)
+           (cycle_balances)
+           (queue_submissions))
+
+FC_REFLECT_DERIVED(graphene::chain::acc_id_vault_dashboard_res, (graphene::chain::acc_id_res), (result))
+
 FC_REFLECT(graphene::chain::license_types_grouped_by_kind_res::license_name_and_id,
            (name)
            (id))
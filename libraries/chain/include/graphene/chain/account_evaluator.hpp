@@ -27,6 +27,16 @@
 
 namespace graphene { namespace chain {
 
+/// the checks of account_create_evaluator that depend on chain state, except the one of the registrar chain authority
+void verify_account_create( const database& d, const account_create_operation& op );
+
+/**
+ * Creates the account of op with its statistics and its empty cycle, dascoin, web asset and cycle asset balances.
+ * account_create_evaluator::do_apply() and init_genesis() both create accounts through it; the rest of do_apply()
+ * (registration count, special authority, buyback, limits and starting balances by kind) is up to the caller.
+ */
+const account_object& create_account_objects( database& d, const account_create_operation& op, uint16_t referrer_percent );
+
 class account_create_evaluator : public evaluator<account_create_evaluator>
 {
 public:
@@ -569,6 +569,23 @@ namespace graphene { namespace chain {
 
 } }  // namsepace graphene::chain
 
+namespace graphene { namespace db {
+
+   /// most_recent_op and total_ops belong to the history plugins, nodes with other plugins or retention differ on them
+   template<>
+   struct state_digest_projection<graphene::chain::account_statistics_object>
+   {
+      static graphene::chain::account_statistics_object project( const graphene::chain::account_statistics_object& o )
+      {
+         graphene::chain::account_statistics_object result = o;
+         result.most_recent_op = graphene::chain::account_transaction_history_id_type();
+         result.total_ops = 0;
+         return result;
+      }
+   };
+
+} }  // namespace graphene::db
+
 FC_REFLECT_DERIVED( graphene::chain::account_object, (graphene::db::object),
                     (kind)
                     (hierarchy_depth)
@@ -0,0 +1,199 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <graphene/chain/protocol/types.hpp>
+#include <fc/time.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+namespace graphene { namespace chain {
+
+   /// the stages of database::_apply_block timed by the apply_profiler
+   enum class apply_phase : uint8_t
+   {
+      transactions,
+      global_dynamic_data,
+      chain_maintenance,
+      block_summary,
+      clear_expired,
+      update_feeds_and_withdrawals,
+      witness_schedule,
+      reset_spending_limits,
+      mint_dascoin_rewards,
+      daspay_clearing,
+      resolve_delayed_operations,
+      store_virtual_operations,
+      notify_applied_block,
+      notify_changed_objects,
+      APPLY_PHASE_COUNT
+   };
+
+   /// samples of one phase or operation type
+   struct apply_profile_entry
+   {
+      string             name;
+      uint64_t           count = 0;
+      uint64_t           total_ticks = 0;
+      uint64_t           max_ticks = 0;
+      /// histogram[i] is the number of samples of [2^i, 2^(i+1)) ticks
+      vector<uint64_t>   histogram;
+   };
+
+   struct apply_profile
+   {
+      bool                         enabled = false;
+      /// "tsc" for the CPU timestamp counter, "ns" where it is not available
+      string                       tick_unit;
+      /// blocks applied while profiling, 0 when none
+      uint32_t                     first_block = 0;
+      uint32_t                     last_block = 0;
+      /// ticks and wall clock time since the last reset, their ratio converts ticks to time
+      uint64_t                     elapsed_ticks = 0;
+      int64_t                      elapsed_us = 0;
+      vector<apply_profile_entry>  phases;
+      vector<apply_profile_entry>  operations;
+   };
+
+   /**
+    * Times the evaluators and the block phases of the apply path.
+    *
+    * Samples are read from the CPU timestamp counter and aggregated per phase and operation type into a
+    * count, a sum, a maximum and a log2 histogram.  When profiling is off the cost is one relaxed atomic
+    * load per sample.  Besides the totals the profiler can keep the samples of the last block on their
+    * own, which the replay uses to dump a profile per block.
+    */
+   class apply_profiler
+   {
+      public:
+         apply_profiler();
+
+         static uint64_t now_ticks()
+         {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+         }
+
+         bool enabled()const { return _enabled.load( std::memory_order_relaxed ); }
+         void enable( bool on );
+         /// drops the samples collected so far
+         void reset();
+
+         void keep_block_profiles( bool on );
+         void begin_block( uint32_t block_num );
+         /// the samples of the block started last, which are dropped afterwards
+         apply_profile take_block_profile();
+
+         apply_profile get_profile()const;
+
+         void record_phase( apply_phase phase, uint64_t ticks );
+         void record_operation( int which, uint64_t ticks );
+
+         /// times the enclosing scope as one sample of a phase
+         class scoped_phase
+         {
+            public:
+               scoped_phase( apply_profiler& profiler, apply_phase phase )
+                  : _profiler( profiler ), _phase( phase ), _start( profiler.enabled() ? now_ticks() : 0 ) {}
+               ~scoped_phase()
+               {
+                  if( _start )
+                     _profiler.record_phase( _phase, now_ticks() - _start );
+               }
+            private:
+               apply_profiler&   _profiler;
+               apply_phase       _phase;
+               uint64_t          _start;
+         };
+
+      private:
+         static const size_t histogram_buckets = 48;
+
+         struct tick_stats
+         {
+            uint64_t                                count = 0;
+            uint64_t                                total = 0;
+            uint64_t                                max = 0;
+            std::array<uint64_t, histogram_buckets> histogram{};
+
+            void add( uint64_t ticks );
+         };
+
+         /// phases first, then one slot per operation type
+         struct profile_data
+         {
+            vector<tick_stats>   slots;
+            uint32_t             first_block = 0;
+            uint32_t             last_block = 0;
+         };
+
+         void record( size_t slot, uint64_t ticks );
+         apply_profile to_profile( const profile_data& data )const;
+
+         std::atomic<bool>    _enabled{ false };
+         bool                 _keep_block_profiles = false;
+
+         mutable std::mutex   _mutex;
+         profile_data         _totals;
+         profile_data         _block;
+         uint64_t             _reset_ticks = 0;
+         fc::time_point       _reset_time;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT_ENUM( graphene::chain::apply_phase,
+                 (transactions)
+                 (global_dynamic_data)
+                 (chain_maintenance)
+                 (block_summary)
+                 (clear_expired)
+                 (update_feeds_and_withdrawals)
+                 (witness_schedule)
+                 (reset_spending_limits)
+                 (mint_dascoin_rewards)
+                 (daspay_clearing)
+                 (resolve_delayed_operations)
+                 (store_virtual_operations)
+                 (notify_applied_block)
+                 (notify_changed_objects)
+                 (APPLY_PHASE_COUNT)
+               )
+
+FC_REFLECT( graphene::chain::apply_profile_entry, (name)(count)(total_ticks)(max_ticks)(histogram) )
+FC_REFLECT( graphene::chain::apply_profile,
+            (enabled)(tick_unit)(first_block)(last_block)(elapsed_ticks)(elapsed_us)(phases)(operations) )
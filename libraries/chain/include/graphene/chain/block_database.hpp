@@ -23,11 +23,20 @@
  */
 #pragma once
 #include <fstream>
+#include <mutex>
 #include <graphene/chain/protocol/block.hpp>
 
 namespace graphene { namespace chain {
    struct index_entry;
 
+   /** A block as stored in the block log: packed, with the id recorded when it was stored */
+   struct raw_block
+   {
+      uint32_t      block_num = 0;
+      block_id_type block_id;
+      vector<char>  data;
+   };
+
    class block_database
    {
       public:
@@ -45,10 +54,21 @@ namespace graphene { namespace chain {
          optional<signed_block> fetch_by_number( uint32_t block_num )const;
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
+
+         /**
+          * Reads up to count consecutive blocks starting at first_block_num without unpacking them, stopping early
+          * at a block that is not stored or once max_bytes are collected (the first block is always returned).
+          */
+         vector<raw_block>      fetch_raw_range( uint32_t first_block_num, uint32_t count, size_t max_bytes )const;
       private:
          optional<index_entry> last_index_entry()const;
          fc::path _index_filename;
+         fc::path _blocks_filename;
+         /// the streams are shared by every reader, API calls may run on several threads
+         mutable std::mutex   _mutex;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
    };
 } }
+
+FC_REFLECT( graphene::chain::raw_block, (block_num)(block_id)(data) )
@@ -144,7 +144,10 @@
 #define GRAPHENE_RECENTLY_MISSED_COUNT_INCREMENT             4
 #define GRAPHENE_RECENTLY_MISSED_COUNT_DECREMENT             3
 
-#define GRAPHENE_CURRENT_DB_VERSION                          "GPH2.5"
+#define GRAPHENE_CURRENT_DB_VERSION                          "GPH2.7"
+
+/// virtual operations kept for the history plugins between two drains, older ones are dropped
+#define GRAPHENE_MAX_BUFFERED_VIRTUAL_OPS                    (1 << 16)
 
 #define GRAPHENE_IRREVERSIBLE_THRESHOLD                      (70 * GRAPHENE_1_PERCENT)
 
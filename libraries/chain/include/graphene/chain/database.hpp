@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #pragma once
+#include <graphene/chain/apply_profiler.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/node_property_object.hpp>
 #include <graphene/chain/account_object.hpp>
@@ -31,6 +32,7 @@
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
 #include <graphene/chain/license_objects.hpp>
+#include <graphene/chain/worker_pool.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
@@ -42,16 +44,21 @@
 
 #include <fc/log/logger.hpp>
 
+#include <boost/circular_buffer.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <future>
 #include <map>
 
 namespace graphene { namespace chain {
    using graphene::db::abstract_object;
    using graphene::db::object;
-   class op_evaluator;
    class transaction_evaluation_state;
 
    struct budget_record;
 
+   namespace detail { struct chain_state_writer; }
+
    /**
     *   @class database
     *   @brief tracks the blockchain state in an extensible manner
@@ -127,6 +134,8 @@ namespace graphene { namespace chain {
          optional<signed_block>                          fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>                          fetch_block_by_number( uint32_t num )const;
          optional<signed_block_with_virtual_operations>  fetch_block_with_virtual_operations_by_number( uint32_t num, std::vector<uint16_t> virtual_op_id_vec)const;
+         /// packed blocks of the current chain up to the head, straight from the block log
+         vector<raw_block>                               fetch_raw_blocks_by_number( uint32_t first_num, uint32_t count, size_t max_bytes )const;
          const signed_transaction&                       get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type>                      get_block_ids_on_fork(block_id_type head_of_fork) const;
 
@@ -140,6 +149,50 @@ namespace graphene { namespace chain {
          const flat_map<uint32_t,block_id_type> get_checkpoints()const { return _checkpoints; }
          bool before_last_checkpoint()const;
 
+         /**
+          *  Number of most recent blocks whose virtual operations are kept in the virtual_op_index,
+          *  0 (the default) does not fill the index.
+          */
+         void                              set_virtual_op_retention( uint32_t blocks ) { _virtual_op_retention = blocks; }
+         uint32_t                          get_virtual_op_retention()const { return _virtual_op_retention; }
+
+         /// timing of the evaluators and of the phases of applying a block
+         apply_profiler&                   get_apply_profiler() { return _apply_profiler; }
+         const apply_profiler&             get_apply_profiler()const { return _apply_profiler; }
+         /**
+          *  File that receives the profile of every block replayed by reindex() as a line of JSON,
+          *  profiling is on during the replay when it is set.
+          */
+         void                              set_apply_profile_replay_dump( const fc::path& file ) { _apply_profile_replay_dump = file; }
+
+         /**
+          *  The indexes state_digest() covers: the protocol and implementation spaces, except the operation
+          *  history filled by the history plugins and the virtual operations kept for virtual-op-retention-blocks,
+          *  which depend on the plugins and options of a node rather than on the chain.  The history fields of
+          *  account statistics are left out of their digest for the same reason.
+          */
+         static bool                       state_digest_covers( uint8_t space_id, uint8_t type_id );
+         /**
+          *  state_digest() of the head block's state, without the pending transactions applied on top of it.
+          *  Needs state digest tracking; taken when a block is applied, or read from the state while nothing is
+          *  pending.
+          */
+         fc::sha256                        head_state_digest()const;
+
+         /// threads that work split into shards runs on, shared by the database and the APIs reading it
+         worker_pool&                      get_worker_pool() { return *_worker_pool; }
+         /// replaces the worker pool by one with thread_count threads, 0 for one per hardware thread, 1 checks serially
+         void                              set_worker_threads( size_t thread_count );
+
+         /**
+          *  Applied blocks keep a copy of their changes in the fork database, up to max_bytes for all of them,
+          *  the oldest ones are dropped first; 0 turns this off.  Switching back to a popped block that still has
+          *  them redoes its changes instead of applying it again, then emits applied_block with the operations it
+          *  applied first.  The copy is taken on every block applied while this is on.
+          */
+         void                              set_fork_changes_retention( size_t max_bytes );
+         size_t                            get_retained_fork_changes_size()const { return _retained_fork_changes_size; }
+
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
          processed_transaction push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          bool _push_block( const signed_block& b );
@@ -160,9 +213,26 @@ namespace graphene { namespace chain {
             const fc::ecc::private_key& block_signing_private_key
             );
 
+         /**
+          *  Starts the checks of the pending transactions that do not depend on chain state (validate(), packed
+          *  size, signature key recovery) on the worker pool and returns without waiting for them.  The results
+          *  are kept for the next generate_block(), which only has to apply the transactions then.  Only
+          *  transactions without results are checked, and nothing is started while an earlier run is busy or
+          *  when the pending transactions did not change since the last call.  A witness calls this ahead of
+          *  its slot; generate_block() checks whatever was not checked before.
+          */
+         void prevalidate_pending_transactions();
+
          void pop_block();
          void clear_pending();
 
+         /**
+          *  Threads other than the one applying blocks hold this shared while they read the chain
+          *  state.  push_block, push_transaction, generate_block, pop_block and clear_pending hold
+          *  it exclusively, so those readers only ever see the state between two changes.
+          */
+         boost::shared_mutex& chain_state_mutex()const { return _chain_state_mutex; }
+
          /**
           *  This method is used to track appied operations during the evaluation of a block, these
           *  operations should include any operation actually included in a transaction as well
@@ -177,6 +247,8 @@ namespace graphene { namespace chain {
          void      applied_ops_to_virtual_ops();
          const vector<optional< operation_history_object > >& get_applied_operations()const;
          vector<optional< operation_history_object > > get_virtual_ops_and_clear_collection();
+         /// virtual operations overwritten because the collection was full before anything drained it
+         uint64_t  get_dropped_virtual_ops_count()const { return _dropped_virtual_ops; }
 
          string to_pretty_string(const asset& a) const;
          string to_pretty_string(const asset_reserved& a) const;
@@ -322,7 +394,7 @@ namespace graphene { namespace chain {
          void register_evaluator()
          {
             _operation_evaluators[
-               operation::tag<typename EvaluatorType::operation_type>::value].reset( new op_evaluator_impl<EvaluatorType>() );
+               operation::tag<typename EvaluatorType::operation_type>::value] = &evaluate_operation<EvaluatorType>;
          }
 
          //////////////////// db_balance.cpp ////////////////////
@@ -613,8 +685,13 @@ namespace graphene { namespace chain {
          void notify_changed_objects();
 
       private:
+         friend struct detail::chain_state_writer;
+
          optional<undo_database::session>       _pending_tx_session;
-         vector< unique_ptr<op_evaluator> >     _operation_evaluators;
+         mutable boost::shared_mutex            _chain_state_mutex;
+         /// nesting depth of the exclusive chain state lock, generate_block calls push_block
+         uint32_t                               _chain_state_lock_depth = 0;
+         vector< operation_evaluator >          _operation_evaluators;
 
          template<class Index>
          vector<std::reference_wrapper<const typename Index::object_type>> sort_votable_objects(size_t count)const;
@@ -627,8 +704,34 @@ namespace graphene { namespace chain {
          processed_transaction apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          operation_result      apply_operation( transaction_evaluation_state& eval_state, const operation& op );
       private:
+         /// the id does not cover the signatures, so results are kept by both: a re-signed copy is checked again
+         typedef std::pair< transaction_id_type, fc::sha256 > prevalidated_key;
+         static prevalidated_key prevalidation_key( const signed_transaction& trx, const transaction_id_type& id );
+
+         /// results of the checks of a pending transaction that do not depend on chain state
+         struct prevalidated_transaction
+         {
+            transaction_id_type        id;
+            fc::sha256                 signatures_digest;
+            /// packed size as a processed_transaction with its last results, and as a signed_transaction
+            size_t                     packed_size = 0;
+            size_t                     signed_size = 0;
+            bool                       has_signature_keys = false;
+            flat_set<public_key_type>  signature_keys;
+            fc::exception_ptr          error;
+         };
+
          void                  _apply_block( const signed_block& next_block );
-         processed_transaction _apply_transaction( const signed_transaction& trx );
+         processed_transaction _apply_transaction( const signed_transaction& trx, const prevalidated_transaction* checked = nullptr );
+         /// checks trxs where no earlier result is kept, the results kept afterwards are those of trxs, in order
+         vector<const prevalidated_transaction*> prevalidate_transactions( const vector<processed_transaction>& trxs );
+         /// the checks of trxs that do not depend on chain state, on the worker pool for larger batches
+         vector<prevalidated_transaction> check_transactions( const vector<processed_transaction>& trxs, bool check_signatures );
+         /// the checks of a single transaction, reads nothing but its arguments
+         static prevalidated_transaction check_transaction( const processed_transaction& trx, const prevalidated_key& key,
+                                                            const chain_id_type& chain_id, bool check_signatures );
+         /// keeps the results of the checks prevalidate_pending_transactions() started once they are done
+         void collect_prevalidated_transactions( bool wait );
 
          ///Steps involved in applying a new block
          ///@{
@@ -636,6 +739,13 @@ namespace graphene { namespace chain {
          const witness_object& validate_block_header( uint32_t skip, const signed_block& next_block )const;
          const witness_object& _validate_block_header( const signed_block& next_block )const;
          void create_block_summary(const signed_block& next_block);
+         void store_virtual_operations(uint32_t block_num);
+
+         /// applies a block of a fork switch, from its retained changes when it has them
+         void apply_fork_block( const item_ptr& item, uint32_t skip );
+         /// keeps the changes of the block being applied and its operations in its fork item, within the budget
+         void capture_block_changes( const item_ptr& item );
+         void forget_fork_changes( const block_id_type& id );
 
          //////////////////// db_update.cpp ////////////////////
 
@@ -691,7 +801,17 @@ public:
 
 private:
          vector< processed_transaction >        _pending_tx;
+         std::map< prevalidated_key, prevalidated_transaction > _prevalidated_tx;
+         /// changes whenever _pending_tx does, so the witness does not check an unchanged pool again
+         uint64_t                               _pending_tx_version = 0;
+         uint64_t                               _prevalidated_pending_version = 0;
+         /// checks started by prevalidate_pending_transactions() that were not collected yet
+         std::future< vector<prevalidated_transaction> > _background_prevalidation;
          fork_database                          _fork_db;
+         size_t                                 _fork_changes_retention = 0;
+         size_t                                 _retained_fork_changes_size = 0;
+         /// blocks with retained changes and their sizes, oldest first
+         std::deque< std::pair<block_id_type, size_t> > _retained_fork_changes;
 
          /**
           *  Note: we can probably store blocks by block num rather than
@@ -712,18 +832,39 @@ private:
           */
          vector<optional<operation_history_object> >  _applied_ops;
 
+         /**
+          * Sequence number of the last entry of _applied_ops.  Numbers are never reused for operations
+          * that were captured, so a virtual op can be told apart from one taken earlier in O(1).
+          */
+         uint64_t                                     _applied_op_seq = 0;
+         uint64_t                                     _last_captured_virtual_op_seq = 0;
+
          /**
           * Contains the set of virtual ops that are in the process of being applied from
           * the current block.  It contains real virtual operations in the
-          * order they occur and is cleared after account history plugin is updated
+          * order they occur and is cleared after account history plugin is updated.
+          * Bounded by GRAPHENE_MAX_BUFFERED_VIRTUAL_OPS, the oldest entries are dropped when nothing drains it;
+          * that is logged and counted in get_dropped_virtual_ops_count().
           */
-         vector<optional<operation_history_object> >  _virtual_ops;
+         boost::circular_buffer_space_optimized<optional<operation_history_object> >  _virtual_ops{ GRAPHENE_MAX_BUFFERED_VIRTUAL_OPS };
+         uint64_t                                     _dropped_virtual_ops = 0;
+         uint64_t                                     _virtual_ops_dropped_since_drain = 0;
 
          uint32_t                          _current_block_num    = 0;
          uint16_t                          _current_trx_in_block = 0;
          uint16_t                          _current_op_in_trx    = 0;
          uint16_t                          _current_virtual_op   = 0;
 
+         uint32_t                          _virtual_op_retention = 0;
+
+         apply_profiler                    _apply_profiler;
+         fc::path                          _apply_profile_replay_dump;
+
+         fc::sha256                        _head_state_digest;
+         block_id_type                     _head_state_digest_block;
+
+         std::unique_ptr<worker_pool>      _worker_pool{ new worker_pool };
+
          vector<uint64_t>                  _vote_tally_buffer;
          vector<uint64_t>                  _witness_count_histogram_buffer;
          vector<uint64_t>                  _committee_count_histogram_buffer;
@@ -112,6 +112,28 @@ struct pending_transactions_restorer
    std::vector< processed_transaction > _pending_transactions;
 };
 
+/**
+ * Holds the database's chain state mutex exclusively for its lifetime.  Nested writers
+ * (generate_block calling push_block) only count the depth.
+ */
+struct chain_state_writer
+{
+   chain_state_writer( database& db )
+      : _db( db )
+   {
+      if( _db._chain_state_lock_depth++ == 0 )
+         _db._chain_state_mutex.lock();
+   }
+
+   ~chain_state_writer()
+   {
+      if( --_db._chain_state_lock_depth == 0 )
+         _db._chain_state_mutex.unlock();
+   }
+
+   database& _db;
+};
+
 /**
  * Set the skip_flags to the given value, call callback,
  * then reset skip_flags to their previous value after
@@ -83,7 +83,7 @@ namespace graphene { namespace chain {
        *
        * In particular, core_fee_paid field is set by prepare_fee().
        */
-      void prepare_fee(account_id_type account_id, asset fee, operation op);
+      void prepare_fee(account_id_type account_id, asset fee, const operation& op);
 
       object_id_type get_relative_id( object_id_type rel_id )const;
 
@@ -109,23 +109,16 @@ namespace graphene { namespace chain {
       transaction_evaluation_state*    trx_state;
    };
 
-   class op_evaluator
-   {
-   public:
-      virtual ~op_evaluator(){}
-      virtual operation_result evaluate(transaction_evaluation_state& eval_state, const operation& op, bool apply) = 0;
-   };
+   /// entry of the evaluator table of the database, indexed by operation::which()
+   typedef operation_result (*operation_evaluator)( transaction_evaluation_state& eval_state, const operation& op, bool apply );
 
-   template<typename T>
-   class op_evaluator_impl : public op_evaluator
+   /// evaluates op, and applies it when asked, with an EvaluatorType on the stack
+   template<typename EvaluatorType>
+   operation_result evaluate_operation( transaction_evaluation_state& eval_state, const operation& op, bool apply )
    {
-   public:
-      virtual operation_result evaluate(transaction_evaluation_state& eval_state, const operation& op, bool apply = true) override
-      {
-         T eval;
-         return eval.start_evaluate(eval_state, op, apply);
-      }
-   };
+      EvaluatorType eval;
+      return eval.evaluate_in_place( eval_state, op, apply );
+   }
 
    template<typename DerivedEvaluator>
    class evaluator : public generic_evaluator
@@ -133,12 +126,22 @@ namespace graphene { namespace chain {
    public:
       virtual int get_type()const override { return operation::tag<typename DerivedEvaluator::operation_type>::value; }
 
+      /// start_evaluate() without the virtual calls, for evaluate_operation() which knows the evaluator type
+      operation_result evaluate_in_place( transaction_evaluation_state& eval_state, const operation& o, bool apply )
+      { try {
+         trx_state = &eval_state;
+         auto result = evaluator::evaluate( o );
+
+         if( apply ) result = evaluator::apply( o );
+         return result;
+      } FC_CAPTURE_AND_RETHROW() }
+
       virtual operation_result evaluate(const operation& o) final override
       {
          auto* eval = static_cast<DerivedEvaluator*>(this);
          const auto& op = o.get<typename DerivedEvaluator::operation_type>();
 
-         if (get_type() != graphene::chain::operation::tag<change_public_keys_operation>::value)
+         if (o.which() != graphene::chain::operation::tag<change_public_keys_operation>::value)
          {
            flat_set<account_id_type> authorities;
            authorities.insert(op.fee_payer());
@@ -153,7 +156,7 @@ namespace graphene { namespace chain {
            }
          }
 
-         prepare_fee(op.fee_payer(), op.fee, op);
+         prepare_fee(op.fee_payer(), op.fee, o);
 
          return eval->do_evaluate(op);
       }
@@ -23,6 +23,8 @@
  */
 #pragma once
 #include <graphene/chain/protocol/block.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+#include <graphene/db/undo_database.hpp>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
@@ -35,6 +37,18 @@ namespace graphene { namespace chain {
    using boost::multi_index_container;
    using namespace boost::multi_index;
 
+   /**
+    *  What a block did to the chain state before the applied_block signal, and the operations it applied,
+    *  enough to apply it again on the state it was applied to without evaluating it.
+    */
+   struct block_changes
+   {
+      graphene::db::redo_state                        changes;
+      vector< optional< operation_history_object > >  applied_ops;
+      /// approximate memory held
+      size_t                                          size = 0;
+   };
+
    struct fork_item
    {
       fork_item( signed_block d )
@@ -46,6 +60,8 @@ namespace graphene { namespace chain {
       uint32_t              num;    // initialized in ctor
       block_id_type         id;
       signed_block          data;
+      /// the changes of the block, taken when it was applied while fork changes are retained
+      shared_ptr< block_changes > applied_changes;
    };
    typedef shared_ptr<fork_item> item_ptr;
 
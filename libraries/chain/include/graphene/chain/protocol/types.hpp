@@ -296,7 +296,8 @@ namespace graphene { namespace chain {
       impl_das33_project_object_type,
       impl_das33_pledge_holder_object_type,
       impl_delayed_operation_object_type,
-      impl_withdrawal_limit_object_type
+      impl_withdrawal_limit_object_type,
+      impl_virtual_op_object_type
    };
 
    //typedef fc::unsigned_int            object_id_type;
@@ -368,6 +369,7 @@ namespace graphene { namespace chain {
    class das33_pledge_holder_object;
    class delayed_operation_object;
    class withdrawal_limit_object;
+   class virtual_op_object;
 
    typedef object_id< implementation_ids, impl_global_property_object_type,  global_property_object>                    global_property_id_type;
    typedef object_id< implementation_ids, impl_dynamic_global_property_object_type,  dynamic_global_property_object>    dynamic_global_property_id_type;
@@ -449,6 +451,10 @@ namespace graphene { namespace chain {
          implementation_ids, impl_withdrawal_limit_object_type, withdrawal_limit_object
       > withdrawal_limit_id_type;
 
+   typedef object_id<
+         implementation_ids, impl_virtual_op_object_type, virtual_op_object
+      > virtual_op_id_type;
+
    typedef fc::array<char, GRAPHENE_MAX_ASSET_SYMBOL_LENGTH>    symbol_type;
    typedef fc::ripemd160                                        block_id_type;
    typedef fc::ripemd160                                        checksum_type;
@@ -658,6 +664,7 @@ FC_REFLECT_ENUM( graphene::chain::impl_object_type,
                  (impl_das33_pledge_holder_object_type)
                  (impl_delayed_operation_object_type)
                  (impl_withdrawal_limit_object_type)
+                 (impl_virtual_op_object_type)
                )
 
 FC_REFLECT_TYPENAME( graphene::chain::share_type )
@@ -707,6 +714,7 @@ FC_REFLECT_TYPENAME( graphene::chain::das33_project_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::das33_pledge_holder_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::delayed_operation_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::withdrawal_limit_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::virtual_op_id_type )
 
 FC_REFLECT( graphene::chain::void_t, )
 
@@ -27,6 +27,8 @@
 namespace graphene { namespace chain {
    class database;
    struct signed_transaction;
+   class asset_object;
+   class asset_dynamic_data_object;
 
    /**
     *  Place holder for state tracked while processing a transaction. This class provides helper methods that are
@@ -48,5 +50,9 @@ namespace graphene { namespace chain {
          bool                             skip_fee = false;
          bool                             skip_fee_schedule_check = false;
          bool skip_chain_authority_check = false;
+
+         /// the fee asset of the previous operation, the operations of a transaction mostly pay in the same asset
+         const asset_object*              fee_asset = nullptr;
+         const asset_dynamic_data_object* fee_asset_dyn_data = nullptr;
    };
 } } // namespace graphene::chain
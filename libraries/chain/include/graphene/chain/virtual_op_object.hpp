@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <graphene/chain/protocol/operations.hpp>
+#include <graphene/chain/protocol/types.hpp>
+#include <graphene/db/generic_index.hpp>
+#include <graphene/db/object.hpp>
+
+#include <boost/multi_index/composite_key.hpp>
+
+namespace graphene { namespace chain {
+
+  /**
+   * @brief A virtual operation produced while applying a block
+   * @ingroup object
+   * @ingroup implementation
+   *
+   * Written by the database for every virtual operation of an applied block, independently of the history
+   * plugins, so virtual operations of a given type can be looked up per block without scanning the operation
+   * history.  Entries older than the configured retention are pruned as blocks are applied.
+   */
+  class virtual_op_object : public graphene::db::abstract_object<virtual_op_object>
+  {
+    public:
+      static const uint8_t space_id = implementation_ids;
+      static const uint8_t type_id  = impl_virtual_op_object_type;
+
+      uint32_t block_num = 0;
+      /** operation::which() of the stored operation */
+      uint16_t op_type = 0;
+      /** position among all operations applied in the block, keeps the results in block order */
+      uint32_t op_in_block = 0;
+      uint16_t trx_in_block = 0;
+      uint16_t op_in_trx = 0;
+      operation op;
+  };
+
+  struct by_block_type;
+  using virtual_op_multi_index_type = multi_index_container<
+    virtual_op_object,
+    indexed_by<
+      ordered_unique<
+        tag<by_id>,
+        member<object, object_id_type, &object::id>
+      >,
+      ordered_unique<
+        tag<by_block_type>,
+        composite_key< virtual_op_object,
+          member< virtual_op_object, uint32_t, &virtual_op_object::block_num >,
+          member< virtual_op_object, uint16_t, &virtual_op_object::op_type >,
+          member< virtual_op_object, uint32_t, &virtual_op_object::op_in_block >
+        >
+      >
+    >
+  >;
+
+  using virtual_op_index = generic_index<virtual_op_object, virtual_op_multi_index_type>;
+
+} }  // namespace graphene::chain
+
+FC_REFLECT_DERIVED( graphene::chain::virtual_op_object, (graphene::db::object),
+                    (block_num)
+                    (op_type)
+                    (op_in_block)
+                    (trx_in_block)
+                    (op_in_trx)
+                    (op)
+                  )
@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  A fixed set of threads shared by everything that splits read-only or independent work into shards, so
+    *  concurrent callers queue on the same threads instead of each starting their own.  The threads are
+    *  started on first use.
+    */
+   class worker_pool
+   {
+      public:
+         /// thread_count 0 uses one thread per hardware thread
+         explicit worker_pool( size_t thread_count = 0 );
+         ~worker_pool();
+
+         worker_pool( const worker_pool& ) = delete;
+         worker_pool& operator=( const worker_pool& ) = delete;
+
+         size_t thread_count()const { return _thread_count; }
+
+         /**
+          *  Calls f( first, last ) for consecutive ranges covering [0, count), each of at least min_per_shard
+          *  items, and returns when all of them are done.  The calling thread works on the ranges too, so the
+          *  call never waits on ranges that no thread has picked up yet.  The first exception thrown by f is
+          *  rethrown once all ranges are done.  f must not use the pool itself.
+          */
+         void run_shards( size_t count, size_t min_per_shard, const std::function<void( size_t, size_t )>& f );
+
+         /**
+          *  Runs task on a pool thread, for work nobody waits for right away.  The task may split its work with
+          *  run_shards(), it works on its own ranges then.  Queued tasks still run when the pool is destroyed.
+          */
+         void post( std::function<void()> task );
+
+      private:
+         void start_threads();
+         void work();
+
+         const size_t                          _thread_count;
+         std::mutex                            _mutex;
+         std::condition_variable               _wake;
+         std::deque<std::function<void()>>     _tasks;
+         std::vector<std::thread>              _threads;
+         bool                                  _stopping = false;
+   };
+
+} } // graphene::chain
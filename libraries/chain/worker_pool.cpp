@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/worker_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+   /// the ranges of one run_shards call, shared with the pool threads that may pick them up after it returned
+   struct shard_run
+   {
+      shard_run( size_t count, size_t shards, const std::function<void( size_t, size_t )>& f )
+         : count( count ), shard_count( shards ), shard_size( ( count + shards - 1 ) / shards ), work( f ) {}
+
+      /// runs ranges until none is left unclaimed
+      void run_ranges()
+      {
+         for( size_t shard = next.fetch_add( 1 ); shard < shard_count; shard = next.fetch_add( 1 ) )
+         {
+            std::exception_ptr failure;
+            try
+            {
+               work( std::min( shard * shard_size, count ), std::min( ( shard + 1 ) * shard_size, count ) );
+            }
+            catch( ... )
+            {
+               failure = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock( mutex );
+            if( failure && !error )
+               error = failure;
+            if( ++finished == shard_count )
+               done.notify_all();
+         }
+      }
+
+      const size_t                                   count;
+      const size_t                                   shard_count;
+      const size_t                                   shard_size;
+      const std::function<void( size_t, size_t )>&   work;
+      std::atomic<size_t>                            next{ 0 };
+
+      std::mutex                                     mutex;
+      std::condition_variable                        done;
+      size_t                                         finished = 0;
+      std::exception_ptr                             error;
+   };
+
+}
+
+worker_pool::worker_pool( size_t thread_count )
+   : _thread_count( thread_count ? thread_count : std::max( 1u, std::thread::hardware_concurrency() ) )
+{
+}
+
+worker_pool::~worker_pool()
+{
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stopping = true;
+   }
+   _wake.notify_all();
+   for( auto& thread : _threads )
+      thread.join();
+}
+
+void worker_pool::start_threads()
+{
+   // called with _mutex held
+   _threads.reserve( _thread_count );
+   for( size_t i = 0; i < _thread_count; ++i )
+      _threads.emplace_back( [this]{ work(); } );
+}
+
+void worker_pool::work()
+{
+   for( ;; )
+   {
+      std::function<void()> task;
+      {
+         std::unique_lock<std::mutex> lock( _mutex );
+         _wake.wait( lock, [this]{ return _stopping || !_tasks.empty(); } );
+         if( _tasks.empty() )
+            return;
+         task = std::move( _tasks.front() );
+         _tasks.pop_front();
+      }
+      task();
+   }
+}
+
+void worker_pool::post( std::function<void()> task )
+{
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( _threads.empty() )
+         start_threads();
+      _tasks.push_back( std::move( task ) );
+   }
+   _wake.notify_one();
+}
+
+void worker_pool::run_shards( size_t count, size_t min_per_shard, const std::function<void( size_t, size_t )>& f )
+{
+   const size_t shard_count = std::min( _thread_count, ( count + std::max<size_t>( min_per_shard, 1 ) - 1 )
+                                                       / std::max<size_t>( min_per_shard, 1 ) );
+   if( shard_count <= 1 )
+   {
+      f( 0, count );
+      return;
+   }
+
+   // f and the run outlive every range: the call below does not return before all of them finished, a pool
+   // thread that gets to a helper task later only finds no range left to claim.
+   auto run = std::make_shared<shard_run>( count, shard_count, f );
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( _threads.empty() )
+         start_threads();
+      for( size_t i = 1; i < shard_count; ++i )
+         _tasks.push_back( [run]{ run->run_ranges(); } );
+   }
+   _wake.notify_all();
+
+   run->run_ranges();
+
+   std::unique_lock<std::mutex> lock( run->mutex );
+   run->done.wait( lock, [&run]{ return run->finished == run->shard_count; } );
+   if( run->error )
+      std::rethrow_exception( run->error );
+}
+
+} } // graphene::chain
@@ -114,9 +114,14 @@ namespace graphene { namespace chain {
 
          virtual fc::uint128 hash()const override {
             fc::uint128 result;
+            // object::hash() would allocate a buffer per object
+            vector<char> buffer;
             for( const auto& ptr : _indices )
             {
-               result += ptr.hash();
+               buffer.resize( fc::raw::pack_size( ptr ) );
+               fc::datastream<char*> ds( buffer.data(), buffer.size() );
+               fc::raw::pack( ds, ptr );
+               result += fc::city_hash_crc_128( buffer.data(), buffer.size() );
             }
 
             return result;
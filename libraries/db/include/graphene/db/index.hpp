@@ -128,6 +128,12 @@ namespace graphene { namespace db {
 
          virtual void               inspect_all_objects(std::function<void(const object&)> inspector)const = 0;
          virtual fc::uint128        hash()const = 0;
+         /**
+          *  A hash of the objects as the state digest sees them, kept up to date as objects are created, modified
+          *  and removed while tracking is on, so reading it costs nothing.  Without tracking every object is hashed.
+          */
+         virtual fc::uint128        state_digest()const { return hash(); }
+         virtual void               track_state_digest( bool on ) {}
          virtual void               add_observer( const shared_ptr<index_observer>& ) = 0;
 
          virtual void               object_from_variant( const fc::variant& var, object& obj, uint32_t max_depth )const = 0;
@@ -191,6 +197,16 @@ namespace graphene { namespace db {
    };
 
 
+   /**
+    * The part of an object the state digest covers, all of it unless specialized.  A specialization returns a
+    * copy without the fields node local code (such as plugins) writes, which differ between nodes on one chain.
+    */
+   template<typename ObjectType>
+   struct state_digest_projection
+   {
+      static const ObjectType& project( const ObjectType& o ) { return o; }
+   };
+
    /**
     * @class primary_index
     * @brief  Wraps a derived index to intercept calls to create, modify, and remove so that
@@ -264,6 +280,8 @@ namespace graphene { namespace db {
             const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
             for( const auto& item : _sindex )
                item->object_inserted( result );
+            if( _track_state_digest )
+               _state_digest += object_digest( result );
             return result;
          }
 
@@ -273,6 +291,8 @@ namespace graphene { namespace db {
             const auto& result = DerivedIndex::create( constructor );
             for( const auto& item : _sindex )
                item->object_inserted( result );
+            if( _track_state_digest )
+               _state_digest += object_digest( result );
             on_add( result );
             return result;
          }
@@ -282,6 +302,8 @@ namespace graphene { namespace db {
             const auto& result = DerivedIndex::insert( std::move( obj ) );
             for( const auto& item : _sindex )
                item->object_inserted( result );
+            if( _track_state_digest )
+               _state_digest += object_digest( result );
             on_add( result );
             return result;
          }
@@ -291,6 +313,8 @@ namespace graphene { namespace db {
             for( const auto& item : _sindex )
                item->object_removed( obj );
             on_remove(obj);
+            if( _track_state_digest )
+               _state_digest -= object_digest( obj );
             DerivedIndex::remove(obj);
          }
 
@@ -299,12 +323,46 @@ namespace graphene { namespace db {
             save_undo( obj );
             for( const auto& item : _sindex )
                item->about_to_modify( obj );
-            DerivedIndex::modify( obj, m );
+            if( _track_state_digest )
+            {
+               const object_id_type id = obj.id;
+               _state_digest -= object_digest( obj );
+               try {
+                  DerivedIndex::modify( obj, m );
+               } catch( ... ) {
+                  // a failed modify may leave the object changed or, on a violated index constraint, erased
+                  if( const object* after = DerivedIndex::find( id ) )
+                     _state_digest += object_digest( *after );
+                  throw;
+               }
+               _state_digest += object_digest( obj );
+            }
+            else
+               DerivedIndex::modify( obj, m );
             for( const auto& item : _sindex )
                item->object_modified( obj );
             on_modify( obj );
          }
 
+         virtual fc::uint128 state_digest()const override
+         {
+            if( _track_state_digest )
+               return _state_digest;
+            fc::uint128 result;
+            this->inspect_all_objects( [&]( const object& o ) { result += object_digest( o ); } );
+            return result;
+         }
+
+         virtual void track_state_digest( bool on )override
+         {
+            if( on && !_track_state_digest )
+            {
+               _state_digest = fc::uint128();
+               this->inspect_all_objects( [&]( const object& o ) { _state_digest += object_digest( o ); } );
+            }
+            _track_state_digest = on;
+         }
+
          virtual void add_observer( const shared_ptr<index_observer>& o ) override
          {
             _observers.emplace_back( o );
@@ -329,7 +387,21 @@ namespace graphene { namespace db {
          }
 
       private:
-         object_id_type _next_id;
+         /** object::hash() of the state_digest_projection, packing into a buffer that is reused across objects */
+         fc::uint128 object_digest( const object& obj )const
+         {
+            const auto& o = state_digest_projection<object_type>::project( static_cast<const object_type&>( obj ) );
+            _digest_buffer.resize( fc::raw::pack_size( o ) );
+            fc::datastream<char*> ds( _digest_buffer.data(), _digest_buffer.size() );
+            fc::raw::pack( ds, o );
+            return fc::city_hash_crc_128( _digest_buffer.data(), _digest_buffer.size() );
+         }
+
+         object_id_type       _next_id;
+         bool                 _track_state_digest = false;
+         /// sum of the hashes of all objects, modulo 2^128, so removing an object subtracts its hash
+         fc::uint128          _state_digest;
+         mutable vector<char> _digest_buffer;
    };
 
 } } // graphene::db
@@ -75,8 +75,31 @@ namespace graphene { namespace db {
          const index&  get_index()const { return get_index(T::space_id,T::type_id); }
          const index&  get_index(uint8_t space_id, uint8_t type_id)const;
          const index&  get_index(object_id_type id)const { return get_index(id.space(),id.type()); }
+         /** visits every registered index, ordered by space and type */
+         void          inspect_all_indexes( const std::function<void(const index&)>& inspector )const;
          /// @}
 
+         /// tells by space and type id whether an index is part of the state digest
+         typedef std::function<bool( uint8_t space_id, uint8_t type_id )> state_digest_filter;
+
+         /**
+          * Restricts state_digest() to the indexes the filter accepts, so objects that differ between nodes in
+          * the same state (filled by plugins or by node options) can be left out.  Without a filter every index
+          * is covered.  Set it before tracking is turned on.
+          */
+         void          set_state_digest_filter( state_digest_filter filter ) { _state_digest_filter = std::move( filter ); }
+         bool          covered_by_state_digest( uint8_t space_id, uint8_t type_id )const
+         { return !_state_digest_filter || _state_digest_filter( space_id, type_id ); }
+
+         /**
+          * Keeps index::state_digest() of every covered index up to date from now on, at the cost of hashing
+          * every object that is created, modified or removed.
+          */
+         void          track_state_digest( bool on );
+         bool          tracks_state_digest()const { return _track_state_digest; }
+         /** digest of the state, combining the state digests of the covered indexes */
+         fc::sha256    state_digest()const;
+
          const object& get_object( object_id_type id )const;
          const object* find_object( object_id_type id )const;
 
@@ -135,6 +158,8 @@ namespace graphene { namespace db {
                 _index[ObjectType::space_id].resize( 255 );
             assert(!_index[ObjectType::space_id][ObjectType::type_id]);
             unique_ptr<index> indexptr( new IndexType(*this) );
+            if( _track_state_digest && covered_by_state_digest( ObjectType::space_id, ObjectType::type_id ) )
+               indexptr->track_state_digest( true );
             _index[ObjectType::space_id][ObjectType::type_id] = std::move(indexptr);
             return static_cast<IndexType*>(_index[ObjectType::space_id][ObjectType::type_id].get());
          }
@@ -145,6 +170,13 @@ namespace graphene { namespace db {
             return get_mutable_index_type<IndexType>().template add_secondary_index<SecondaryIndexType, Args...>(args...);
          }
 
+         /** registers an observer on the index holding objects of type T */
+         template<typename T>
+         void add_index_observer( const shared_ptr<index_observer>& observer )
+         {
+            get_mutable_index<T>().add_observer( observer );
+         }
+
          void pop_undo();
 
          fc::path get_data_dir()const { return _data_dir; }
@@ -172,6 +204,8 @@ namespace graphene { namespace db {
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         bool                                                      _track_state_digest = false;
+         state_digest_filter                                       _state_digest_filter;
    };
 
 } } // graphene::db
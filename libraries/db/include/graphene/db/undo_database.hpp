@@ -40,6 +40,22 @@ namespace graphene { namespace db {
       unordered_map<object_id_type, unique_ptr<object> > removed;
    };
 
+   /**
+    * The changes of a committed undo state as the values after it, so they can be redone without
+    * repeating what made them.  Taken by undo_database::capture_head() before the state is popped.
+    */
+   struct redo_state
+   {
+      /// the objects the state modified or created, by ascending id
+      vector< unique_ptr<object> >                   new_values;
+      vector<object_id_type>                         removed_ids;
+      unordered_map<object_id_type, object_id_type>  new_index_next_ids;
+      /// a copy of the undo state, which becomes the head again when the changes are redone
+      undo_state                                     undo;
+      /// approximate memory held, from the packed sizes of the objects
+      size_t                                         size = 0;
+   };
+
 
    /**
     * @class undo_database
@@ -126,6 +142,17 @@ namespace graphene { namespace db {
           */
          void pop_commit();
 
+         /**
+          * The changes of the last committed session, to be called just before pop_commit().
+          */
+         redo_state capture_head()const;
+         /**
+          * Applies the changes of a redo_state taken on the present state and pushes its undo state as
+          * the last committed session, as if the session that made the changes was committed again.
+          * Must be called with no active session.
+          */
+         void redo( redo_state&& state );
+
          std::size_t size()const { return _stack.size(); }
          void set_max_size(size_t new_max_size) { _max_size = new_max_size; }
          size_t max_size()const { return _max_size; }
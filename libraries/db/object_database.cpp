@@ -59,6 +59,36 @@ const index& object_database::get_index(uint8_t space_id, uint8_t type_id)const
    FC_ASSERT( tmp );
    return *tmp;
 }
+void object_database::inspect_all_indexes( const std::function<void(const index&)>& inspector )const
+{
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx )
+            inspector( *idx );
+}
+
+void object_database::track_state_digest( bool on )
+{
+   _track_state_digest = on;
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx && covered_by_state_digest( idx->object_space_id(), idx->object_type_id() ) )
+            idx->track_state_digest( on );
+}
+
+fc::sha256 object_database::state_digest()const
+{
+   fc::sha256::encoder enc;
+   inspect_all_indexes( [&]( const index& idx ) {
+      if( !covered_by_state_digest( idx.object_space_id(), idx.object_type_id() ) )
+         return;
+      fc::raw::pack( enc, idx.object_space_id() );
+      fc::raw::pack( enc, idx.object_type_id() );
+      fc::raw::pack( enc, idx.state_digest() );
+   } );
+   return enc.result();
+}
+
 index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
 {
    FC_ASSERT( _index.size() > space_id, "", ("space_id",space_id)("type_id",type_id)("index.size",_index.size()) );
@@ -25,6 +25,8 @@
 #include <graphene/db/undo_database.hpp>
 #include <fc/reflect/variant.hpp>
 
+#include <algorithm>
+
 namespace graphene { namespace db {
 
 void undo_database::enable()  { _disabled = false; }
@@ -285,6 +287,74 @@ void undo_database::pop_commit()
    }
    enable();
 }
+redo_state undo_database::capture_head()const
+{
+   const undo_state& state = head();
+   redo_state result;
+
+   for( const auto& item : state.old_values )
+   {
+      result.new_values.push_back( _db.get_object( item.first ).clone() );
+      result.undo.old_values[item.first] = item.second->clone();
+   }
+   for( const auto& id : state.new_ids )
+      result.new_values.push_back( _db.get_object( id ).clone() );
+   result.undo.new_ids = state.new_ids;
+   for( const auto& item : state.removed )
+   {
+      result.removed_ids.push_back( item.first );
+      result.undo.removed[item.first] = item.second->clone();
+   }
+   for( const auto& item : state.old_index_next_ids )
+      result.new_index_next_ids[item.first] = _db.get_index( item.first.space(), item.first.type() ).get_next_id();
+   result.undo.old_index_next_ids = state.old_index_next_ids;
+
+   std::sort( result.new_values.begin(), result.new_values.end(),
+              []( const unique_ptr<object>& a, const unique_ptr<object>& b ) { return a->id < b->id; } );
+   for( const auto& obj : result.new_values )
+      result.size += obj->pack().size();
+   for( const auto& item : result.undo.old_values )
+      result.size += item.second->pack().size();
+   for( const auto& item : result.undo.removed )
+      result.size += item.second->pack().size();
+   return result;
+}
+
+void undo_database::redo( redo_state&& state )
+{
+   FC_ASSERT( !_disabled );
+   FC_ASSERT( _active_sessions == 0 );
+
+   disable();
+   try {
+      // the objects are removed and inserted anew, so no unique index sees a value the changes moved away from
+      for( const auto& id : state.removed_ids )
+         _db.remove( _db.get_object( id ) );
+      for( const auto& obj : state.new_values )
+      {
+         const object* current = _db.find_object( obj->id );
+         if( current != nullptr )
+            _db.remove( *current );
+      }
+      for( auto& obj : state.new_values )
+         _db.insert( std::move(*obj) );
+
+      for( const auto& item : state.new_index_next_ids )
+         _db.get_mutable_index( item.first.space(), item.first.type() ).set_next_id( item.second );
+
+      while( size() > max_size() )
+         _stack.pop_front();
+      _stack.push_back( std::move(state.undo) );
+   }
+   catch ( const fc::exception& e )
+   {
+      elog( "error redoing changes ${e}", ("e", e.to_detail_string() )  );
+      enable();
+      throw;
+   }
+   enable();
+}
+
 const undo_state& undo_database::head()const
 {
    FC_ASSERT( !_stack.empty() );
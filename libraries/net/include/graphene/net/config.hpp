@@ -110,3 +110,10 @@
 #define GRAPHENE_NET_MAX_NESTED_OBJECTS                      (250)
 
 #define MAXIMUM_PEERDB_SIZE 1000
+
+/**
+ * The peer database is kept as an append-only log of updates.  Once this many
+ * entries have been appended since the last compaction (and the log holds more
+ * entries than live peers), the log is rewritten to contain only the live set.
+ */
+#define GRAPHENE_NET_PEER_DATABASE_COMPACTION_THRESHOLD      1000
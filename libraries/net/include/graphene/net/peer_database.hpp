@@ -52,6 +52,8 @@ namespace graphene { namespace net {
     uint32_t                          number_of_successful_connection_attempts;
     uint32_t                          number_of_failed_connection_attempts;
     fc::optional<fc::exception>       last_error;
+    fc::time_point_sec                last_successful_connection_time; ///< last time a handshake with this peer completed
+    fc::microseconds                  round_trip_delay = fc::microseconds::maximum(); ///< last measured latency, maximum() if unknown
 
     potential_peer_record() :
       number_of_successful_connection_attempts(0),
@@ -108,6 +110,12 @@ namespace graphene { namespace net {
     potential_peer_record lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
     fc::optional<potential_peer_record> lookup_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
 
+    /**
+     * Returns all known peers ordered by how promising they are as connection candidates:
+     * most recent successful connection first, then fewest failures, then lowest latency.
+     */
+    std::vector<potential_peer_record> get_connection_candidates() const;
+
     typedef detail::peer_database_iterator iterator;
     iterator begin() const;
     iterator end() const;
@@ -119,4 +127,4 @@ namespace graphene { namespace net {
 } } // end namespace graphene::net
 
 FC_REFLECT_ENUM(graphene::net::potential_peer_last_connection_disposition, (never_attempted_to_connect)(last_connection_failed)(last_connection_rejected)(last_connection_handshaking_failed)(last_connection_succeeded))
-FC_REFLECT(graphene::net::potential_peer_record, (endpoint)(last_seen_time)(last_connection_disposition)(last_connection_attempt_time)(number_of_successful_connection_attempts)(number_of_failed_connection_attempts)(last_error) )
+FC_REFLECT(graphene::net::potential_peer_record, (endpoint)(last_seen_time)(last_connection_disposition)(last_connection_attempt_time)(number_of_successful_connection_attempts)(number_of_failed_connection_attempts)(last_error)(last_successful_connection_time)(round_trip_delay) )
@@ -410,8 +410,11 @@ namespace graphene { namespace net { namespace detail {
             bool initiated_connection_this_pass = false;
             _potential_peer_database_updated = false;
 
-            for (peer_database::iterator iter = _potential_peer_db.begin();
-                 iter != _potential_peer_db.end() && is_wanting_new_connections();
+            // walk the candidates best-first so that after a restart we reconnect to the peers that
+            // most recently worked for us before wasting connection slots on stale or flaky ones
+            std::vector<potential_peer_record> connection_candidates = _potential_peer_db.get_connection_candidates();
+            for (auto iter = connection_candidates.begin();
+                 iter != connection_candidates.end() && is_wanting_new_connections();
                  ++iter)
             {
               fc::microseconds delay_until_retry = fc::seconds((iter->number_of_failed_connection_attempts + 1) * _peer_connection_retry_timeout);
@@ -1716,6 +1719,7 @@ namespace graphene { namespace net { namespace detail {
             if (updated_peer_record)
             {
               updated_peer_record->last_connection_disposition = last_connection_succeeded;
+              updated_peer_record->last_successful_connection_time = fc::time_point::now();
               _potential_peer_db.update_entry(*updated_peer_record);
             }
           }
@@ -1835,6 +1839,7 @@ namespace graphene { namespace net { namespace detail {
           // mark the connection as successful in the database
           potential_peer_record updated_peer_record = _potential_peer_db.lookup_or_create_entry_for_endpoint(*inbound_endpoint);
           updated_peer_record.last_connection_disposition = last_connection_succeeded;
+          updated_peer_record.last_successful_connection_time = fc::time_point::now();
           _potential_peer_db.update_entry(updated_peer_record);
         }
 
@@ -3113,6 +3118,18 @@ namespace graphene { namespace net { namespace detail {
                                                          (current_time_reply_message_received.reply_transmitted_time - reply_received_time)).count() / 2);
       originating_peer->round_trip_delay = (reply_received_time - current_time_reply_message_received.request_sent_time) -
                                            (current_time_reply_message_received.reply_transmitted_time - current_time_reply_message_received.request_received_time);
+
+      // remember the latency so the connect loop can prefer nearby peers next time
+      fc::optional<fc::ip::endpoint> inbound_endpoint = originating_peer->get_endpoint_for_connecting();
+      if (inbound_endpoint)
+      {
+        fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db.lookup_entry_for_endpoint(*inbound_endpoint);
+        if (updated_peer_record)
+        {
+          updated_peer_record->round_trip_delay = originating_peer->round_trip_delay;
+          _potential_peer_db.update_entry(*updated_peer_record);
+        }
+      }
     }
 
     void node_impl::forward_firewall_check_to_next_available_peer(firewall_check_state_data* firewall_check_state)
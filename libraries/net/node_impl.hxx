@@ -173,7 +173,7 @@ class node_impl : public peer_connection_delegate
       fc::sha256           _chain_id;
 
 #define NODE_CONFIGURATION_FILENAME      "node_config.json"
-#define POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
+#define POTENTIAL_PEER_DATABASE_FILENAME "peers.dat"
       fc::path             _node_configuration_directory;
       node_configuration   _node_configuration;
 
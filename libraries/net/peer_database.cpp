@@ -27,11 +27,16 @@
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/tag.hpp>
+#include <boost/multi_index/composite_key.hpp>
+
+#include <fstream>
 
 #include <fc/io/raw.hpp>
 #include <fc/io/raw_variant.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/datastream.hpp>
+#include <fc/filesystem.hpp>
 
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/config.hpp>
@@ -41,11 +46,37 @@ namespace graphene { namespace net {
   {
     using namespace boost::multi_index;
 
+    /**
+     * The on-disk peer database is a sequence of these entries.  An update entry
+     * carries the whole packed record for an endpoint, an erase entry carries only
+     * the endpoint.  Replaying the log in order reconstructs the live peer set.
+     */
+    enum peer_database_log_entry_type
+    {
+      peer_database_log_update = 0,
+      peer_database_log_erase  = 1
+    };
+
+    struct peer_database_log_entry
+    {
+      uint8_t           type = peer_database_log_update;
+      std::vector<char> data;
+    };
+
+  } // end namespace detail
+} } // end namespace graphene::net
+
+FC_REFLECT( graphene::net::detail::peer_database_log_entry, (type)(data) )
+
+namespace graphene { namespace net {
+  namespace detail
+  {
     class peer_database_impl
     {
     public:
       struct last_seen_time_index {};
       struct endpoint_index {};
+      struct connection_score_index {};
       typedef boost::multi_index_container<potential_peer_record, 
                                            indexed_by<ordered_non_unique<tag<last_seen_time_index>, 
                                                                          member<potential_peer_record, 
@@ -55,13 +86,37 @@ namespace graphene { namespace net {
                                                                     member<potential_peer_record, 
                                                                            fc::ip::endpoint, 
                                                                            &potential_peer_record::endpoint>, 
-                                                                    std::hash<fc::ip::endpoint> > > > potential_peer_set;
+                                                                    std::hash<fc::ip::endpoint> >,
+                                                      ordered_non_unique<tag<connection_score_index>,
+                                                                         composite_key<potential_peer_record,
+                                                                                       member<potential_peer_record,
+                                                                                              fc::time_point_sec,
+                                                                                              &potential_peer_record::last_successful_connection_time>,
+                                                                                       member<potential_peer_record,
+                                                                                              uint32_t,
+                                                                                              &potential_peer_record::number_of_failed_connection_attempts>,
+                                                                                       member<potential_peer_record,
+                                                                                              fc::microseconds,
+                                                                                              &potential_peer_record::round_trip_delay> >,
+                                                                         composite_key_compare<std::greater<fc::time_point_sec>,
+                                                                                               std::less<uint32_t>,
+                                                                                               std::less<fc::microseconds> > > > > potential_peer_set;
 
     private:
       potential_peer_set     _potential_peer_set;
       fc::path _peer_database_filename;
+      std::ofstream          _log;
+      uint32_t               _log_entries_since_compaction = 0;
+      uint32_t               _log_entry_count = 0;
+
+      void replay_log();
+      void import_legacy_json(const fc::path& json_filename);
+      void prune_to_maximum_size();
+      void append_to_log(const peer_database_log_entry& entry);
+      void compact();
 
     public:
+      ~peer_database_impl();
       void open(const fc::path& databaseFilename);
       void close();
       void clear();
@@ -69,6 +124,7 @@ namespace graphene { namespace net {
       void update_entry(const potential_peer_record& updatedRecord);
       potential_peer_record lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
       fc::optional<potential_peer_record> lookup_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
+      std::vector<potential_peer_record> get_connection_candidates() const;
 
       peer_database::iterator begin() const;
       peer_database::iterator end() const;
@@ -87,62 +143,204 @@ namespace graphene { namespace net {
     peer_database_iterator::peer_database_iterator( const peer_database_iterator& c ) :
       boost::iterator_facade<peer_database_iterator, const potential_peer_record, boost::forward_traversal_tag>(c){}
 
+    peer_database_impl::~peer_database_impl()
+    {
+      if (_log.is_open())
+        _log.close();
+    }
+
     void peer_database_impl::open(const fc::path& peer_database_filename)
     {
       _peer_database_filename = peer_database_filename;
       if (fc::exists(_peer_database_filename))
+        replay_log();
+      else
       {
-        try
+        // nodes upgraded from the JSON format keep their peers
+        fc::path legacy_filename = _peer_database_filename;
+        legacy_filename.replace_extension(".json");
+        if (fc::exists(legacy_filename))
+          import_legacy_json(legacy_filename);
+      }
+      prune_to_maximum_size();
+
+      // start every session from a compacted log so replay time stays proportional to the live set
+      compact();
+    }
+
+    void peer_database_impl::replay_log()
+    {
+      try
+      {
+        std::vector<char> log_data(fc::file_size(_peer_database_filename));
         {
-          std::vector<potential_peer_record> peer_records = fc::json::from_file(_peer_database_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
-          std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
-          if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
-          {
-            // prune database to a reasonable size
-            auto iter = _potential_peer_set.begin();
-            std::advance(iter, MAXIMUM_PEERDB_SIZE);
-            _potential_peer_set.erase(iter, _potential_peer_set.end());
-          }
+          std::ifstream in(_peer_database_filename.generic_string().c_str(), std::ios::binary);
+          in.read(log_data.data(), log_data.size());
+          log_data.resize(in.gcount());
         }
-        catch (const fc::exception& e)
+
+        fc::datastream<const char*> ds(log_data.data(), log_data.size());
+        while (ds.remaining() > 0)
         {
-          elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
-               ("peer_database_filename", _peer_database_filename));
+          peer_database_log_entry entry;
+          potential_peer_record record;
+          try
+          {
+            fc::raw::unpack(ds, entry);
+            if (entry.type == peer_database_log_erase)
+            {
+              fc::ip::endpoint endpoint_to_erase = fc::raw::unpack<fc::ip::endpoint>(entry.data);
+              _potential_peer_set.get<endpoint_index>().erase(endpoint_to_erase);
+              continue;
+            }
+            record = fc::raw::unpack<potential_peer_record>(entry.data);
+          }
+          catch (const fc::exception& e)
+          {
+            // a partially written entry at the tail means we crashed mid-append; everything before it is good
+            wlog("discarding ${bytes} trailing bytes of peer database file ${peer_database_filename}",
+                 ("bytes", ds.remaining())("peer_database_filename", _peer_database_filename));
+            break;
+          }
+          auto iter = _potential_peer_set.get<endpoint_index>().find(record.endpoint);
+          if (iter != _potential_peer_set.get<endpoint_index>().end())
+            _potential_peer_set.get<endpoint_index>().replace(iter, record);
+          else
+            _potential_peer_set.get<endpoint_index>().insert(record);
         }
       }
+      catch (const fc::exception& e)
+      {
+        elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
+             ("peer_database_filename", _peer_database_filename));
+        _potential_peer_set.clear();
+      }
     }
 
-    void peer_database_impl::close()
+    void peer_database_impl::import_legacy_json(const fc::path& json_filename)
     {
-      std::vector<potential_peer_record> peer_records;
-      peer_records.reserve(_potential_peer_set.size());
-      std::copy(_potential_peer_set.begin(), _potential_peer_set.end(), std::back_inserter(peer_records));
+      try
+      {
+        std::vector<potential_peer_record> peer_records = fc::json::from_file(json_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
+        ilog("imported ${count} peers from legacy peer database ${filename}", ("count", _potential_peer_set.size())("filename", json_filename));
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error importing legacy peer database file ${filename}, starting with a clean database", 
+             ("filename", json_filename));
+      }
+    }
 
+    void peer_database_impl::prune_to_maximum_size()
+    {
+      if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+      {
+        // prune database to a reasonable size, dropping the least promising peers
+        auto& score_index = _potential_peer_set.get<connection_score_index>();
+        auto iter = score_index.begin();
+        std::advance(iter, MAXIMUM_PEERDB_SIZE);
+        score_index.erase(iter, score_index.end());
+      }
+    }
+
+    void peer_database_impl::append_to_log(const peer_database_log_entry& entry)
+    {
+      if (!_log.is_open())
+        return;
+      try
+      {
+        std::vector<char> packed_entry = fc::raw::pack(entry);
+        _log.write(packed_entry.data(), packed_entry.size());
+        _log.flush();
+        ++_log_entry_count;
+        ++_log_entries_since_compaction;
+      }
+      catch (const std::exception& e)
+      {
+        elog("error appending to peer database file ${peer_database_filename}: ${e}", 
+             ("peer_database_filename", _peer_database_filename)("e", e.what()));
+      }
+
+      if (_log_entries_since_compaction >= GRAPHENE_NET_PEER_DATABASE_COMPACTION_THRESHOLD &&
+          _log_entry_count > _potential_peer_set.size())
+        compact();
+    }
+
+    void peer_database_impl::compact()
+    {
+      if (_peer_database_filename.generic_string().empty())
+        return;
+      if (_log.is_open())
+        _log.close();
+
+      fc::path temp_filename = _peer_database_filename;
+      temp_filename.replace_extension(".tmp");
       try
       {
         fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
         if (!fc::exists(peer_database_filename_dir))
           fc::create_directories(peer_database_filename_dir);
-        fc::json::save_to_file( peer_records, _peer_database_filename, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+
+        {
+          std::ofstream out(temp_filename.generic_string().c_str(), std::ios::binary | std::ios::trunc);
+          out.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+          for (const potential_peer_record& record : _potential_peer_set)
+          {
+            peer_database_log_entry entry;
+            entry.data = fc::raw::pack(record);
+            std::vector<char> packed_entry = fc::raw::pack(entry);
+            out.write(packed_entry.data(), packed_entry.size());
+          }
+          out.flush();
+        }
+        fc::rename(temp_filename, _peer_database_filename);
+        _log_entry_count = _potential_peer_set.size();
+        _log_entries_since_compaction = 0;
       }
       catch (const fc::exception& e)
       {
-        elog("error saving peer database to file ${peer_database_filename}", 
-             ("peer_database_filename", _peer_database_filename));
+        elog("error compacting peer database file ${peer_database_filename}: ${e}", 
+             ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
       }
+      catch (const std::exception& e)
+      {
+        elog("error compacting peer database file ${peer_database_filename}: ${e}", 
+             ("peer_database_filename", _peer_database_filename)("e", e.what()));
+      }
+
+      _log.open(_peer_database_filename.generic_string().c_str(), std::ios::binary | std::ios::app);
+      if (!_log)
+        elog("unable to open peer database file ${peer_database_filename} for writing, peer updates will not be persisted", 
+             ("peer_database_filename", _peer_database_filename));
+    }
+
+    void peer_database_impl::close()
+    {
+      compact();
+      if (_log.is_open())
+        _log.close();
       _potential_peer_set.clear();
     }
 
     void peer_database_impl::clear()
     {
       _potential_peer_set.clear();
+      compact();
     }
 
     void peer_database_impl::erase(const fc::ip::endpoint& endpointToErase)
     {
       auto iter = _potential_peer_set.get<endpoint_index>().find(endpointToErase);
       if (iter != _potential_peer_set.get<endpoint_index>().end())
+      {
         _potential_peer_set.get<endpoint_index>().erase(iter);
+
+        peer_database_log_entry entry;
+        entry.type = peer_database_log_erase;
+        entry.data = fc::raw::pack(endpointToErase);
+        append_to_log(entry);
+      }
     }
 
     void peer_database_impl::update_entry(const potential_peer_record& updatedRecord)
@@ -152,6 +350,10 @@ namespace graphene { namespace net {
         _potential_peer_set.get<endpoint_index>().modify(iter, [&updatedRecord](potential_peer_record& record) { record = updatedRecord; });
       else
         _potential_peer_set.get<endpoint_index>().insert(updatedRecord);
+
+      peer_database_log_entry entry;
+      entry.data = fc::raw::pack(updatedRecord);
+      append_to_log(entry);
     }
 
     potential_peer_record peer_database_impl::lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup)
@@ -170,6 +372,12 @@ namespace graphene { namespace net {
       return fc::optional<potential_peer_record>();
     }
 
+    std::vector<potential_peer_record> peer_database_impl::get_connection_candidates() const
+    {
+      const auto& score_index = _potential_peer_set.get<connection_score_index>();
+      return std::vector<potential_peer_record>(score_index.begin(), score_index.end());
+    }
+
     peer_database::iterator peer_database_impl::begin() const
     {
       return peer_database::iterator(new peer_database_iterator_impl(_potential_peer_set.get<last_seen_time_index>().begin()));
@@ -258,6 +466,11 @@ namespace graphene { namespace net {
     return my->lookup_entry_for_endpoint(endpoint_to_lookup);
   }
 
+  std::vector<potential_peer_record> peer_database::get_connection_candidates() const
+  {
+    return my->get_connection_candidates();
+  }
+
   peer_database::iterator peer_database::begin() const
   {
     return my->begin();
@@ -63,6 +63,22 @@ class account_history_plugin_impl
 
       account_history_plugin& _self;
       flat_set<account_id_type> _tracked_accounts;
+      history_retention _retention;
+      history_store _store;
+      /// Upper bound on operations moved to the history store per applied block
+      uint32_t _max_moves_per_block = 10000;
+
+   private:
+      /** links a new history node for the account in front of its most recent one */
+      void add_account_history( const account_id_type account_id, const operation_history_object& oho );
+      /** drops the oldest nodes of the account above the per account limit */
+      void prune_account_history( const account_id_type account_id, uint32_t newest_sequence );
+      /** drops operations (and the nodes pointing to them) that fell out of the block window */
+      void prune_old_operations( uint32_t head_block_num );
+      void remove_account_history_node( const account_transaction_history_object& node );
+      void remove_operation_if_orphaned( const operation_history_id_type op_id );
+      /** appends irreversible operations to the history store and drops them from the object database */
+      void move_irreversible_history();
 };
 
 account_history_plugin_impl::~account_history_plugin_impl()
@@ -137,44 +153,159 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
       // for each operation this account applies to that is in the config link it into the history
       if( _tracked_accounts.size() == 0 )
       {
+         // we don't do index_account_keys here anymore, because
+         // that indexing now happens in observers' post_evaluate()
          for( auto& account_id : impacted )
-         {
-            // we don't do index_account_keys here anymore, because
-            // that indexing now happens in observers' post_evaluate()
-
-            // add history
-            const auto& stats_obj = account_id(db).statistics(db);
-            const auto& ath = db.create<account_transaction_history_object>( [&]( account_transaction_history_object& obj ){
-                obj.operation_id = oho_valid_pair.first.id;
-                obj.account = account_id;
-                obj.sequence = stats_obj.total_ops+1;
-                obj.next = stats_obj.most_recent_op;
-            });
-            db.modify( stats_obj, [&]( account_statistics_object& obj ){
-                obj.most_recent_op = ath.id;
-                obj.total_ops = ath.sequence;
-            });
-         }
+            add_account_history( account_id, oho_valid_pair.first );
       }
       else
       {
          for( auto account_id : _tracked_accounts )
          {
             if( impacted.find( account_id ) != impacted.end() )
-            {
-               // add history
-               const auto& stats_obj = account_id(db).statistics(db);
-               const auto& ath = db.create<account_transaction_history_object>( [&]( account_transaction_history_object& obj ){
-                   obj.operation_id = oho_valid_pair.first.id;
-                   obj.next = stats_obj.most_recent_op;
-               });
-               db.modify( stats_obj, [&]( account_statistics_object& obj ){
-                   obj.most_recent_op = ath.id;
-               });
-            }
+               add_account_history( account_id, oho_valid_pair.first );
          }
       }
    }
+
+   if( _retention.max_age_blocks > 0 )
+      prune_old_operations( b.block_num() );
+
+   if( _store.is_open() )
+      move_irreversible_history();
+}
+
+void account_history_plugin_impl::add_account_history( const account_id_type account_id, const operation_history_object& oho )
+{
+   graphene::chain::database& db = database();
+   const auto& stats_obj = account_id(db).statistics(db);
+   const auto& ath = db.create<account_transaction_history_object>( [&]( account_transaction_history_object& obj ){
+       obj.operation_id = oho.id;
+       obj.account = account_id;
+       obj.sequence = stats_obj.total_ops+1;
+       obj.next = stats_obj.most_recent_op;
+       obj.operation_type = oho.op.which();
+   });
+   db.modify( stats_obj, [&]( account_statistics_object& obj ){
+       obj.most_recent_op = ath.id;
+       obj.total_ops = ath.sequence;
+   });
+
+   if( _retention.max_ops_per_account > 0 && ath.sequence > _retention.max_ops_per_account )
+      prune_account_history( account_id, ath.sequence );
+}
+
+void account_history_plugin_impl::prune_account_history( const account_id_type account_id, uint32_t newest_sequence )
+{
+   graphene::chain::database& db = database();
+   const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+   const uint32_t oldest_kept = newest_sequence - _retention.max_ops_per_account + 1;
+
+   // normally this removes exactly one node, more only right after the limit was lowered
+   auto itr = by_seq_idx.lower_bound( boost::make_tuple( account_id, 0 ) );
+   while( itr != by_seq_idx.end() && itr->account == account_id && itr->sequence < oldest_kept )
+   {
+      const operation_history_id_type op_id = itr->operation_id;
+      remove_account_history_node( *itr );
+      remove_operation_if_orphaned( op_id );
+      itr = by_seq_idx.lower_bound( boost::make_tuple( account_id, 0 ) );
+   }
+}
+
+void account_history_plugin_impl::prune_old_operations( uint32_t head_block_num )
+{
+   if( head_block_num <= _retention.max_age_blocks )
+      return;
+   const uint32_t oldest_kept_block = head_block_num - _retention.max_age_blocks;
+
+   graphene::chain::database& db = database();
+   const auto& by_blnum_idx = db.get_index_type<operation_history_index>().indices().get<by_blnum>();
+   const auto& by_opid_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_opid>();
+
+   // bounded per block so catching up after enabling the window does not stall a single block
+   uint32_t removed = 0;
+   auto itr = by_blnum_idx.begin();
+   while( itr != by_blnum_idx.end() && itr->block_num < oldest_kept_block && removed < _retention.max_removals_per_block )
+   {
+      const operation_history_id_type op_id = itr->id;
+      auto node_itr = by_opid_idx.find( op_id );
+      while( node_itr != by_opid_idx.end() )
+      {
+         remove_account_history_node( *node_itr );
+         node_itr = by_opid_idx.find( op_id );
+      }
+      db.remove( *itr );
+      ++removed;
+      itr = by_blnum_idx.begin();
+   }
+}
+
+void account_history_plugin_impl::remove_account_history_node( const account_transaction_history_object& node )
+{
+   graphene::chain::database& db = database();
+   const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+   const account_id_type account_id = node.account;
+   const account_transaction_history_id_type node_id = node.id;
+   const account_transaction_history_id_type older = node.next;
+
+   // unlink the node: whoever pointed at it now points at what it pointed at
+   auto newer = by_seq_idx.upper_bound( boost::make_tuple( account_id, node.sequence ) );
+   if( newer != by_seq_idx.end() && newer->account == account_id && newer->next == node_id )
+      db.modify( *newer, [&]( account_transaction_history_object& obj ){
+          obj.next = older;
+      });
+
+   const auto& stats_obj = account_id(db).statistics(db);
+   if( stats_obj.most_recent_op == node_id )
+      db.modify( stats_obj, [&]( account_statistics_object& obj ){
+          obj.most_recent_op = older;
+      });
+
+   db.remove( node );
+}
+
+void account_history_plugin_impl::remove_operation_if_orphaned( const operation_history_id_type op_id )
+{
+   graphene::chain::database& db = database();
+   const auto& by_opid_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_opid>();
+   if( by_opid_idx.find( op_id ) == by_opid_idx.end() )
+   {
+      const auto* oho = db.find( op_id );
+      if( oho != nullptr )
+         db.remove( *oho );
+   }
+}
+
+void account_history_plugin_impl::move_irreversible_history()
+{
+   graphene::chain::database& db = database();
+   const uint32_t last_irreversible_block = db.get_dynamic_global_properties().last_irreversible_block_num;
+   const auto& by_id_idx = db.get_index_type<operation_history_index>().indices().get<by_id>();
+   const auto& by_opid_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_opid>();
+
+   // operation ids grow with block numbers, so the irreversible operations are a prefix of the index
+   uint32_t moved = 0;
+   auto itr = by_id_idx.begin();
+   while( itr != by_id_idx.end() && itr->block_num <= last_irreversible_block && moved < _max_moves_per_block )
+   {
+      const operation_history_object& op = *itr;
+      vector<account_transaction_history_object> nodes;
+      for( auto node_itr = by_opid_idx.lower_bound( op.id );
+           node_itr != by_opid_idx.end() && node_itr->operation_id == op.id; ++node_itr )
+         nodes.push_back( *node_itr );
+
+      _store.append( op, nodes );
+
+      // the moved nodes are the oldest in memory, so unlinking them leaves the newer node
+      // of each account (or its statistics) pointing nowhere and the history continues on disk
+      for( const account_transaction_history_object& node : nodes )
+         remove_account_history_node( db.get<account_transaction_history_object>( node.id ) );
+      db.remove( op );
+      ++moved;
+      itr = by_id_idx.begin();
+   }
+   if( moved > 0 )
+      _store.flush();
 }
 } // end namespace detail
 
@@ -204,6 +335,11 @@ void account_history_plugin::plugin_set_program_options(
 {
    cli.add_options()
          ("track-account", boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(), "Account ID to track history for (may specify multiple times)")
+         ("max-ops-per-account", boost::program_options::value<uint32_t>(), "Maximum number of operations per account kept in history, 0 keeps all (0)")
+         ("history-max-age-blocks", boost::program_options::value<uint32_t>(), "Only keep operations from this many most recent blocks, 0 keeps all (0)")
+         ("history-prune-batch-size", boost::program_options::value<uint32_t>(), "Maximum number of old operations pruned per block (1000)")
+         ("history-backend", boost::program_options::value<std::string>()->default_value("memory"), "Where irreversible operations are kept: memory or disk")
+         ("history-dir", boost::program_options::value<boost::filesystem::path>(), "Directory of the disk history backend, relative to the data directory (account_history)")
          ;
    cfg.add(cli);
 }
@@ -215,15 +351,59 @@ void account_history_plugin::plugin_initialize(const boost::program_options::var
    database().add_index< primary_index< account_transaction_history_index > >();
 
    LOAD_VALUE_SET(options, "tracked-accounts", my->_tracked_accounts, graphene::chain::account_id_type);
+
+   if( options.count( "max-ops-per-account" ) )
+      my->_retention.max_ops_per_account = options["max-ops-per-account"].as<uint32_t>();
+   if( options.count( "history-max-age-blocks" ) )
+      my->_retention.max_age_blocks = options["history-max-age-blocks"].as<uint32_t>();
+   if( options.count( "history-prune-batch-size" ) )
+      my->_retention.max_removals_per_block = options["history-prune-batch-size"].as<uint32_t>();
+
+   if( options.count( "history-backend" ) )
+   {
+      const std::string backend = options["history-backend"].as<std::string>();
+      FC_ASSERT( backend == "memory" || backend == "disk", "Unknown history-backend ${b}", ("b", backend) );
+      if( backend == "disk" )
+      {
+         fc::path history_dir = app().data_dir() / "account_history";
+         if( options.count( "history-dir" ) )
+         {
+            history_dir = options["history-dir"].as<boost::filesystem::path>();
+            if( history_dir.is_relative() )
+               history_dir = app().data_dir() / history_dir;
+         }
+         my->_store.open( history_dir );
+      }
+   }
 }
 
 void account_history_plugin::plugin_startup()
 {
 }
 
+void account_history_plugin::plugin_shutdown()
+{
+   my->_store.close();
+}
+
 flat_set<account_id_type> account_history_plugin::tracked_accounts() const
 {
    return my->_tracked_accounts;
 }
 
+const history_store* account_history_plugin::get_history_store() const
+{
+   return my->_store.is_open() ? &my->_store : nullptr;
+}
+
+const history_retention& account_history_plugin::retention() const
+{
+   return my->_retention;
+}
+
+void account_history_plugin::set_retention( const history_retention& retention )
+{
+   my->_retention = retention;
+}
+
 } }
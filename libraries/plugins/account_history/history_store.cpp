@@ -0,0 +1,261 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/account_history/history_store.hpp>
+
+#include <fc/io/fstream.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/filesystem.hpp>
+
+namespace graphene { namespace account_history {
+
+struct operation_index_entry
+{
+   uint64_t position = 0;
+   uint32_t size = 0;
+};
+
+/** contents of the heads file, only trusted when record_count matches the accounts file */
+struct history_store_state
+{
+   uint64_t                                       record_count = 0;
+   optional<operation_history_id_type>            last_operation;
+   std::map<account_id_type, history_store_heads> heads;
+};
+
+} } // graphene::account_history
+
+FC_REFLECT( graphene::account_history::operation_index_entry, (position)(size) )
+FC_REFLECT( graphene::account_history::history_store_state, (record_count)(last_operation)(heads) )
+
+namespace graphene { namespace account_history {
+
+static void open_store_file( std::fstream& file, const fc::path& path )
+{
+   file.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   auto mode = std::fstream::binary | std::fstream::in | std::fstream::out;
+   if( !fc::exists( path ) )
+      mode |= std::fstream::trunc;
+   file.open( path.generic_string().c_str(), mode );
+}
+
+void history_store::open( const fc::path& dir )
+{ try {
+   fc::create_directories( dir );
+   _dir = dir;
+   open_store_file( _operations, dir / "operations" );
+   open_store_file( _operation_index, dir / "operations.index" );
+   open_store_file( _records, dir / "accounts" );
+
+   _records.seekg( 0, _records.end );
+   const uint64_t records_size = _records.tellg();
+   _record_count = records_size / sizeof(history_store_record);
+   load_heads();
+} FC_CAPTURE_AND_RETHROW( (dir) ) }
+
+bool history_store::is_open()const
+{
+   return _records.is_open();
+}
+
+void history_store::flush()
+{
+   std::lock_guard<std::mutex> lock( _stream_mutex );
+   _operations.flush();
+   _operation_index.flush();
+   _records.flush();
+}
+
+void history_store::close()
+{
+   if( !is_open() )
+      return;
+   flush();
+   save_heads();
+   _operations.close();
+   _operation_index.close();
+   _records.close();
+}
+
+void history_store::load_heads()
+{
+   const fc::path heads_file = _dir / "heads";
+   if( fc::exists( heads_file ) )
+   {
+      try
+      {
+         std::string data;
+         fc::read_file_contents( heads_file, data );
+         history_store_state state = fc::raw::unpack<history_store_state>( vector<char>( data.begin(), data.end() ) );
+         // the heads are written on close only, a count mismatch means we did not shut down cleanly
+         if( state.record_count == _record_count )
+         {
+            _last_operation = state.last_operation;
+            _heads = std::move( state.heads );
+            fc::remove( heads_file );
+            return;
+         }
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Unable to load account history heads, rebuilding: ${e}", ("e", e.to_detail_string()) );
+      }
+      fc::remove( heads_file );
+   }
+   rebuild_heads();
+}
+
+void history_store::rebuild_heads()
+{
+   ilog( "Rebuilding account history heads from ${n} records", ("n", _record_count) );
+   _heads.clear();
+   _last_operation.reset();
+
+   // the records of the newest operation may be incomplete, drop them so that operation is appended again
+   uint64_t keep = _record_count;
+   if( keep > 0 )
+   {
+      const uint64_t newest_operation = fetch_record( keep ).operation;
+      while( keep > 0 && fetch_record( keep ).operation == newest_operation )
+         --keep;
+   }
+   if( keep != _record_count )
+   {
+      _records.close();
+      fc::resize_file( _dir / "accounts", keep * sizeof(history_store_record) );
+      open_store_file( _records, _dir / "accounts" );
+      _record_count = keep;
+   }
+
+   _records.seekg( 0 );
+   history_store_record record;
+   for( uint64_t position = 1; position <= _record_count; ++position )
+   {
+      _records.read( (char*)&record, sizeof(record) );
+      history_store_heads& heads = _heads[ account_id_type( record.account ) ];
+      heads.newest = position;
+      heads.newest_of_type[ record.operation_type ] = position;
+      _last_operation = operation_history_id_type( record.operation );
+   }
+}
+
+void history_store::save_heads()
+{
+   history_store_state state;
+   state.record_count = _record_count;
+   state.last_operation = _last_operation;
+   state.heads = std::move( _heads );
+   const vector<char> data = fc::raw::pack( state );
+   std::ofstream out( (_dir / "heads").generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+   out.write( data.data(), data.size() );
+   _heads = std::move( state.heads );
+}
+
+void history_store::append( const operation_history_object& op, const vector<account_transaction_history_object>& nodes )
+{ try {
+   if( _last_operation.valid() && op.id.instance() <= _last_operation->instance.value )
+      return;
+
+   std::lock_guard<std::mutex> lock( _stream_mutex );
+   const vector<char> data = fc::raw::pack( op );
+   _operations.seekp( 0, _operations.end );
+   operation_index_entry entry;
+   entry.position = _operations.tellp();
+   entry.size = data.size();
+   _operations.write( data.data(), data.size() );
+   _operation_index.seekp( sizeof(entry) * int64_t( op.id.instance() ) );
+   _operation_index.write( (char*)&entry, sizeof(entry) );
+
+   _records.seekp( sizeof(history_store_record) * int64_t( _record_count ) );
+   for( const account_transaction_history_object& node : nodes )
+   {
+      history_store_heads& heads = _heads[ node.account ];
+      history_store_record record;
+      record.account = node.account.instance.value;
+      record.operation = op.id.instance();
+      record.previous = heads.newest;
+      record.sequence = node.sequence;
+      record.operation_type = node.operation_type;
+      auto type_itr = heads.newest_of_type.find( node.operation_type );
+      if( type_itr != heads.newest_of_type.end() )
+         record.previous_of_type = type_itr->second;
+      _records.write( (char*)&record, sizeof(record) );
+
+      ++_record_count;
+      heads.newest = _record_count;
+      heads.newest_of_type[ node.operation_type ] = _record_count;
+   }
+   _last_operation = op.id;
+} FC_CAPTURE_AND_RETHROW( (op.id) ) }
+
+optional<operation_history_id_type> history_store::last_operation()const
+{
+   return _last_operation;
+}
+
+optional<operation_history_object> history_store::fetch_operation( operation_history_id_type id )const
+{
+   std::lock_guard<std::mutex> lock( _stream_mutex );
+   operation_index_entry entry;
+   const int64_t index_position = sizeof(entry) * int64_t( id.instance.value );
+   _operation_index.seekg( 0, _operation_index.end );
+   if( _operation_index.tellg() < int64_t( index_position + sizeof(entry) ) )
+      return optional<operation_history_object>();
+
+   _operation_index.seekg( index_position );
+   _operation_index.read( (char*)&entry, sizeof(entry) );
+   if( entry.size == 0 )
+      return optional<operation_history_object>();
+
+   vector<char> data( entry.size );
+   _operations.seekg( entry.position );
+   _operations.read( data.data(), entry.size );
+   return fc::raw::unpack<operation_history_object>( data );
+}
+
+uint64_t history_store::newest_record( account_id_type account )const
+{
+   auto itr = _heads.find( account );
+   return itr == _heads.end() ? 0 : itr->second.newest;
+}
+
+uint64_t history_store::newest_record( account_id_type account, uint16_t operation_type )const
+{
+   auto itr = _heads.find( account );
+   if( itr == _heads.end() )
+      return 0;
+   auto type_itr = itr->second.newest_of_type.find( operation_type );
+   return type_itr == itr->second.newest_of_type.end() ? 0 : type_itr->second;
+}
+
+history_store_record history_store::fetch_record( uint64_t position )const
+{
+   FC_ASSERT( position > 0 && position <= _record_count, "Invalid account history record position ${p}", ("p", position) );
+   std::lock_guard<std::mutex> lock( _stream_mutex );
+   history_store_record record;
+   _records.seekg( sizeof(record) * int64_t( position - 1 ) );
+   _records.read( (char*)&record, sizeof(record) );
+   return record;
+}
+
+} } // graphene::account_history
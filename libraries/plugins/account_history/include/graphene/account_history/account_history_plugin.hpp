@@ -23,6 +23,8 @@
  */
 #pragma once
 
+#include <graphene/account_history/history_store.hpp>
+
 #include <graphene/app/plugin.hpp>
 #include <graphene/chain/database.hpp>
 
@@ -57,6 +59,20 @@ enum account_history_object_type
 };
 
 
+/**
+ * Limits on how much history is kept.  Pruning happens incrementally while blocks are applied;
+ * the most recent operations of every account stay reachable through the usual history calls.
+ */
+struct history_retention
+{
+   /// Oldest operations of an account beyond this count are unlinked, 0 keeps all
+   uint32_t max_ops_per_account = 0;
+   /// Operations older than this many blocks are removed, 0 keeps all
+   uint32_t max_age_blocks = 0;
+   /// Upper bound on operations removed by the block window per applied block
+   uint32_t max_removals_per_block = 1000;
+};
+
 namespace detail
 {
     class account_history_plugin_impl;
@@ -74,9 +90,16 @@ class account_history_plugin : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       virtual void plugin_initialize(const boost::program_options::variables_map& options) override;
       virtual void plugin_startup() override;
+      virtual void plugin_shutdown() override;
 
       flat_set<account_id_type> tracked_accounts()const;
 
+      /** irreversible history moved to disk, nullptr unless history-backend is "disk" */
+      const history_store* get_history_store()const;
+
+      const history_retention& retention()const;
+      void set_retention( const history_retention& retention );
+
       friend class detail::account_history_plugin_impl;
       std::unique_ptr<detail::account_history_plugin_impl> my;
 };
@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace graphene { namespace account_history {
+   using namespace chain;
+
+   /**
+    * Fixed size entry of the account history file, one per account_transaction_history_object
+    * that was moved to disk.  Positions are 1 based record numbers, 0 means "none".
+    */
+   struct history_store_record
+   {
+      uint64_t account = 0;           ///< instance of the account
+      uint64_t operation = 0;         ///< instance of the operation_history_object
+      uint64_t previous = 0;          ///< position of the account's previous record
+      uint64_t previous_of_type = 0;  ///< position of the account's previous record of the same operation type
+      uint32_t sequence = 0;
+      uint16_t operation_type = 0;
+      uint16_t reserved = 0;
+   };
+
+   /** newest record positions of one account, persisted so open() does not have to scan the record file */
+   struct history_store_heads
+   {
+      uint64_t                     newest = 0;
+      flat_map<uint16_t, uint64_t> newest_of_type;
+   };
+
+   /**
+    * Append only on-disk storage for irreversible account history.
+    *
+    * Three files live in the store directory:
+    *  - operations:       packed operation_history_objects
+    *  - operations.index: (position, size) of every operation, addressed by operation instance
+    *  - accounts:         history_store_record entries chained backwards per account and per
+    *                      account and operation type
+    *
+    * Only irreversible operations are appended, so nothing is ever removed.  Operations must be
+    * appended in ascending id order; appending an operation that is already stored is a no-op,
+    * which keeps replays and re-applied blocks harmless.
+    */
+   class history_store
+   {
+      public:
+         void open( const fc::path& dir );
+         bool is_open()const;
+         void flush();
+         void close();
+
+         /** stores the operation and the account history nodes pointing to it */
+         void append( const operation_history_object& op, const vector<account_transaction_history_object>& nodes );
+
+         /** id of the newest stored operation, or an invalid optional when the store is empty */
+         optional<operation_history_id_type> last_operation()const;
+         optional<operation_history_object>  fetch_operation( operation_history_id_type id )const;
+
+         /** position of the newest record of the account (of the given type), 0 if there is none */
+         uint64_t newest_record( account_id_type account )const;
+         uint64_t newest_record( account_id_type account, uint16_t operation_type )const;
+         history_store_record fetch_record( uint64_t position )const;
+         uint64_t record_count()const { return _record_count; }
+
+      private:
+         void load_heads();
+         void rebuild_heads();
+         void save_heads();
+
+         fc::path                                   _dir;
+         /// the streams are shared by all readers, which may be API worker threads
+         mutable std::mutex                         _stream_mutex;
+         mutable std::fstream                       _operations;
+         mutable std::fstream                       _operation_index;
+         mutable std::fstream                       _records;
+         uint64_t                                   _record_count = 0;
+         optional<operation_history_id_type>        _last_operation;
+         std::map<account_id_type, history_store_heads> _heads;
+   };
+
+} } // graphene::account_history
+
+FC_REFLECT( graphene::account_history::history_store_record,
+            (account)(operation)(previous)(previous_of_type)(sequence)(operation_type)(reserved) )
+FC_REFLECT( graphene::account_history::history_store_heads, (newest)(newest_of_type) )
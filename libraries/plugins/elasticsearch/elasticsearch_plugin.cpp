@@ -27,12 +27,46 @@
 #include <graphene/chain/account_evaluator.hpp>
 #include <curl/curl.h>
 #include <graphene/utilities/elasticsearch.hpp>
+#include <graphene/utilities/elasticsearch_exporter.hpp>
 
 namespace graphene { namespace elasticsearch {
 
 namespace detail
 {
 
+/**
+ * Operation data shared by the documents of every account impacted by one operation.  It is
+ * serialized lazily by whichever document the exporter thread builds first.
+ */
+struct pending_operation_history
+{
+   operation_history_object op;
+   bool operation_object = false;
+   bool serialized = false;
+   operation_history_struct os;
+
+   const operation_history_struct& get()
+   {
+      if( !serialized )
+      {
+         os.trx_in_block = op.trx_in_block;
+         os.op_in_trx = op.op_in_trx;
+         os.operation_result = fc::json::to_string(op.result);
+         os.virtual_op = op.virtual_op;
+
+         if(operation_object) {
+            op.op.visit(fc::from_static_variant(os.op_object, FC_PACK_MAX_DEPTH));
+            adaptor_struct adaptor;
+            os.op_object = adaptor.adapt(os.op_object.get_object());
+         }
+         else
+            os.op = fc::json::to_string(op.op);
+         serialized = true;
+      }
+      return os;
+   }
+};
+
 class elasticsearch_plugin_impl
 {
    public:
@@ -59,20 +93,19 @@ class elasticsearch_plugin_impl
       std::string _elasticsearch_index_prefix = "bitshares-";
       bool _elasticsearch_operation_object = false;
       uint32_t _elasticsearch_start_es_after_block = 0;
+      fc::path _elasticsearch_spool_dir;
+      uint32_t _elasticsearch_max_lag_blocks = 100;
       CURL *curl; // curl handler
-      vector <string> bulk_lines; //  vector of op lines
-      vector<std::string> prepare;
 
-      graphene::utilities::ES es;
+      std::unique_ptr<graphene::utilities::es_bulk_exporter> exporter;
       uint32_t limit_documents;
       int16_t op_type;
-      operation_history_struct os;
+      std::shared_ptr<pending_operation_history> os;
       block_struct bs;
       visitor_struct vs;
-      bulk_struct bulk_line_struct;
-      std::string bulk_line;
       std::string index_name;
       bool is_sync = false;
+      bool lag_reported = false;
    private:
       bool add_elasticsearch( const account_id_type account_id, const optional<operation_history_object>& oho, const uint32_t block_number );
       const account_transaction_history_object& addNewEntry(const account_statistics_object& stats_obj,
@@ -86,9 +119,8 @@ class elasticsearch_plugin_impl
       void doVisitor(const optional <operation_history_object>& oho);
       void checkState(const fc::time_point_sec& block_time);
       void cleanObjects(const account_transaction_history_id_type& ath, const account_id_type& account_id);
-      void createBulkLine(const account_transaction_history_object& ath);
-      void prepareBulk(const account_transaction_history_id_type& ath_id);
-      void populateESstruct();
+      bool queueDocument(const account_transaction_history_object& ath, const uint32_t block_number);
+      void checkLag();
 };
 
 elasticsearch_plugin_impl::~elasticsearch_plugin_impl()
@@ -168,25 +200,28 @@ bool elasticsearch_plugin_impl::update_account_histories( const signed_block& b
       }
    }
    // we send bulk at end of block when we are in sync for better real time client experience
-   if(is_sync)
-   {
-      populateESstruct();
-      if(es.bulk_lines.size() > 0)
-      {
-         prepare.clear();
-         if(!graphene::utilities::SendBulk(std::move(es)))
-            return false;
-         else
-            bulk_lines.clear();
-      }
-   }
-
-   if(bulk_lines.size() != limit_documents)
-      bulk_lines.reserve(limit_documents);
+   if(!exporter->end_block(b.block_num(), is_sync))
+      return false;
+   checkLag();
 
    return true;
 }
 
+void elasticsearch_plugin_impl::checkLag()
+{
+   const auto status = exporter->get_status();
+   if(status.lag_blocks > _elasticsearch_max_lag_blocks && is_sync && !lag_reported)
+   {
+      wlog("elasticsearch export is ${lag} blocks behind (last exported block ${exported}, ${spooled} batches spooled, "
+           "${held} held in memory, block application waited ${waited} ms for the export queue)",
+           ("lag", status.lag_blocks)("exported", status.last_exported_block)("spooled", status.spooled_batches)
+           ("held", status.held_batches)("waited", status.producer_wait_time.count() / 1000));
+      lag_reported = true;
+   }
+   else if(status.lag_blocks <= _elasticsearch_max_lag_blocks)
+      lag_reported = false;
+}
+
 void elasticsearch_plugin_impl::checkState(const fc::time_point_sec& block_time)
 {
    if((fc::time_point::now() - block_time) < fc::seconds(30))
@@ -199,6 +234,7 @@ void elasticsearch_plugin_impl::checkState(const fc::time_point_sec& block_time)
       limit_documents = _elasticsearch_bulk_replay;
       is_sync = false;
    }
+   exporter->set_max_batch_documents(limit_documents);
 }
 
 void elasticsearch_plugin_impl::getOperationType(const optional <operation_history_object>& oho)
@@ -209,19 +245,10 @@ void elasticsearch_plugin_impl::getOperationType(const optional <operation_histo
 
 void elasticsearch_plugin_impl::doOperationHistory(const optional <operation_history_object>& oho)
 {
-   os.trx_in_block = oho->trx_in_block;
-   os.op_in_trx = oho->op_in_trx;
-   os.operation_result = fc::json::to_string(oho->result);
-   os.virtual_op = oho->virtual_op;
-
-   if(_elasticsearch_operation_object) {
-      oho->op.visit(fc::from_static_variant(os.op_object, FC_PACK_MAX_DEPTH));
-      adaptor_struct adaptor;
-      os.op_object = adaptor.adapt(os.op_object.get_object());
-   }
-   else
-      os.op = fc::json::to_string(oho->op);
-
+   // serialization is deferred to the exporter thread
+   os = std::make_shared<pending_operation_history>();
+   os->op = *oho;
+   os->operation_object = _elasticsearch_operation_object;
 }
 
 void elasticsearch_plugin_impl::doBlock(uint32_t trx_in_block, const signed_block& b)
@@ -282,21 +309,10 @@ bool elasticsearch_plugin_impl::add_elasticsearch( const account_id_type account
    const auto &stats_obj = getStatsObject(account_id);
    const auto &ath = addNewEntry(stats_obj, account_id, oho);
    growStats(stats_obj, ath);
-   if(block_number > _elasticsearch_start_es_after_block)  {
-      createBulkLine(ath);
-      prepareBulk(ath.id);
-   }
+   if(block_number > _elasticsearch_start_es_after_block && !queueDocument(ath, block_number))
+      return false;
    cleanObjects(ath.id, account_id);
 
-   if (curl && bulk_lines.size() >= limit_documents) { // we are in bulk time, ready to add data to elasticsearech
-      prepare.clear();
-      populateESstruct();
-      if(!graphene::utilities::SendBulk(std::move(es)))
-         return false;
-      else
-         bulk_lines.clear();
-   }
-
    return true;
 }
 
@@ -318,6 +334,7 @@ const account_transaction_history_object& elasticsearch_plugin_impl::addNewEntry
       obj.account = account_id;
       obj.sequence = stats_obj.total_ops + 1;
       obj.next = stats_obj.most_recent_op;
+      obj.operation_type = oho->op.which();
    });
 
    return ath;
@@ -333,29 +350,27 @@ void elasticsearch_plugin_impl::growStats(const account_statistics_object& stats
    });
 }
 
-void elasticsearch_plugin_impl::createBulkLine(const account_transaction_history_object& ath)
+bool elasticsearch_plugin_impl::queueDocument(const account_transaction_history_object& ath, const uint32_t block_number)
 {
+   bulk_struct bulk_line_struct;
    bulk_line_struct.account_history = ath;
-   bulk_line_struct.operation_history = os;
    bulk_line_struct.operation_type = op_type;
    bulk_line_struct.operation_id_num = ath.operation_id.instance.value;
    bulk_line_struct.block_data = bs;
    if(_elasticsearch_visitor)
       bulk_line_struct.additional_data = vs;
-   bulk_line = fc::json::to_string(bulk_line_struct, fc::json::legacy_generator);
-}
 
-void elasticsearch_plugin_impl::prepareBulk(const account_transaction_history_id_type& ath_id)
-{
-   const std::string _id = fc::json::to_string(ath_id);
-   fc::mutable_variant_object bulk_header;
-   bulk_header["_index"] = index_name;
-   bulk_header["_type"] = "data";
-   bulk_header["_id"] = fc::to_string(ath_id.space_id) + "." + fc::to_string(ath_id.type_id) + "."
-                      + fc::to_string(ath_id.instance.value);
-   prepare = graphene::utilities::createBulk(bulk_header, std::move(bulk_line));
-   std::move(prepare.begin(), prepare.end(), std::back_inserter(bulk_lines));
-   prepare.clear();
+   graphene::utilities::es_bulk_exporter::document doc;
+   doc.index_name = index_name;
+   doc.id = fc::to_string(ath.id.space_id) + "." + fc::to_string(ath.id.type_id) + "."
+          + fc::to_string(ath.id.instance.value);
+   doc.block_num = block_number;
+   std::shared_ptr<pending_operation_history> operation_history = os;
+   doc.make_source = [bulk_line_struct, operation_history]() mutable {
+      bulk_line_struct.operation_history = operation_history->get();
+      return fc::json::to_string(bulk_line_struct, fc::json::legacy_generator);
+   };
+   return exporter->push(std::move(doc));
 }
 
 void elasticsearch_plugin_impl::cleanObjects(const account_transaction_history_id_type& ath_id, const account_id_type& account_id)
@@ -387,17 +402,6 @@ void elasticsearch_plugin_impl::cleanObjects(const account_transaction_history_i
    }
 }
 
-void elasticsearch_plugin_impl::populateESstruct()
-{
-   es.curl = curl;
-   es.bulk_lines = std::move(bulk_lines);
-   es.elasticsearch_url = _elasticsearch_node_url;
-   es.auth = _elasticsearch_basic_auth;
-   es.index_prefix = _elasticsearch_index_prefix;
-   es.endpoint = "";
-   es.query = "";
-}
-
 } // end namespace detail
 
 elasticsearch_plugin::elasticsearch_plugin() :
@@ -409,6 +413,12 @@ elasticsearch_plugin::~elasticsearch_plugin()
 {
 }
 
+graphene::utilities::es_bulk_exporter::status elasticsearch_plugin::get_export_status()const
+{
+   FC_ASSERT( my->exporter, "elasticsearch exporter is not running" );
+   return my->exporter->get_status();
+}
+
 std::string elasticsearch_plugin::plugin_name()const
 {
    return "elasticsearch";
@@ -432,6 +442,8 @@ void elasticsearch_plugin::plugin_set_program_options(
          ("elasticsearch-index-prefix", boost::program_options::value<std::string>(), "Add a prefix to the index(bitshares-)")
          ("elasticsearch-operation-object", boost::program_options::value<bool>(), "Save operation as object(false)")
          ("elasticsearch-start-es-after-block", boost::program_options::value<uint32_t>(), "Start doing ES job after block(0)")
+         ("elasticsearch-spool-dir", boost::program_options::value<boost::filesystem::path>(), "Directory where batches are kept while elasticsearch is unreachable(es_spool in data dir)")
+         ("elasticsearch-max-lag-blocks", boost::program_options::value<uint32_t>(), "Warn when export falls this many blocks behind the chain while in sync(100)")
          ;
    cfg.add(cli);
 }
@@ -470,6 +482,25 @@ void elasticsearch_plugin::plugin_initialize(const boost::program_options::varia
    if (options.count("elasticsearch-start-es-after-block")) {
       my->_elasticsearch_start_es_after_block = options["elasticsearch-start-es-after-block"].as<uint32_t>();
    }   
+   if (options.count("elasticsearch-spool-dir")) {
+      my->_elasticsearch_spool_dir = options["elasticsearch-spool-dir"].as<boost::filesystem::path>();
+      if (my->_elasticsearch_spool_dir.is_relative())
+         my->_elasticsearch_spool_dir = app().data_dir() / my->_elasticsearch_spool_dir;
+   }
+   else
+      my->_elasticsearch_spool_dir = app().data_dir() / "es_spool";
+   if (options.count("elasticsearch-max-lag-blocks")) {
+      my->_elasticsearch_max_lag_blocks = options["elasticsearch-max-lag-blocks"].as<uint32_t>();
+   }
+
+   graphene::utilities::es_bulk_exporter::options exporter_options;
+   exporter_options.elasticsearch_url = my->_elasticsearch_node_url;
+   exporter_options.auth = my->_elasticsearch_basic_auth;
+   exporter_options.spool_dir = my->_elasticsearch_spool_dir;
+   exporter_options.max_batch_documents = my->_elasticsearch_bulk_sync;
+   my->exporter.reset(new graphene::utilities::es_bulk_exporter(exporter_options));
+   // running before the replay, whose blocks would otherwise fill the queue with nothing to take them
+   my->exporter->start();
 }
 
 void elasticsearch_plugin::plugin_startup()
@@ -484,4 +515,10 @@ void elasticsearch_plugin::plugin_startup()
    ilog("elasticsearch ACCOUNT HISTORY: plugin_startup() begin");
 }
 
+void elasticsearch_plugin::plugin_shutdown()
+{
+   if (my->exporter)
+      my->exporter->stop();
+}
+
 } }
@@ -26,6 +26,7 @@
 #include <graphene/app/plugin.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/operation_history_object.hpp>
+#include <graphene/utilities/elasticsearch_exporter.hpp>
 
 namespace graphene { namespace elasticsearch {
    using namespace chain;
@@ -62,6 +63,10 @@ class elasticsearch_plugin : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       virtual void plugin_initialize(const boost::program_options::variables_map& options) override;
       virtual void plugin_startup() override;
+      virtual void plugin_shutdown() override;
+
+      /// Progress of the asynchronous exporter, including how many blocks it lags behind the chain
+      graphene::utilities::es_bulk_exporter::status get_export_status()const;
 
       friend class detail::elasticsearch_plugin_impl;
       std::unique_ptr<detail::elasticsearch_plugin_impl> my;
@@ -226,6 +226,9 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
    uint32_t slot = db.get_slot_at_time( now );
    if( slot == 0 )
    {
+      // check the pending transactions ahead of our slot, leaving only their application to it
+      if( _witnesses.find( db.get_scheduled_witness( 1 ) ) != _witnesses.end() )
+         db.prevalidate_pending_transactions();
       capture("next_time", db.get_slot_time(1));
       return block_production_condition::not_time_yet;
    }
@@ -0,0 +1,478 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/utilities/elasticsearch_exporter.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/variant_object.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace graphene { namespace utilities {
+
+es_bulk_exporter::es_bulk_exporter( const options& opts, sink_type sink )
+   : _options( opts ),
+     _sink( sink ),
+     _queue( opts.queue_capacity ),
+     _stopping( false ),
+     _max_batch_documents( opts.max_batch_documents ),
+     _last_queued_block( 0 ),
+     _last_exported_block( 0 ),
+     _exported_documents( 0 ),
+     _failed_attempts( 0 ),
+     _spooled_batches( 0 ),
+     _held_batch_count( 0 ),
+     _producer_waits( 0 ),
+     _producer_wait_us( 0 ),
+     _backlog_retry_delay( opts.initial_retry_delay )
+{
+   if( !_sink )
+      _sink = [this]( const std::string& body ) { return send_to_elasticsearch( body ); };
+   _options.max_held_batches = std::max<uint32_t>( _options.max_held_batches, 1 );
+}
+
+es_bulk_exporter::~es_bulk_exporter()
+{
+   try
+   {
+      stop();
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "error stopping elasticsearch exporter: ${e}", ("e", e.to_detail_string()) );
+   }
+   document* doc = nullptr;
+   while( _queue.pop( doc ) )
+      delete doc;
+}
+
+void es_bulk_exporter::start()
+{
+   FC_ASSERT( !_thread, "elasticsearch exporter already started" );
+   _stopping = false;
+   _thread.reset( new fc::thread( "elasticsearch_exporter" ) );
+   _done = _thread->async( [this]() { run(); }, "elasticsearch exporter loop" );
+}
+
+void es_bulk_exporter::stop()
+{
+   if( !_thread )
+      return;
+   _stopping = true;
+   _done.wait();
+   _thread->quit();
+   _thread.reset();
+}
+
+bool es_bulk_exporter::push( document&& doc )
+{
+   std::unique_ptr<document> queued( new document( std::move(doc) ) );
+   if( _queue.push( queued.get() ) )
+   {
+      queued.release();
+      return true;
+   }
+
+   // the exporter is too far behind; a document is never dropped, block application waits for it instead
+   if( !_thread || _stopping )
+   {
+      elog( "elasticsearch export queue is full and the exporter is not running, block ${b} cannot be exported",
+            ("b", queued->block_num) );
+      doc = std::move( *queued );
+      return false;
+   }
+   wlog( "elasticsearch export queue is full, waiting for the exporter at block ${b} (${h} batches held in memory, "
+         "${s} spooled)", ("b", queued->block_num)("h", _held_batch_count.load())("s", _spooled_batches.load()) );
+   const fc::time_point start = fc::time_point::now();
+   while( !_queue.push( queued.get() ) )
+      fc::usleep( fc::milliseconds(1) );
+   queued.release();
+   const fc::microseconds waited = fc::time_point::now() - start;
+   ++_producer_waits;
+   _producer_wait_us += waited.count();
+   ilog( "elasticsearch export queue accepts documents again after ${ms} ms", ("ms", waited.count() / 1000) );
+   return true;
+}
+
+bool es_bulk_exporter::end_block( uint32_t block_num, bool flush )
+{
+   document marker;
+   marker.block_num = block_num;
+   marker.end_of_block = true;
+   marker.flush = flush;
+   if( !push( std::move(marker) ) )
+      return false;
+   _last_queued_block = block_num;
+   return true;
+}
+
+void es_bulk_exporter::set_max_batch_documents( uint32_t max_batch_documents )
+{
+   _max_batch_documents = std::max<uint32_t>( max_batch_documents, 1 );
+}
+
+es_bulk_exporter::status es_bulk_exporter::get_status()const
+{
+   status result;
+   result.last_queued_block = _last_queued_block;
+   result.last_exported_block = _last_exported_block;
+   result.lag_blocks = result.last_queued_block > result.last_exported_block ?
+                       result.last_queued_block - result.last_exported_block : 0;
+   result.exported_documents = _exported_documents;
+   result.failed_attempts = _failed_attempts;
+   result.spooled_batches = _spooled_batches;
+   result.held_batches = _held_batch_count;
+   result.producer_waits = _producer_waits;
+   result.producer_wait_time = fc::microseconds( _producer_wait_us );
+   return result;
+}
+
+void es_bulk_exporter::run()
+{
+   _curl = curl_easy_init();
+   try
+   {
+      load_spool();
+   }
+   catch( const fc::exception& e )
+   {
+      // undeliverable batches are then held in memory
+      elog( "unable to open elasticsearch spool ${d}: ${e}", ("d", _options.spool_dir)("e", e.to_detail_string()) );
+   }
+   catch( const std::exception& e )
+   {
+      elog( "unable to open elasticsearch spool ${d}: ${e}", ("d", _options.spool_dir)("e", e.what()) );
+   }
+
+   pending_batch batch;
+   while( true )
+   {
+      // with too many batches held in memory stop taking documents, the queue fills up and push() waits
+      document* raw_doc = nullptr;
+      bool popped = _held_batches.size() < _options.max_held_batches && _queue.pop( raw_doc );
+      bool flush_now = false;
+      if( popped )
+      {
+         std::unique_ptr<document> doc( raw_doc );
+         if( doc->end_of_block )
+         {
+            batch.completed_block = doc->block_num;
+            flush_now = doc->flush;
+         }
+         else
+         {
+            fc::mutable_variant_object bulk_header;
+            bulk_header["_index"] = doc->index_name;
+            bulk_header["_type"] = "data";
+            bulk_header["_id"] = doc->id;
+            std::vector<std::string> lines = createBulk( bulk_header, doc->make_source() );
+            std::move( lines.begin(), lines.end(), std::back_inserter(batch.lines) );
+            if( batch.documents++ == 0 )
+               batch.first_document_time = fc::time_point::now();
+         }
+      }
+
+      if( batch.documents >= _max_batch_documents ||
+          ( batch.documents > 0 && fc::time_point::now() - batch.first_document_time >= _options.max_batch_delay ) ||
+          ( !popped && _stopping ) )
+         flush_now = true;
+
+      if( flush_now )
+         flush( batch );
+
+      if( !backlog_empty() && fc::time_point::now() >= _next_backlog_retry )
+         drain_backlog();
+
+      if( !popped )
+      {
+         if( _stopping )
+            break;
+         fc::usleep( fc::milliseconds(10) );
+      }
+   }
+
+   spool_held_batches();
+
+   if( _curl )
+   {
+      curl_easy_cleanup( _curl );
+      _curl = nullptr;
+   }
+}
+
+void es_bulk_exporter::flush( pending_batch& batch )
+{
+   if( batch.documents == 0 )
+   {
+      // nothing to send, the block counts as exported once the batches waiting before it are delivered
+      if( batch.completed_block > 0 )
+      {
+         if( backlog_empty() )
+            _last_exported_block = batch.completed_block;
+         else
+            _last_backlog_block = std::max( _last_backlog_block, batch.completed_block );
+      }
+      batch.completed_block = 0;
+      return;
+   }
+
+   std::string body = joinBulkLines( batch.lines );
+   if( !backlog_empty() )
+   {
+      // keep ordering: while older batches wait, new ones queue up behind them
+      hold_back( std::move(body), batch.documents, batch.completed_block );
+   }
+   else
+   {
+      fc::microseconds retry_delay = _options.initial_retry_delay;
+      bool delivered = false;
+      for( uint32_t attempt = 0; attempt <= _options.retries_before_spool && !delivered; ++attempt )
+      {
+         if( attempt > 0 )
+         {
+            fc::usleep( retry_delay );
+            retry_delay = std::min( retry_delay + retry_delay, _options.max_retry_delay );
+         }
+         delivered = deliver( body );
+      }
+
+      if( delivered )
+      {
+         _exported_documents += batch.documents;
+         if( batch.completed_block > 0 )
+            _last_exported_block = batch.completed_block;
+      }
+      else
+         hold_back( std::move(body), batch.documents, batch.completed_block );
+   }
+
+   batch = pending_batch();
+}
+
+bool es_bulk_exporter::deliver( const std::string& body )
+{
+   bool delivered = false;
+   try
+   {
+      delivered = _sink( body );
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "error sending bulk to elasticsearch: ${e}", ("e", e.to_detail_string()) );
+   }
+   catch( const std::exception& e )
+   {
+      elog( "error sending bulk to elasticsearch: ${e}", ("e", e.what()) );
+   }
+   if( !delivered )
+      ++_failed_attempts;
+   return delivered;
+}
+
+bool es_bulk_exporter::send_to_elasticsearch( const std::string& body )
+{
+   CurlRequest curl_request;
+   curl_request.handler = _curl;
+   curl_request.url = _options.elasticsearch_url + "_bulk";
+   curl_request.auth = _options.auth;
+   curl_request.type = "POST";
+   curl_request.query = body;
+
+   auto curl_response = doCurl( curl_request );
+   return handleBulkResponse( getResponseCode( curl_request.handler ), curl_response );
+}
+
+void es_bulk_exporter::hold_back( std::string&& body, uint32_t documents, uint32_t completed_block )
+{
+   if( backlog_empty() )
+   {
+      _next_backlog_retry = fc::time_point::now() + _options.initial_retry_delay;
+      _backlog_retry_delay = _options.initial_retry_delay;
+   }
+   _last_backlog_block = std::max( _last_backlog_block, completed_block );
+
+   // batches held in memory are older than anything spooled after them, so they keep the new ones in memory too
+   if( _held_batches.empty() && write_spool_file( body ) )
+      return;
+
+   held_batch held;
+   held.body = std::move(body);
+   held.documents = documents;
+   held.completed_block = completed_block;
+   _held_batches.push_back( std::move(held) );
+   _held_batch_count = _held_batches.size();
+}
+
+bool es_bulk_exporter::write_spool_file( const std::string& body )
+{
+   if( _options.spool_dir.generic_string().empty() )
+      return false;
+
+   std::ostringstream name;
+   name << std::setw(20) << std::setfill('0') << _next_spool_sequence++ << ".bulk";
+   fc::path spool_file = _options.spool_dir / name.str();
+   std::ofstream out( spool_file.generic_string().c_str(), std::ios::binary | std::ios::trunc );
+   out.write( body.data(), body.size() );
+   out.close();
+   if( !out )
+   {
+      elog( "unable to write elasticsearch spool file ${f}, keeping the batch in memory", ("f", spool_file) );
+      try
+      {
+         fc::remove( spool_file );
+      }
+      catch( const fc::exception& )
+      {
+      }
+      return false;
+   }
+
+   _spool_files.push_back( spool_file );
+   ++_spooled_batches;
+   return true;
+}
+
+void es_bulk_exporter::quarantine_spool_file( const fc::path& file, const std::string& reason )
+{
+   // set the file aside so that it neither blocks the spool nor gets lost
+   const fc::path bad_file( file.generic_string() + ".bad" );
+   elog( "unable to resend elasticsearch spool file ${f}, moving it to ${b}: ${e}", ("f", file)("b", bad_file)("e", reason) );
+   try
+   {
+      fc::rename( file, bad_file );
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "unable to move elasticsearch spool file ${f}: ${e}", ("f", file)("e", e.to_detail_string()) );
+   }
+}
+
+bool es_bulk_exporter::drain_backlog()
+{
+   while( !_spool_files.empty() )
+   {
+      const fc::path file = _spool_files.front();
+      std::string body;
+      try
+      {
+         fc::read_file_contents( file, body );
+      }
+      catch( const fc::exception& e )
+      {
+         quarantine_spool_file( file, e.to_detail_string() );
+         _spool_files.pop_front();
+         continue;
+      }
+      catch( const std::exception& e )
+      {
+         quarantine_spool_file( file, e.what() );
+         _spool_files.pop_front();
+         continue;
+      }
+
+      if( !deliver( body ) )
+      {
+         _next_backlog_retry = fc::time_point::now() + _backlog_retry_delay;
+         _backlog_retry_delay = std::min( _backlog_retry_delay + _backlog_retry_delay, _options.max_retry_delay );
+         return false;
+      }
+      try
+      {
+         fc::remove( file );
+      }
+      catch( const fc::exception& e )
+      {
+         quarantine_spool_file( file, e.to_detail_string() );
+      }
+      _spool_files.pop_front();
+      if( _stopping && !_spool_files.empty() )
+         return false;
+   }
+
+   while( !_held_batches.empty() )
+   {
+      held_batch& held = _held_batches.front();
+      if( !deliver( held.body ) )
+      {
+         _next_backlog_retry = fc::time_point::now() + _backlog_retry_delay;
+         _backlog_retry_delay = std::min( _backlog_retry_delay + _backlog_retry_delay, _options.max_retry_delay );
+         return false;
+      }
+      _exported_documents += held.documents;
+      if( held.completed_block > 0 )
+         _last_exported_block = std::max<uint32_t>( _last_exported_block, held.completed_block );
+      _held_batches.pop_front();
+      _held_batch_count = _held_batches.size();
+   }
+
+   ilog( "elasticsearch backlog drained" );
+   _backlog_retry_delay = _options.initial_retry_delay;
+   if( _last_backlog_block > 0 )
+      _last_exported_block = std::max<uint32_t>( _last_exported_block, _last_backlog_block );
+   _last_backlog_block = 0;
+   return true;
+}
+
+void es_bulk_exporter::load_spool()
+{
+   if( _options.spool_dir.generic_string().empty() )
+      return;
+   fc::create_directories( _options.spool_dir );
+
+   std::vector<fc::path> files;
+   for( fc::directory_iterator itr( _options.spool_dir ); itr != fc::directory_iterator(); ++itr )
+      if( (*itr).extension().generic_string() == ".bulk" )
+         files.push_back( *itr );
+   std::sort( files.begin(), files.end(), []( const fc::path& a, const fc::path& b ) {
+      return a.filename().generic_string() < b.filename().generic_string();
+   });
+
+   for( const fc::path& file : files )
+   {
+      _spool_files.push_back( file );
+      _next_spool_sequence = std::max<uint64_t>( _next_spool_sequence,
+                                                 std::stoull( file.stem().generic_string() ) + 1 );
+   }
+   if( !_spool_files.empty() )
+   {
+      ilog( "found ${n} spooled elasticsearch batches, resending", ("n", _spool_files.size()) );
+      _next_backlog_retry = fc::time_point::now();
+   }
+}
+
+void es_bulk_exporter::spool_held_batches()
+{
+   // on the way out, give batches still held in memory one more chance to reach the spool
+   while( !_held_batches.empty() && write_spool_file( _held_batches.front().body ) )
+      _held_batches.pop_front();
+   _held_batch_count = _held_batches.size();
+   if( !_held_batches.empty() )
+      elog( "${n} elasticsearch batches up to block ${b} were not delivered and are lost",
+            ("n", _held_batches.size())("b", _held_batches.back().completed_block) );
+}
+
+} } // end namespace graphene::utilities
@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <graphene/utilities/elasticsearch.hpp>
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/time.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace graphene { namespace utilities {
+
+   /**
+    * @brief Ships bulk documents to elasticsearch from a dedicated thread.
+    *
+    * The producer (the block applying thread) only pushes documents into a single producer / single consumer
+    * lock-free queue.  Serializing the documents, batching them by count or age, sending them, retrying with
+    * exponential backoff and spooling batches to disk while the sink is unavailable all happen on the exporter
+    * thread, so a slow or unreachable cluster does not stall block application while the backlog has room.  Batches
+    * that can be neither delivered nor spooled are held in memory; once max_held_batches are held the exporter stops
+    * taking documents and, when the queue fills up, push() waits for room rather than dropping a document.  The time
+    * the producer waited is reported in the status.
+    */
+   class es_bulk_exporter
+   {
+      public:
+         struct options
+         {
+            std::string      elasticsearch_url = "http://localhost:9200/";
+            std::string      auth;
+            /// Directory holding batches that could not be delivered; spooling is disabled if empty
+            fc::path         spool_dir;
+            uint32_t         max_batch_documents = 100;
+            fc::microseconds max_batch_delay = fc::seconds(1);
+            fc::microseconds initial_retry_delay = fc::milliseconds(100);
+            fc::microseconds max_retry_delay = fc::seconds(30);
+            /// Failed attempts on a batch before it is moved to the spool
+            uint32_t         retries_before_spool = 3;
+            /// Undelivered batches kept in memory when they cannot be spooled before the exporter stops taking more
+            uint32_t         max_held_batches = 64;
+            size_t           queue_capacity = 65536;
+         };
+
+         struct document
+         {
+            std::string                  index_name;
+            std::string                  id;
+            uint32_t                     block_num = 0;
+            /// Builds the document source, invoked on the exporter thread
+            std::function<std::string()> make_source;
+            /// Set on the marker pushed by end_block() rather than on real documents
+            bool                         end_of_block = false;
+            bool                         flush = false;
+         };
+
+         struct status
+         {
+            uint32_t last_queued_block = 0;
+            uint32_t last_exported_block = 0;
+            uint32_t lag_blocks = 0;
+            uint64_t exported_documents = 0;
+            uint64_t failed_attempts = 0;
+            uint64_t spooled_batches = 0;
+            uint32_t held_batches = 0;
+            /// Pushes that waited for room in the queue, and how long the producer waited in total
+            uint64_t producer_waits = 0;
+            fc::microseconds producer_wait_time;
+         };
+
+         /// Delivers one newline-delimited bulk body, returns false if it has to be retried
+         typedef std::function<bool(const std::string&)> sink_type;
+
+         explicit es_bulk_exporter( const options& opts, sink_type sink = sink_type() );
+         ~es_bulk_exporter();
+
+         void start();
+         /// Delivers (or spools) everything queued so far and stops the exporter thread
+         void stop();
+
+         /**
+          * Queues @p doc, waiting for room while the queue is full.  Returns false, leaving @p doc to the caller,
+          * only when the queue is full and the exporter is not running to make room.
+          */
+         bool push( document&& doc );
+         /// Marks that all documents of @p block_num have been pushed, the batch is flushed if @p flush is set
+         bool end_block( uint32_t block_num, bool flush );
+
+         void set_max_batch_documents( uint32_t max_batch_documents );
+         status get_status()const;
+
+      private:
+         struct pending_batch
+         {
+            std::vector<std::string> lines;
+            uint32_t                 documents = 0;
+            uint32_t                 completed_block = 0;
+            fc::time_point           first_document_time;
+         };
+
+         /// A batch that could not be delivered nor spooled, waiting in memory
+         struct held_batch
+         {
+            std::string body;
+            uint32_t    documents = 0;
+            uint32_t    completed_block = 0;
+         };
+
+         void run();
+         void flush( pending_batch& batch );
+         bool deliver( const std::string& body );
+         bool send_to_elasticsearch( const std::string& body );
+         bool backlog_empty()const { return _spool_files.empty() && _held_batches.empty(); }
+         /// Puts an undelivered batch behind the ones already waiting, on disk if possible
+         void hold_back( std::string&& body, uint32_t documents, uint32_t completed_block );
+         bool write_spool_file( const std::string& body );
+         void quarantine_spool_file( const fc::path& file, const std::string& reason );
+         bool drain_backlog();
+         void load_spool();
+         void spool_held_batches();
+
+         options                                      _options;
+         sink_type                                    _sink;
+         CURL*                                        _curl = nullptr;
+         boost::lockfree::spsc_queue<document*>       _queue;
+         std::unique_ptr<fc::thread>                  _thread;
+         fc::future<void>                             _done;
+         std::atomic<bool>                            _stopping;
+         std::atomic<uint32_t>                        _max_batch_documents;
+
+         std::atomic<uint32_t>                        _last_queued_block;
+         std::atomic<uint32_t>                        _last_exported_block;
+         std::atomic<uint64_t>                        _exported_documents;
+         std::atomic<uint64_t>                        _failed_attempts;
+         std::atomic<uint64_t>                        _spooled_batches;
+         std::atomic<uint32_t>                        _held_batch_count;
+         std::atomic<uint64_t>                        _producer_waits;
+         std::atomic<int64_t>                         _producer_wait_us;
+
+         // exporter thread only
+         std::deque<fc::path>                         _spool_files;
+         std::deque<held_batch>                       _held_batches;
+         uint64_t                                     _next_spool_sequence = 0;
+         uint32_t                                     _last_backlog_block = 0;
+         fc::time_point                               _next_backlog_retry;
+         fc::microseconds                             _backlog_retry_delay;
+   };
+
+} } // end namespace graphene::utilities
@@ -283,6 +283,16 @@ class wallet_api_impl;
        * @returns a suggested brain_key
        */
       static brain_key_info suggest_brain_key();
+
+      /** How many transactions of wallet_api::sign_and_broadcast_batch() are signed against one head block.
+       *
+       * They all expire 30 seconds after that block, so a window holds only as many as max_in_flight
+       * pipelined broadcasts send in a third of that time when each one takes round_trip.
+       * @param max_in_flight how many broadcasts may wait for the node at once
+       * @param round_trip how long one broadcast waits for the node
+       * @return the number of transactions of a window, at least max_in_flight and at most 1000
+       */
+      static size_t batch_window_size(uint32_t max_in_flight, fc::microseconds round_trip);
     };
 
 struct operation_detail {
@@ -291,6 +301,17 @@ struct operation_detail {
    operation_history_object op;
 };
 
+/// the outcome of one transaction of wallet_api::sign_and_broadcast_batch()
+struct batch_transaction_result {
+   uint32_t                     first_operation = 0;
+   uint32_t                     operation_count = 0;
+   transaction_id_type          id;
+   bool                         broadcast = false;
+   optional<string>             error;
+   /// set when the batch is not broadcast
+   optional<signed_transaction> transaction;
+};
+
 /**
  * This wallet assumes it is connected to the database server with a high-bandwidth, low-latency connection and
  * performs minimal caching. This API could be provided locally to be used by a web interface.
@@ -1569,6 +1590,25 @@ class wallet_api
 
       signed_transaction sign_transaction_with_keys(signed_transaction tx, std::vector<string> wif_keys, bool broadcast = false);
 
+      /** Signs, and optionally broadcasts, many operations at once.
+       *
+       * The operations are packed into transactions of operations_per_transaction each, with fees set
+       * by the wallet.  The accounts that must approve them are fetched in one call for the whole batch
+       * and the transactions are signed on all cores, a window of them at a time against the current head
+       * block.  Broadcasts are pipelined with at most max_in_flight of them waiting for the node and the
+       * window is sized from the measured round trip, so every transaction is sent before it expires.
+       * A transaction that fails does not stop the others.
+       * @param operations the operations to sign
+       * @param operations_per_transaction how many operations go into one transaction
+       * @param max_in_flight how many broadcasts may wait for the node at once
+       * @param broadcast true if you wish to broadcast the transactions
+       * @return the outcome of every transaction, in the order of the operations
+       */
+      vector<batch_transaction_result> sign_and_broadcast_batch(vector<operation> operations,
+                                                                uint32_t operations_per_transaction,
+                                                                uint32_t max_in_flight,
+                                                                bool broadcast = false);
+
       /** Returns an uninitialized object representing a given blockchain operation.
        *
        * This returns a default-initialized object of the given type; it can be used
@@ -2472,6 +2512,9 @@ FC_REFLECT_DERIVED( graphene::wallet::vesting_balance_object_with_info, (graphen
 FC_REFLECT( graphene::wallet::operation_detail,
             (memo)(description)(op) )
 
+FC_REFLECT( graphene::wallet::batch_transaction_result,
+            (first_operation)(operation_count)(id)(broadcast)(error)(transaction) )
+
 FC_API( graphene::wallet::wallet_api,
         (help)
         (gethelp)
@@ -2571,6 +2614,7 @@ FC_API( graphene::wallet::wallet_api,
         (serialize_transaction)
         (sign_transaction)
         (sign_transaction_with_keys)
+        (sign_and_broadcast_batch)
         (get_prototype_operation)
         (propose_parameter_change)
         (propose_fee_change)
@@ -23,12 +23,15 @@
  */
 #include <algorithm>
 #include <cctype>
+#include <deque>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <sstream>
 #include <string>
 #include <list>
+#include <thread>
 
 #include <boost/version.hpp>
 #include <boost/lexical_cast.hpp>
@@ -198,6 +201,15 @@ public:
    void operator()(const asset& a);
 };
 
+/// most transactions of a batch signed against one head block, fetched again for the next window
+const size_t batch_transactions_per_window = 1000;
+/// transactions of a batch expire this long after the head block of their window
+const uint32_t batch_expiration_seconds = 30;
+/// the broadcasts of a window end within this part of the expiration, the rest covers signing and block production
+const fc::microseconds batch_broadcast_budget = fc::seconds( batch_expiration_seconds / 3 );
+/// transactions of a batch window signed by each thread
+const size_t batch_transactions_per_shard = 16;
+
 struct fee_asset_id_visitor
 {
    typedef void result_type;
@@ -2699,32 +2711,8 @@ public:
          i++;
       }
 
-      flat_set<public_key_type> approving_key_set;
-      for( account_id_type& acct_id : req_active_approvals )
-      {
-         const auto it = approving_account_lut.find( acct_id );
-         if( it == approving_account_lut.end() )
-            continue;
-         const account_object* acct = it->second;
-         vector<public_key_type> v_approving_keys = acct->active.get_keys();
-         for( const public_key_type& approving_key : v_approving_keys )
-            approving_key_set.insert( approving_key );
-      }
-      for( account_id_type& acct_id : req_owner_approvals )
-      {
-         const auto it = approving_account_lut.find( acct_id );
-         if( it == approving_account_lut.end() )
-            continue;
-         const account_object* acct = it->second;
-         vector<public_key_type> v_approving_keys = acct->owner.get_keys();
-         for( const public_key_type& approving_key : v_approving_keys )
-            approving_key_set.insert( approving_key );
-      }
-      for( const authority& a : other_auths )
-      {
-         for( const auto& k : a.key_auths )
-            approving_key_set.insert( k.first );
-      }
+      flat_set<public_key_type> approving_key_set =
+            get_approving_keys( req_active_approvals, req_owner_approvals, other_auths, approving_account_lut );
 
       auto dyn_props = get_dynamic_global_properties();
       tx.set_reference_block( dyn_props.head_block_id );
@@ -2791,6 +2779,251 @@ public:
       return tx;
    }
 
+   /// the keys of the approving accounts found in approving_account_lut and those named by other_auths
+   flat_set<public_key_type> get_approving_keys( const flat_set<account_id_type>& req_active_approvals,
+                                                 const flat_set<account_id_type>& req_owner_approvals,
+                                                 const vector<authority>& other_auths,
+                                                 const flat_map<account_id_type, account_object*>& approving_account_lut )const
+   {
+      flat_set<public_key_type> approving_key_set;
+      for( const account_id_type& acct_id : req_active_approvals )
+      {
+         const auto it = approving_account_lut.find( acct_id );
+         if( it == approving_account_lut.end() )
+            continue;
+         const account_object* acct = it->second;
+         vector<public_key_type> v_approving_keys = acct->active.get_keys();
+         for( const public_key_type& approving_key : v_approving_keys )
+            approving_key_set.insert( approving_key );
+      }
+      for( const account_id_type& acct_id : req_owner_approvals )
+      {
+         const auto it = approving_account_lut.find( acct_id );
+         if( it == approving_account_lut.end() )
+            continue;
+         const account_object* acct = it->second;
+         vector<public_key_type> v_approving_keys = acct->owner.get_keys();
+         for( const public_key_type& approving_key : v_approving_keys )
+            approving_key_set.insert( approving_key );
+      }
+      for( const authority& a : other_auths )
+      {
+         for( const auto& k : a.key_auths )
+            approving_key_set.insert( k.first );
+      }
+      return approving_key_set;
+   }
+
+   vector<batch_transaction_result> sign_and_broadcast_batch( const vector<operation>& operations,
+                                                             uint32_t operations_per_transaction,
+                                                             uint32_t max_in_flight,
+                                                             bool broadcast )
+   {
+      FC_ASSERT( !self.is_locked() );
+      FC_ASSERT( operations_per_transaction > 0 );
+      FC_ASSERT( max_in_flight > 0 );
+
+      // one fetch of the fee schedule for the whole batch
+      auto global_props = _remote_db->get_global_properties();
+      fee_schedule& fees = *global_props.parameters.current_fees;
+      for( const auto& ext : global_props.parameters.extensions )
+         ext.visit( fee_asset_id_visitor{fees} );
+
+      vector<signed_transaction> trxs;
+      vector<batch_transaction_result> results;
+      vector<flat_set<account_id_type>> req_active_approvals;
+      vector<flat_set<account_id_type>> req_owner_approvals;
+      vector<vector<authority>> other_auths;
+      flat_set<account_id_type> all_approvals;
+      for( size_t first = 0; first < operations.size(); first += operations_per_transaction )
+      {
+         trxs.emplace_back();
+         results.emplace_back();
+         req_active_approvals.emplace_back();
+         req_owner_approvals.emplace_back();
+         other_auths.emplace_back();
+         signed_transaction& tx = trxs.back();
+         batch_transaction_result& result = results.back();
+         tx.operations.assign( operations.begin() + first,
+                               operations.begin() + std::min<size_t>( operations.size(), first + operations_per_transaction ) );
+         result.first_operation = first;
+         result.operation_count = tx.operations.size();
+         try
+         {
+            for( auto& op : tx.operations )
+               fees.set_fee( op );
+            tx.validate();
+            tx.get_required_authorities( req_active_approvals.back(), req_owner_approvals.back(), other_auths.back() );
+            for( const auto& auth : other_auths.back() )
+               for( const auto& a : auth.account_auths )
+                  req_active_approvals.back().insert( a.first );
+            all_approvals.insert( req_active_approvals.back().begin(), req_active_approvals.back().end() );
+            all_approvals.insert( req_owner_approvals.back().begin(), req_owner_approvals.back().end() );
+         }
+         catch( const fc::exception& e )
+         {
+            result.error = e.to_string();
+         }
+      }
+
+      // one fetch of the approving accounts for the whole batch
+      const vector<account_id_type> v_approving_account_ids( all_approvals.begin(), all_approvals.end() );
+      vector< optional<account_object> > approving_account_objects = _remote_db->get_accounts( v_approving_account_ids );
+      FC_ASSERT( approving_account_objects.size() == v_approving_account_ids.size() );
+      flat_map<account_id_type, account_object*> approving_account_lut;
+      for( optional<account_object>& approving_acct : approving_account_objects )
+         if( approving_acct.valid() )
+            approving_account_lut[ approving_acct->id ] = &(*approving_acct);
+
+      // the private keys of every transaction, each one decoded once
+      flat_map<public_key_type, fc::ecc::private_key> private_keys;
+      vector<vector<const fc::ecc::private_key*>> signing_keys( trxs.size() );
+      for( size_t i = 0; i < trxs.size(); ++i )
+      {
+         if( results[i].error )
+            continue;
+         // a key that cannot be decoded fails the transactions it would sign, not the batch
+         try
+         {
+            for( const public_key_type& key : get_approving_keys( req_active_approvals[i], req_owner_approvals[i],
+                                                                  other_auths[i], approving_account_lut ) )
+            {
+               auto known = private_keys.find( key );
+               if( known == private_keys.end() )
+               {
+                  auto it = _keys.find( key );
+                  if( it == _keys.end() )
+                     continue;
+                  fc::optional<fc::ecc::private_key> privkey = wif_to_key( it->second );
+                  FC_ASSERT( privkey.valid(), "Malformed private key in _keys" );
+                  known = private_keys.emplace( key, *privkey ).first;
+               }
+               signing_keys[i].push_back( &known->second );
+            }
+         }
+         catch( const fc::exception& e )
+         {
+            results[i].error = e.to_string();
+            signing_keys[i].clear();
+         }
+      }
+
+      // the transactions of a window refer to the same head block and expire together, the window only holds
+      // as many as the measured round trips let max_in_flight broadcasts send well before that
+      fc::microseconds broadcast_round_trip;
+      for( size_t begin = 0, end = 0; begin < trxs.size(); begin = end )
+      {
+         const fc::time_point fetch_start = fc::time_point::now();
+         auto dyn_props = get_dynamic_global_properties();
+         const fc::microseconds round_trip = std::max( fc::time_point::now() - fetch_start, broadcast_round_trip );
+         end = std::min( trxs.size(), begin + ( broadcast ? utility::batch_window_size( max_in_flight, round_trip )
+                                                          : batch_transactions_per_window ) );
+
+         expire_recently_generated_transactions( dyn_props.time - fc::minutes(2) );
+         for( size_t i = begin; i < end; ++i )
+         {
+            if( results[i].error )
+               continue;
+            signed_transaction& tx = trxs[i];
+            tx.set_reference_block( dyn_props.head_block_id );
+            // the id does not cover the signatures, so the expiration is settled before signing
+            for( uint32_t expiration_time_offset = 0; ; ++expiration_time_offset )
+            {
+               tx.set_expiration( dyn_props.time + fc::seconds(batch_expiration_seconds + expiration_time_offset) );
+               results[i].id = tx.id();
+               if( _recently_generated_transactions.find( results[i].id ) == _recently_generated_transactions.end() )
+                  break;
+            }
+            _recently_generated_transactions.insert( recently_generated_transaction_record( dyn_props.time, results[i].id ) );
+         }
+
+         // signing is the expensive part, every thread signs its own transactions and records their failures
+         auto sign_range = [&]( size_t first, size_t last ) {
+            for( size_t i = first; i < last; ++i )
+            {
+               if( results[i].error )
+                  continue;
+               try
+               {
+                  for( const fc::ecc::private_key* key : signing_keys[i] )
+                     trxs[i].sign( *key, _chain_id );
+               }
+               catch( const fc::exception& e )
+               {
+                  results[i].error = e.to_string();
+               }
+               catch( const std::exception& e )
+               {
+                  results[i].error = string( e.what() );
+               }
+            }
+         };
+         const size_t shard_count = std::min<size_t>( std::max( 1u, std::thread::hardware_concurrency() ),
+                                                      ( end - begin + batch_transactions_per_shard - 1 ) / batch_transactions_per_shard );
+         if( shard_count <= 1 )
+            sign_range( begin, end );
+         else
+         {
+            const size_t shard_size = ( end - begin + shard_count - 1 ) / shard_count;
+            vector<std::future<void>> shards;
+            for( size_t first = begin + shard_size; first < end; first += shard_size )
+               shards.push_back( std::async( std::launch::async, sign_range, first, std::min( first + shard_size, end ) ) );
+            sign_range( begin, begin + shard_size );
+            for( auto& shard : shards )
+               shard.get();
+         }
+
+         if( !broadcast )
+         {
+            for( size_t i = begin; i < end; ++i )
+               if( !results[i].error )
+                  results[i].transaction = trxs[i];
+            continue;
+         }
+
+         // at most max_in_flight broadcasts wait for the node, a rejected transaction does not stop the others
+         std::deque<std::pair<size_t, fc::future<void>>> in_flight;
+         auto finish_oldest = [&]() {
+            const size_t i = in_flight.front().first;
+            try
+            {
+               in_flight.front().second.wait();
+               results[i].broadcast = true;
+            }
+            catch( const fc::exception& e )
+            {
+               elog( "Caught exception while broadcasting tx ${id}: ${e}", ("id", results[i].id.str())("e", e.to_detail_string()) );
+               results[i].error = e.to_string();
+            }
+            in_flight.pop_front();
+         };
+         const fc::time_point broadcast_start = fc::time_point::now();
+         size_t sent = 0;
+         for( size_t i = begin; i < end; ++i )
+         {
+            if( results[i].error )
+               continue;
+            if( in_flight.size() >= max_in_flight )
+               finish_oldest();
+            in_flight.emplace_back( i, fc::async( [this, &trxs, i]() {
+               _remote_net_broadcast->broadcast_transaction( trxs[i] );
+            }, "Batch broadcast" ) );
+            ++sent;
+         }
+         while( !in_flight.empty() )
+            finish_oldest();
+
+         // up to max_in_flight broadcasts overlap, each of them took the elapsed time divided by the rounds
+         if( sent > 0 )
+         {
+            const int64_t rounds = ( sent + max_in_flight - 1 ) / max_in_flight;
+            broadcast_round_trip = fc::microseconds( ( fc::time_point::now() - broadcast_start ).count() / rounds );
+         }
+      }
+
+      return results;
+   }
+
    void expire_recently_generated_transactions(fc::time_point_sec oldest_time)
    {
        // Since transactions include the head block id, we just need the index for keeping transactions unique
@@ -4191,6 +4424,14 @@ namespace graphene { namespace wallet {
       result.pub_key = priv_key.get_public_key();
       return result;
     }
+
+    size_t utility::batch_window_size(uint32_t max_in_flight, fc::microseconds round_trip)
+    {
+      FC_ASSERT( max_in_flight > 0 );
+      // max_in_flight broadcasts complete every round trip, as many rounds as end within the budget
+      const int64_t rounds = std::max<int64_t>( 1, detail::batch_broadcast_budget.count() / std::max<int64_t>( 1, round_trip.count() ) );
+      return size_t( std::min<uint64_t>( uint64_t( rounds ) * max_in_flight, detail::batch_transactions_per_window ) );
+    }
   }}
 
 namespace graphene { namespace wallet {
@@ -4953,6 +5194,16 @@ signed_transaction wallet_api::sign_transaction(signed_transaction tx, bool broa
 
 } FC_CAPTURE_AND_RETHROW( (tx) ) }
 
+vector<batch_transaction_result> wallet_api::sign_and_broadcast_batch(vector<operation> operations,
+                                                                      uint32_t operations_per_transaction,
+                                                                      uint32_t max_in_flight,
+                                                                      bool broadcast /* = false */)
+{ try {
+
+   return my->sign_and_broadcast_batch(operations, operations_per_transaction, max_in_flight, broadcast);
+
+} FC_CAPTURE_AND_RETHROW( (operations_per_transaction)(max_in_flight) ) }
+
 signed_transaction wallet_api::sign_transaction_with_keys(signed_transaction tx, std::vector<string> wif_keys, bool broadcast /* = false */)
 { try {
 
@@ -0,0 +1,346 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/config.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <fc/crypto/hex.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+/*
+ * Replays a fixed range of an existing block log on top of a saved chain state and reports the throughput,
+ * the time per block and per phase of applying it, and digests of the state at checkpoints.  The digests are
+ * kept up to date while objects change, so the default of a checkpoint per block costs little.  The snapshot
+ * and the block log are only read, the replay runs in a separate work directory.
+ *
+ * To compare two builds on the same history, run the first with --output and the second with --expected
+ * pointing at that report; the second run fails at the first checkpoint where the states differ.
+ */
+
+using namespace graphene::chain;
+namespace bpo = boost::program_options;
+
+struct replay_checkpoint
+{
+   uint32_t                         block_num = 0;
+   std::string                      state_digest;
+   /// digest of every index by "space.type", to tell where two states differ, only on some checkpoints
+   std::map<std::string, std::string> index_digests;
+};
+
+struct replay_report
+{
+   uint32_t                         first_block = 0;
+   uint32_t                         last_block = 0;
+   uint32_t                         skip_flags = 0;
+   uint64_t                         transactions = 0;
+   uint64_t                         operations = 0;
+   int64_t                          elapsed_us = 0;
+   double                           blocks_per_sec = 0;
+   double                           ops_per_sec = 0;
+   int64_t                          block_p50_us = 0;
+   int64_t                          block_p99_us = 0;
+   int64_t                          block_max_us = 0;
+   std::vector<replay_checkpoint>   checkpoints;
+   apply_profile                    profile;
+};
+
+FC_REFLECT( replay_checkpoint, (block_num)(state_digest)(index_digests) )
+FC_REFLECT( replay_report, (first_block)(last_block)(skip_flags)(transactions)(operations)(elapsed_us)
+                           (blocks_per_sec)(ops_per_sec)(block_p50_us)(block_p99_us)(block_max_us)
+                           (checkpoints)(profile) )
+
+static const std::map<std::string, uint32_t> skip_flag_names = {
+   { "witness_signature",      database::skip_witness_signature },
+   { "transaction_signatures", database::skip_transaction_signatures },
+   { "transaction_dupe_check", database::skip_transaction_dupe_check },
+   { "block_size_check",       database::skip_block_size_check },
+   { "tapos_check",            database::skip_tapos_check },
+   { "authority_check",        database::skip_authority_check },
+   { "merkle_check",           database::skip_merkle_check },
+   { "assert_evaluation",      database::skip_assert_evaluation },
+   { "witness_schedule_check", database::skip_witness_schedule_check },
+   { "validate",               database::skip_validate }
+};
+
+static replay_checkpoint make_checkpoint( const database& db, bool with_indexes )
+{
+   replay_checkpoint result;
+   result.block_num = db.head_block_num();
+   result.state_digest = db.state_digest().str();
+   if( with_indexes )
+      db.inspect_all_indexes( [&]( const graphene::db::index& idx ) {
+         if( !db.covered_by_state_digest( idx.object_space_id(), idx.object_type_id() ) )
+            return;
+         const auto packed = fc::raw::pack( idx.state_digest() );
+         result.index_digests[ fc::to_string( idx.object_space_id() ) + "." + fc::to_string( idx.object_type_id() ) ]
+            = fc::to_hex( packed.data(), packed.size() );
+      } );
+   return result;
+}
+
+/// copies the saved chain state of a node data directory, leaving its blocks behind
+static void copy_snapshot( const boost::filesystem::path& snapshot, const boost::filesystem::path& work_dir )
+{
+   namespace bfs = boost::filesystem;
+   FC_ASSERT( bfs::exists( snapshot / "object_database" ), "${d} holds no saved chain state", ("d", snapshot.string()) );
+   bfs::copy_file( snapshot / "db_version", work_dir / "db_version" );
+   const std::string source = ( snapshot / "object_database" ).string();
+   for( bfs::recursive_directory_iterator it( source ), end; it != end; ++it )
+   {
+      const bfs::path target = work_dir / "object_database" / it->path().string().substr( source.size() + 1 );
+      if( bfs::is_directory( it->path() ) )
+         bfs::create_directories( target );
+      else
+      {
+         bfs::create_directories( target.parent_path() );
+         bfs::copy_file( it->path(), target );
+      }
+   }
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("Replay a range of blocks and report timings and state digests");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("blocks,b", bpo::value<boost::filesystem::path>(), "Node data directory (the blockchain directory) to read blocks from")
+            ("snapshot,s", bpo::value<boost::filesystem::path>(),
+             "Node data directory whose saved chain state the replay starts from, the genesis state when absent")
+            ("genesis-json,g", bpo::value<boost::filesystem::path>(), "File to read the genesis state from when starting without a snapshot")
+            ("work-dir,w", bpo::value<boost::filesystem::path>(), "Empty or missing directory the replay runs in, holds the state at the last block afterwards")
+            ("last-block,l", bpo::value<uint32_t>()->default_value(0), "Last block to replay, 0 replays to the end of the block log")
+            ("checkpoint-interval,c", bpo::value<uint32_t>()->default_value(1), "Blocks between state digests, the last block always gets one")
+            ("index-digest-interval", bpo::value<uint32_t>()->default_value(10000), "Blocks between checkpoints that list the digest of every index")
+            ("skip", bpo::value<std::vector<std::string>>()->multitoken(),
+             "Checks to skip, default: witness_signature transaction_signatures transaction_dupe_check tapos_check "
+             "witness_schedule_check authority_check as for --replay-blockchain; 'none' skips nothing")
+            ("expected,e", bpo::value<boost::filesystem::path>(), "Report of an earlier run whose state digests must match")
+            ("output,o", bpo::value<boost::filesystem::path>(), "File to write the report to, stdout by default")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "replay_checker:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 1;
+      }
+
+      if( !options.count("blocks") || !options.count("work-dir") )
+      {
+         std::cerr << "--blocks and --work-dir options are required\n";
+         return 1;
+      }
+      if( !options.count("snapshot") && !options.count("genesis-json") )
+      {
+         std::cerr << "either --snapshot or --genesis-json is required\n";
+         return 1;
+      }
+
+      uint32_t skip = database::skip_witness_signature |
+                      database::skip_transaction_signatures |
+                      database::skip_transaction_dupe_check |
+                      database::skip_tapos_check |
+                      database::skip_witness_schedule_check |
+                      database::skip_authority_check;
+      if( options.count("skip") )
+      {
+         skip = database::skip_nothing;
+         for( const std::string& name : options["skip"].as<std::vector<std::string>>() )
+         {
+            if( name == "none" )
+               continue;
+            const auto flag = skip_flag_names.find( name );
+            if( flag == skip_flag_names.end() )
+            {
+               std::cerr << "unknown check to skip: " << name << "\n";
+               return 1;
+            }
+            skip |= flag->second;
+         }
+      }
+
+      const boost::filesystem::path work_dir = options["work-dir"].as<boost::filesystem::path>();
+      if( boost::filesystem::exists( work_dir ) && !boost::filesystem::is_empty( work_dir ) )
+      {
+         std::cerr << "work directory " << work_dir.string() << " is not empty\n";
+         return 1;
+      }
+      boost::filesystem::create_directories( work_dir );
+      if( options.count("snapshot") )
+         copy_snapshot( options["snapshot"].as<boost::filesystem::path>(), work_dir );
+
+      block_database blocks;
+      blocks.open( fc::path( options["blocks"].as<boost::filesystem::path>() ) / "database" / "block_num_to_block" );
+      uint32_t last_block = options["last-block"].as<uint32_t>();
+      if( last_block == 0 )
+      {
+         const auto last_id = blocks.last_id();
+         FC_ASSERT( last_id.valid(), "the block log is empty" );
+         last_block = block_header::num_from_id( *last_id );
+      }
+
+      // without blocks of its own in the work directory, open() does not replay anything
+      database db;
+      db.track_state_digest( true );
+      db.open( work_dir, [&]() {
+         FC_ASSERT( !options.count("snapshot"), "the snapshot was saved by a build with another database version" );
+         std::string genesis_str;
+         fc::read_file_contents( options["genesis-json"].as<boost::filesystem::path>(), genesis_str );
+         genesis_state_type genesis = fc::json::from_string( genesis_str ).as<genesis_state_type>( 20 );
+         genesis.initial_chain_id = fc::sha256::hash( genesis_str );
+         return genesis;
+      }, GRAPHENE_CURRENT_DB_VERSION );
+      db._undo_db.disable();
+      db.get_apply_profiler().enable( true );
+
+      replay_report report;
+      report.first_block = db.head_block_num() + 1;
+      report.last_block = last_block;
+      report.skip_flags = skip;
+      FC_ASSERT( report.first_block <= last_block, "the state is already at block ${n}", ("n", db.head_block_num()) );
+
+      const uint32_t checkpoint_interval = std::max( 1u, options["checkpoint-interval"].as<uint32_t>() );
+      const uint32_t index_digest_interval = std::max( 1u, options["index-digest-interval"].as<uint32_t>() );
+      std::vector<int64_t> block_times;
+      block_times.reserve( last_block - report.first_block + 1 );
+      int64_t digest_us = 0;
+      const fc::time_point start = fc::time_point::now();
+      for( uint32_t num = report.first_block; num <= last_block; ++num )
+      {
+         const optional<signed_block> block = blocks.fetch_by_number( num );
+         FC_ASSERT( block.valid(), "block ${n} is missing from the block log", ("n", num) );
+
+         const fc::time_point block_start = fc::time_point::now();
+         db.apply_block( *block, skip );
+         block_times.push_back( ( fc::time_point::now() - block_start ).count() );
+
+         report.transactions += block->transactions.size();
+         for( const auto& trx : block->transactions )
+            report.operations += trx.operations.size();
+
+         const bool with_indexes = num % index_digest_interval == 0 || num == last_block;
+         if( with_indexes || num % checkpoint_interval == 0 )
+         {
+            const fc::time_point digest_start = fc::time_point::now();
+            report.checkpoints.push_back( make_checkpoint( db, with_indexes ) );
+            digest_us += ( fc::time_point::now() - digest_start ).count();
+            if( with_indexes )
+               std::cerr << "block " << num << " state " << report.checkpoints.back().state_digest << "\n";
+         }
+      }
+
+      // the digests are not part of the time it takes to apply the blocks
+      report.elapsed_us = std::max<int64_t>( 1, ( fc::time_point::now() - start ).count() - digest_us );
+      report.blocks_per_sec = double( block_times.size() ) * 1000000 / report.elapsed_us;
+      report.ops_per_sec = double( report.operations ) * 1000000 / report.elapsed_us;
+      std::sort( block_times.begin(), block_times.end() );
+      report.block_p50_us = block_times[ block_times.size() / 2 ];
+      report.block_p99_us = block_times[ std::min( block_times.size() - 1, block_times.size() * 99 / 100 ) ];
+      report.block_max_us = block_times.back();
+      report.profile = db.get_apply_profiler().get_profile();
+
+      if( options.count("output") )
+         fc::json::save_to_file( report, options["output"].as<boost::filesystem::path>() );
+      else
+         std::cout << fc::json::to_pretty_string( report ) << "\n";
+
+      int result = 0;
+      if( options.count("expected") )
+      {
+         const replay_report expected = fc::json::from_file( options["expected"].as<boost::filesystem::path>() ).as<replay_report>( 20 );
+         std::map<uint32_t, const replay_checkpoint*> expected_checkpoints;
+         for( const auto& cp : expected.checkpoints )
+            expected_checkpoints[cp.block_num] = &cp;
+
+         uint32_t compared = 0;
+         for( auto cp = report.checkpoints.begin(); cp != report.checkpoints.end(); ++cp )
+         {
+            const auto other = expected_checkpoints.find( cp->block_num );
+            if( other == expected_checkpoints.end() )
+               continue;
+            ++compared;
+            if( other->second->state_digest == cp->state_digest )
+               continue;
+
+            std::cerr << "state differs at block " << cp->block_num << "\n";
+            // name the indexes at the first checkpoint since which both reports list them
+            for( auto later = cp; later != report.checkpoints.end(); ++later )
+            {
+               const auto expected_later = expected_checkpoints.find( later->block_num );
+               if( later->index_digests.empty() || expected_later == expected_checkpoints.end()
+                   || expected_later->second->index_digests.empty() )
+                  continue;
+               for( const auto& idx : later->index_digests )
+               {
+                  const auto expected_idx = expected_later->second->index_digests.find( idx.first );
+                  if( expected_idx == expected_later->second->index_digests.end() || expected_idx->second != idx.second )
+                     std::cerr << "   index " << idx.first << " differs at block " << later->block_num << "\n";
+               }
+               break;
+            }
+            result = 2;
+            break;
+         }
+         if( !compared )
+         {
+            std::cerr << "no checkpoint in common with the expected report\n";
+            result = 2;
+         }
+         else if( !result )
+            std::cerr << compared << " checkpoints match\n";
+      }
+
+      db.close( false );
+      return result;
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+      return 1;
+   }
+}
@@ -0,0 +1,445 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/das33_object.hpp>
+#include <graphene/chain/protocol/daspay_operations.hpp>
+#include <graphene/chain/protocol/das33_operations.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "allocation_counter.hpp"
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+/**
+ * DasCoin workloads for tracking the cost of the apply path between releases.
+ *
+ * Every workload pushes its operations into the pending state in batches and then produces blocks; it
+ * reports operations per second of the push phase, p50/p99/max of the block production times (which
+ * include applying the block) and the heap allocations of both phases.  Runs are repeatable: the
+ * fixture starts from a fixed genesis and the only randomness, the committee votes of new accounts,
+ * comes from a fixed seed.
+ *
+ *   DASCOIN_BENCH_SCALE   multiplies the size of every workload, 1 by default
+ *   DASCOIN_BENCH_SEED    seed of the account votes, 1 by default
+ *   DASCOIN_BENCH_OUTPUT  file that receives one JSON object per workload, stdout when unset
+ *
+ * e.g. DASCOIN_BENCH_SCALE=10 DASCOIN_BENCH_OUTPUT=bench.jsonl chain_bench -t dascoin_workload_benchmarks
+ */
+
+namespace {
+
+struct bench_config
+{
+   uint32_t    scale = 1;
+   uint32_t    seed = 1;
+   std::string output;
+
+   static const bench_config& get()
+   {
+      static const bench_config config = []{
+         bench_config c;
+         if( const char* scale = std::getenv( "DASCOIN_BENCH_SCALE" ) )
+            c.scale = std::max( 1, std::atoi( scale ) );
+         if( const char* seed = std::getenv( "DASCOIN_BENCH_SEED" ) )
+            c.seed = std::atoi( seed );
+         if( const char* output = std::getenv( "DASCOIN_BENCH_OUTPUT" ) )
+            c.output = output;
+         return c;
+      }();
+      return config;
+   }
+};
+
+struct workload_report
+{
+   std::string workload;
+   uint32_t    scale = 0;
+   uint32_t    seed = 0;
+   uint64_t    ops = 0;
+   uint32_t    blocks = 0;
+   int64_t     push_us = 0;
+   double      ops_per_sec = 0;
+   int64_t     block_p50_us = 0;
+   int64_t     block_p99_us = 0;
+   int64_t     block_max_us = 0;
+   uint64_t    push_allocations = 0;
+   uint64_t    block_allocations = 0;
+};
+
+}
+
+FC_REFLECT( workload_report, (workload)(scale)(seed)(ops)(blocks)(push_us)(ops_per_sec)
+                             (block_p50_us)(block_p99_us)(block_max_us)(push_allocations)(block_allocations) )
+
+namespace {
+
+/// times the pushes and blocks of one workload and writes its report when done
+class workload_recorder
+{
+   public:
+      workload_recorder( database_fixture& fixture, const std::string& name )
+         : _fixture( fixture )
+      {
+         _report.workload = name;
+         _report.scale = bench_config::get().scale;
+         _report.seed = bench_config::get().seed;
+      }
+
+      /// pushes ops into the pending state, ops_per_trx to a transaction
+      void push( const vector<operation>& ops, size_t ops_per_trx = 50 )
+      {
+         database& db = _fixture.db;
+         const uint64_t allocations_before = allocations_so_far();
+         const fc::time_point start = fc::time_point::now();
+         for( size_t first = 0; first < ops.size(); first += ops_per_trx )
+         {
+            signed_transaction trx;
+            trx.set_reference_block( db.head_block_id() );
+            // distinct expirations keep batches with the same operations apart
+            trx.set_expiration( db.head_block_time() + fc::seconds( db.get_global_properties().parameters.block_interval
+                                                                    + _trx_in_block++ ) );
+            trx.operations.assign( ops.begin() + first, ops.begin() + std::min( ops.size(), first + ops_per_trx ) );
+            db.push_transaction( trx, ~0 );
+         }
+         _report.push_us += ( fc::time_point::now() - start ).count();
+         _report.push_allocations += allocations_so_far() - allocations_before;
+         _report.ops += ops.size();
+      }
+
+      /// produces and applies one block
+      void block()
+      {
+         const uint64_t allocations_before = allocations_so_far();
+         const fc::time_point start = fc::time_point::now();
+         _fixture.generate_block();
+         _block_times.push_back( ( fc::time_point::now() - start ).count() );
+         _report.block_allocations += allocations_so_far() - allocations_before;
+         _trx_in_block = 0;
+      }
+
+      /// produces blocks until the head block time reaches t
+      void blocks_until( fc::time_point_sec t )
+      {
+         while( _fixture.db.head_block_time() < t )
+            block();
+      }
+
+      ~workload_recorder()
+      {
+         _report.blocks = _block_times.size();
+         if( _report.push_us > 0 )
+            _report.ops_per_sec = double( _report.ops ) * 1000000 / _report.push_us;
+         if( !_block_times.empty() )
+         {
+            std::sort( _block_times.begin(), _block_times.end() );
+            _report.block_p50_us = _block_times[ _block_times.size() / 2 ];
+            _report.block_p99_us = _block_times[ std::min( _block_times.size() - 1, _block_times.size() * 99 / 100 ) ];
+            _report.block_max_us = _block_times.back();
+         }
+
+         const std::string line = fc::json::to_string( _report );
+         const std::string& output = bench_config::get().output;
+         if( output.empty() )
+            std::cout << line << std::endl;
+         else
+            std::ofstream( output, std::ios::app ) << line << std::endl;
+      }
+
+   private:
+      database_fixture&    _fixture;
+      workload_report      _report;
+      vector<int64_t>      _block_times;
+      uint32_t             _trx_in_block = 0;
+};
+
+uint32_t scaled( uint32_t n )
+{
+   return n * bench_config::get().scale;
+}
+
+}
+
+struct dascoin_workload_fixture : database_fixture
+{
+   dascoin_workload_fixture()
+   {
+      std::srand( bench_config::get().seed );
+   }
+
+   vector<account_id_type> create_vaults( const string& prefix, uint32_t count )
+   {
+      vector<account_id_type> vaults;
+      for( uint32_t i = 0; i < count; ++i )
+         vaults.push_back( create_new_vault_account( get_registrar_id(), prefix + fc::to_string( i ) ).id );
+      generate_block();
+      return vaults;
+   }
+
+   /// mints whole_coins DASC to a vault in one reward interval and moves them to its wallet
+   void fund_wallet_with_dascoin( account_id_type vault_id, account_id_type wallet_id, share_type whole_coins )
+   {
+      tether_accounts( wallet_id, vault_id );
+      adjust_dascoin_reward( whole_coins * DASCOIN_DEFAULT_ASSET_PRECISION );
+      issue_dascoin( vault_id, whole_coins );
+      disable_vault_to_wallet_limit( vault_id );
+      transfer_dascoin_vault_to_wallet( vault_id, wallet_id, whole_coins * DASCOIN_DEFAULT_ASSET_PRECISION );
+   }
+};
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_workload_benchmarks, dascoin_workload_fixture )
+
+BOOST_AUTO_TEST_CASE( account_creation_workload )
+{ try {
+   const uint32_t blocks = 10;
+   const uint32_t per_block = scaled( 100 );
+
+   workload_recorder recorder( *this, "vault_wallet_creation" );
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      vector<operation> ops;
+      for( uint32_t i = 0; i < per_block; ++i )
+      {
+         const string name = "acc" + fc::to_string( b ) + "x" + fc::to_string( i );
+         ops.push_back( make_account( i % 2 ? account_kind::vault : account_kind::wallet, get_registrar_id(), name ) );
+      }
+      recorder.push( ops );
+      recorder.block();
+   }
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( license_issuance_workload )
+{ try {
+   const uint32_t blocks = 10;
+   const uint32_t per_block = scaled( 50 );
+   const auto vaults = create_vaults( "vault", blocks * per_block );
+   const auto license = _dal.get_license_type( "standard_charter" )->id;
+
+   workload_recorder recorder( *this, "license_issuance" );
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      vector<operation> ops;
+      for( uint32_t i = 0; i < per_block; ++i )
+         ops.push_back( issue_license_operation( get_license_issuer_id(), vaults[ b * per_block + i ], license,
+                                                 10, 200, db.head_block_time() ) );
+      recorder.push( ops );
+      recorder.block();
+   }
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( cycle_submission_and_minting_workload )
+{ try {
+   const uint32_t blocks = 10;
+   const uint32_t per_block = scaled( 100 );
+   const auto vaults = create_vaults( "vault", scaled( 100 ) );
+
+   {
+      workload_recorder recorder( *this, "cycle_submission" );
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         vector<operation> ops;
+         for( uint32_t i = 0; i < per_block; ++i )
+            ops.push_back( submit_reserve_cycles_to_queue_operation( get_cycle_issuer_id(), vaults[ i % vaults.size() ],
+                                                                     200, 200, "" ) );
+         recorder.push( ops );
+         recorder.block();
+      }
+   }
+
+   // each reward interval mints from the queue filled above
+   adjust_dascoin_reward( 500 * DASCOIN_DEFAULT_ASSET_PRECISION );
+   adjust_frequency( 200 );
+   toggle_reward_queue( true );
+   {
+      workload_recorder recorder( *this, "minting_ticks" );
+      recorder.blocks_until( db.head_block_time() + fc::seconds( 10 * get_chain_parameters().reward_interval_time_seconds ) );
+   }
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( limit_order_matching_workload )
+{ try {
+   ACTORS((alicew)(bobw));
+   VAULT_ACTORS((alice)(bob));
+
+   const uint32_t blocks = 10;
+   const uint32_t pairs_per_block = scaled( 50 );
+   const share_type pairs = blocks * pairs_per_block;
+
+   tether_accounts( alicew_id, alice_id );
+   disable_vault_to_wallet_limit( alice_id );
+   issue_webasset( "1", alice_id, pairs * DASCOIN_FIAT_ASSET_PRECISION, 0 );
+   transfer_webasset_vault_to_wallet( alice_id, alicew_id, { pairs * DASCOIN_FIAT_ASSET_PRECISION, 0 } );
+   fund_wallet_with_dascoin( bob_id, bobw_id, pairs * 10 );
+
+   // every pair of orders crosses completely
+   const asset one_webeur{ 1 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id() };
+   const asset ten_dasc{ 10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id() };
+   workload_recorder recorder( *this, "limit_order_matching" );
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      vector<operation> ops;
+      for( uint32_t i = 0; i < pairs_per_block; ++i )
+      {
+         ops.push_back( limit_order_create_operation( alicew_id, one_webeur, ten_dasc, 0, {}, db.head_block_time() + fc::days( 1 ) ) );
+         ops.push_back( limit_order_create_operation( bobw_id, ten_dasc, one_webeur, 0, {}, db.head_block_time() + fc::days( 1 ) ) );
+      }
+      recorder.push( ops );
+      recorder.block();
+   }
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( daspay_payment_workload )
+{ try {
+   ACTORS((foo)(clearing)(payment));
+   VAULT_ACTOR(bar);
+
+   const uint32_t blocks = 10;
+   const uint32_t per_block = scaled( 50 );
+   const share_type payments = blocks * per_block;
+
+   // one payment of 1 WEBEUR costs 1 DASC plus the 2% ratio
+   fund_wallet_with_dascoin( bar_id, foo_id, payments * 2 );
+   do_op( reserve_asset_on_account_operation( foo_id, asset{ payments * 2 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id() } ) );
+
+   const public_key_type pk = public_key_type( generate_private_key( "foo" ).get_public_key() );
+   do_op( create_payment_service_provider_operation( get_daspay_administrator_id(), payment_id, { clearing_id } ) );
+   do_op( register_daspay_authority_operation( foo_id, payment_id, pk, {} ) );
+   do_op( set_daspay_transaction_ratio_operation( get_daspay_administrator_id(), 200, 0 ) );
+   set_last_dascoin_price( asset( 1 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id() ) /
+                           asset( 1 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id() ) );
+
+   workload_recorder recorder( *this, "daspay_payments" );
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      vector<operation> ops;
+      for( uint32_t i = 0; i < per_block; ++i )
+         ops.push_back( daspay_debit_account_operation( payment_id, pk, foo_id, asset{ 1 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id() },
+                                                        clearing_id, "", {} ) );
+      recorder.push( ops );
+      recorder.block();
+   }
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( das33_pledge_workload )
+{ try {
+   ACTORS((user)(owner));
+   VAULT_ACTOR(vault);
+
+   const uint32_t blocks = 10;
+   const uint32_t per_block = scaled( 50 );
+   const share_type pledges = blocks * per_block;
+
+   fund_wallet_with_dascoin( vault_id, user_id, pledges );
+
+   const asset_id_type token = create_new_asset( "TEST", 100000000000, 5, price{ asset( 1 ), asset( 1, asset_id_type( 1 ) ) } );
+   das33_project_create_operation project_create;
+   project_create.authority       = get_das33_administrator_id();
+   project_create.name            = "bench_project";
+   project_create.owner           = owner_id;
+   project_create.token           = token;
+   project_create.discounts       = {{ get_dascoin_asset_id(), 60 }};
+   project_create.goal_amount_eur = 10000000000;
+   project_create.min_pledge      = 0;
+   project_create.max_pledge      = 10000000000;
+   do_op( project_create );
+   const das33_project_id_type project_id = get_das33_projects()[0].id;
+
+   das33_project_update_operation project_update;
+   project_update.project_id = project_id;
+   project_update.authority  = get_das33_administrator_id();
+   project_update.status     = das33_project_status::active;
+   do_op( project_update );
+   set_last_dascoin_price( asset( 1 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id() ) /
+                           asset( 1 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id() ) );
+
+   workload_recorder recorder( *this, "das33_pledges" );
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      vector<operation> ops;
+      for( uint32_t i = 0; i < per_block; ++i )
+         ops.push_back( das33_pledge_asset_operation( user_id, asset{ 1 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id() },
+                                                      optional<license_type_id_type>{}, project_id ) );
+      recorder.push( ops );
+      recorder.block();
+   }
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( evaluator_dispatch_workload )
+{ try {
+   ACTOR(foo);
+
+   const uint32_t blocks = 10;
+   const uint32_t per_block = scaled( 1000 );
+
+   // custom operations have no evaluator logic, so this reports the per operation cost of dispatch and fees
+   workload_recorder recorder( *this, "evaluator_dispatch" );
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      vector<operation> ops;
+      for( uint32_t i = 0; i < per_block; ++i )
+      {
+         custom_operation op;
+         op.payer = foo_id;
+         op.id = i;
+         ops.push_back( op );
+      }
+      recorder.push( ops, 100 );
+      recorder.block();
+   }
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( maintenance_and_limit_reset_workload )
+{ try {
+   // a population for the maintenance interval and the spending limit reset to walk over
+   const auto vaults = create_vaults( "vault", scaled( 1000 ) );
+   for( uint32_t i = 0; i < vaults.size(); i += 2 )
+      create_new_account( get_registrar_id(), "wallet" + fc::to_string( i ) );
+   generate_block();
+
+   workload_recorder recorder( *this, "maintenance_and_limit_reset" );
+   // the blocks up to and including the next two maintenance intervals and a day boundary
+   recorder.blocks_until( db.get_dynamic_global_properties().next_maintenance_time );
+   recorder.blocks_until( db.get_dynamic_global_properties().next_maintenance_time );
+   recorder.blocks_until( db.head_block_time() + fc::days( 1 ) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -23,14 +23,22 @@
  */
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/account_object.hpp>
+#include <graphene/chain/balance_object.hpp>
 #include <graphene/utilities/tempdir.hpp>
 
 #include <fc/crypto/digest.hpp>
 
 #include <boost/test/auto_unit_test.hpp>
 
+#include <future>
+#include <thread>
+
 using namespace graphene::chain;
 
+namespace graphene { namespace app { namespace detail {
+   genesis_state_type create_example_genesis();
+} } }
+
 BOOST_AUTO_TEST_CASE( operation_sanity_check )
 {
    try {
@@ -47,7 +55,7 @@ BOOST_AUTO_TEST_CASE( operation_sanity_check )
 BOOST_AUTO_TEST_CASE( genesis_and_persistence_bench )
 {
    try {
-      genesis_state_type genesis_state;
+      genesis_state_type genesis_state = graphene::app::detail::create_example_genesis();
 
 #ifdef NDEBUG
       ilog("Running in release mode.");
@@ -59,52 +67,63 @@ BOOST_AUTO_TEST_CASE( genesis_and_persistence_bench )
       const int blocks_to_produce = 1000;
 #endif
 
+      // deriving the keys takes longer than loading them, so it is spread over all cores
+      fc::time_point start_time = fc::time_point::now();
+      vector<public_key_type> keys( account_count );
+      const int shard_count = std::max( 1u, std::thread::hardware_concurrency() );
+      vector<std::future<void>> shards;
+      for( int shard = 0; shard < shard_count; ++shard )
+         shards.push_back( std::async( std::launch::async, [&keys, shard, shard_count, account_count]() {
+            for( int i = shard; i < account_count; i += shard_count )
+               keys[i] = fc::ecc::private_key::regenerate(fc::digest(i)).get_public_key();
+         } ) );
+      for( auto& shard : shards )
+         shard.get();
+      ilog("Derived ${c} keys in ${t} milliseconds.", ("c", account_count)("t", (fc::time_point::now() - start_time).count() / 1000));
+
+      genesis_state.initial_balances.clear();
       for( int i = 0; i < account_count; ++i )
-         genesis_state.initial_accounts.emplace_back("target"+fc::to_string(i),
-                                                     public_key_type(fc::ecc::private_key::regenerate(fc::digest(i)).get_public_key()));
+      {
+         genesis_state.initial_accounts.emplace_back("target"+fc::to_string(i), keys[i]);
+         genesis_state.initial_balances.push_back({address(keys[i]), GRAPHENE_SYMBOL, GRAPHENE_MAX_SHARE_SUPPLY / account_count});
+      }
 
       fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
 
+      auto check_genesis = [&]( const database& db ) {
+         const auto& accounts_by_name = db.get_index_type<account_index>().indices().get<by_name>();
+         for( int i = 0; i < account_count; i += account_count / 100 )
+            BOOST_CHECK(accounts_by_name.find("target"+fc::to_string(i)) != accounts_by_name.end());
+         BOOST_CHECK_EQUAL(db.get_index_type<balance_index>().indices().size(), size_t(account_count));
+      };
+
       {
          database db;
-         db.open(data_dir.path(), [&]{return genesis_state;}, "test");
 
-         for( int i = 11; i < account_count + 11; ++i)
-            BOOST_CHECK(db.get_balance(account_id_type(i), asset_id_type()).amount == GRAPHENE_MAX_SHARE_SUPPLY / account_count);
+         start_time = fc::time_point::now();
+         db.open(data_dir.path(), [&]{return genesis_state;}, "test");
+         ilog("Initialized genesis with ${c} accounts in ${t} milliseconds.",
+              ("c", account_count)("t", (fc::time_point::now() - start_time).count() / 1000));
+         check_genesis(db);
 
-         fc::time_point start_time = fc::time_point::now();
+         start_time = fc::time_point::now();
          db.close();
          ilog("Closed database in ${t} milliseconds.", ("t", (fc::time_point::now() - start_time).count() / 1000));
       }
       {
          database db;
 
-         fc::time_point start_time = fc::time_point::now();
+         start_time = fc::time_point::now();
          db.open(data_dir.path(), [&]{return genesis_state;}, "test");
          ilog("Opened database in ${t} milliseconds.", ("t", (fc::time_point::now() - start_time).count() / 1000));
+         check_genesis(db);
 
-         for( int i = 11; i < account_count + 11; ++i)
-            BOOST_CHECK(db.get_balance(account_id_type(i), asset_id_type()).amount == GRAPHENE_MAX_SHARE_SUPPLY / account_count);
-
-         int blocks_out = 0;
          auto witness_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
-         auto aw = db.get_global_properties().active_witnesses;
-         auto b =  db.generate_block( db.get_slot_time( 1 ), db.get_scheduled_witness( 1 ), witness_priv_key, ~0 );
-
          start_time = fc::time_point::now();
-         /* TODO: get this buliding again
          for( int i = 0; i < blocks_to_produce; ++i )
-         {
-            signed_transaction trx;
-            trx.operations.emplace_back(transfer_operation(asset(1), account_id_type(i + 11), account_id_type(), asset(1), memo_data()));
-            db.push_transaction(trx, ~0);
-
-            aw = db.get_global_properties().active_witnesses;
-            b =  db.generate_block( db.get_slot_time( 1 ), db.get_scheduled_witness( 1 ), witness_priv_key, ~0 );
-         }
-         */
-         ilog("Pushed ${c} blocks (1 op each, no validation) in ${t} milliseconds.",
-              ("c", blocks_out)("t", (fc::time_point::now() - start_time).count() / 1000));
+            db.generate_block( db.get_slot_time( 1 ), db.get_scheduled_witness( 1 ), witness_priv_key, ~0 );
+         ilog("Produced ${c} empty blocks in ${t} milliseconds.",
+              ("c", blocks_to_produce)("t", (fc::time_point::now() - start_time).count() / 1000));
 
          start_time = fc::time_point::now();
          db.close();
@@ -113,13 +132,12 @@ BOOST_AUTO_TEST_CASE( genesis_and_persistence_bench )
       {
          database db;
 
-         auto start_time = fc::time_point::now();
+         start_time = fc::time_point::now();
          wlog( "about to start reindex..." );
          db.open(data_dir.path(), [&]{return genesis_state;}, "force_wipe");
          ilog("Replayed database in ${t} milliseconds.", ("t", (fc::time_point::now() - start_time).count() / 1000));
-
-         for( int i = 0; i < blocks_to_produce; ++i )
-            BOOST_CHECK(db.get_balance(account_id_type(i + 11), asset_id_type()).amount == GRAPHENE_MAX_SHARE_SUPPLY / account_count - 2);
+         check_genesis(db);
+         BOOST_CHECK_EQUAL(db.head_block_num(), uint32_t(blocks_to_produce));
       }
 
    } catch(fc::exception& e) {
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/api.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( history_benchmarks, database_fixture )
+
+/**
+ * Fills one account with a long history where a rare operation type (das33 pledges) makes up
+ * 0.1% of the entries, then compares walking the linked list with the per-type index seek.
+ */
+BOOST_AUTO_TEST_CASE( account_history_by_operation_bench )
+{ try {
+#ifdef NDEBUG
+   const uint32_t history_size = 1000000;
+#else
+   const uint32_t history_size = 20000;
+#endif
+   const uint32_t rare_every = 1000;
+
+   VAULT_ACTOR(vault)
+   generate_block();
+
+   const int rare_type = operation::tag<das33_pledge_asset_operation>::value;
+   const int common_type = operation::tag<transfer_operation>::value;
+
+   fc::time_point start_time = fc::time_point::now();
+   db._undo_db.disable();
+   {
+      const auto& stats = vault.statistics(db);
+      for( uint32_t i = 0; i < history_size; ++i )
+      {
+         const bool rare = ( i % rare_every ) == 0;
+         const auto& oho = db.create<operation_history_object>( [&]( operation_history_object& h ) {
+            if( rare )
+               h.op = das33_pledge_asset_operation();
+            else
+               h.op = transfer_operation();
+            h.block_num = db.head_block_num();
+         });
+         const auto& ath = db.create<account_transaction_history_object>( [&]( account_transaction_history_object& obj ) {
+            obj.operation_id = oho.id;
+            obj.account = vault_id;
+            obj.sequence = stats.total_ops + 1;
+            obj.next = stats.most_recent_op;
+            obj.operation_type = oho.op.which();
+         });
+         db.modify( stats, [&]( account_statistics_object& obj ) {
+            obj.most_recent_op = ath.id;
+            obj.total_ops = ath.sequence;
+         });
+      }
+   }
+   db._undo_db.enable();
+   ilog( "Created ${n} history entries in ${t} ms", ("n", history_size)("t", (fc::time_point::now() - start_time).count() / 1000) );
+
+   const unsigned limit = 100;
+
+   // what get_account_history_by_operation used to do: follow next and dereference every operation
+   start_time = fc::time_point::now();
+   vector<operation_history_id_type> scanned;
+   const account_transaction_history_object* node = &vault.statistics(db).most_recent_op(db);
+   while( node && scanned.size() < limit )
+   {
+      if( node->operation_id(db).op.which() == rare_type )
+         scanned.push_back( node->operation_id );
+      node = node->next == account_transaction_history_id_type() ? nullptr : &node->next(db);
+   }
+   const auto scan_time = fc::time_point::now() - start_time;
+
+   graphene::app::history_api hist_api(app);
+   start_time = fc::time_point::now();
+   auto seeked = hist_api.get_account_history_by_operation( vault_id, {static_cast<uint32_t>(rare_type)},
+                                                            operation_history_id_type(), limit, operation_history_id_type() );
+   const auto seek_time = fc::time_point::now() - start_time;
+
+   start_time = fc::time_point::now();
+   auto common = hist_api.get_account_history_by_operation( vault_id, {static_cast<uint32_t>(common_type)},
+                                                            operation_history_id_type(), limit, operation_history_id_type() );
+   const auto common_time = fc::time_point::now() - start_time;
+
+   BOOST_REQUIRE_EQUAL( seeked.size(), scanned.size() );
+   for( size_t i = 0; i < seeked.size(); ++i )
+      BOOST_CHECK( seeked[i].id == scanned[i] );
+   BOOST_CHECK_EQUAL( common.size(), limit );
+
+   ilog( "Rare type, ${n} results: linked list walk ${scan} us, index seek ${seek} us; common type ${common} us",
+         ("n", seeked.size())("scan", scan_time.count())("seek", seek_time.count())("common", common_time.count()) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/database_api.hpp>
+#include <graphene/app/json_writer.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <fc/io/json.hpp>
+
+#include "allocation_counter.hpp"
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+struct serialization_cost
+{
+   fc::microseconds time;
+   uint64_t         allocations = 0;
+   size_t           bytes = 0;
+};
+
+template<typename T>
+serialization_cost measure_variant( const T& value, uint32_t rounds )
+{
+   serialization_cost cost;
+   const uint64_t allocations_before = allocations_so_far();
+   const fc::time_point start = fc::time_point::now();
+   for( uint32_t i = 0; i < rounds; ++i )
+      cost.bytes = fc::json::to_string( fc::variant( value, GRAPHENE_MAX_NESTED_OBJECTS ) ).size();
+   cost.time = fc::microseconds( ( fc::time_point::now() - start ).count() / rounds );
+   cost.allocations = ( allocations_so_far() - allocations_before ) / rounds;
+   return cost;
+}
+
+template<typename T>
+serialization_cost measure_writer( const T& value, uint32_t rounds )
+{
+   serialization_cost cost;
+   const uint64_t allocations_before = allocations_so_far();
+   const fc::time_point start = fc::time_point::now();
+   for( uint32_t i = 0; i < rounds; ++i )
+   {
+      graphene::app::json_writer out;
+      out.write( value );
+      cost.bytes = out.str().size();
+   }
+   cost.time = fc::microseconds( ( fc::time_point::now() - start ).count() / rounds );
+   cost.allocations = ( allocations_so_far() - allocations_before ) / rounds;
+   return cost;
+}
+
+template<typename T>
+void compare( const std::string& call, const T& value, uint32_t rounds )
+{
+   const serialization_cost variant_cost = measure_variant( value, rounds );
+   const serialization_cost writer_cost = measure_writer( value, rounds );
+   BOOST_CHECK_EQUAL( variant_cost.bytes, writer_cost.bytes );
+   ilog( "${call}: ${bytes} bytes; fc::variant ${vt} us, ${va} allocations; json_writer ${wt} us, ${wa} allocations",
+         ("call", call)("bytes", writer_cost.bytes)
+         ("vt", variant_cost.time.count())("va", variant_cost.allocations)
+         ("wt", writer_cost.time.count())("wa", writer_cost.allocations) );
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( json_benchmarks, database_fixture )
+
+/**
+ * Serializes the results of a 100 block get_blocks call and a get_vaults_info call for 100
+ * vaults both through fc::variant and with json_writer.
+ */
+BOOST_AUTO_TEST_CASE( api_result_serialization_bench )
+{ try {
+   const uint32_t vault_count = 100;
+   const uint32_t rounds = 20;
+
+   vector<account_id_type> vaults;
+   for( uint32_t i = 0; i < vault_count; ++i )
+      vaults.push_back( create_new_vault_account( get_registrar_id(), "vault" + fc::to_string( i ) ).id );
+   generate_block();
+
+   // one queue submission per block so the blocks carry transactions
+   for( uint32_t i = 0; i < 100; ++i )
+   {
+      do_op( submit_reserve_cycles_to_queue_operation( get_cycle_issuer_id(), vaults[ i % vault_count ], 200, 200, "" ) );
+      generate_block();
+   }
+
+   graphene::app::application_options app_options;
+   graphene::app::database_api db_api( db, &app_options );
+
+   compare( "get_blocks(100)", db_api.get_blocks( db.head_block_num() - 99, 100 ), rounds );
+   compare( "get_vaults_info(100)", db_api.get_vaults_info( vaults ), rounds );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/database_api.hpp>
+#include <graphene/chain/access_layer.hpp>
+#include <graphene/chain/database.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( vault_dashboard_benchmarks, database_fixture )
+
+/**
+ * Compares the four separate calls a wallet backend makes for a batch of 1000 vaults with one
+ * get_vault_dashboards call.
+ */
+BOOST_AUTO_TEST_CASE( vault_dashboard_bench )
+{ try {
+   const uint32_t vault_count = 1000;
+   const uint32_t rounds = 10;
+
+   vector<account_id_type> vaults;
+   for( uint32_t i = 0; i < vault_count; ++i )
+      vaults.push_back( create_new_vault_account( get_registrar_id(), "vault" + fc::to_string( i ) ).id );
+   generate_block();
+
+   // a queue of a few thousand submissions, spread over every other vault
+   for( uint32_t i = 0; i < 2 * vault_count; ++i )
+   {
+      do_op( submit_reserve_cycles_to_queue_operation( get_cycle_issuer_id(), vaults[ ( 2 * i ) % vault_count ], 200, 200, "" ) );
+      if( i % 100 == 99 )
+         generate_block();
+   }
+
+   graphene::app::application_options app_options;
+   graphene::app::database_api db_api( db, &app_options );
+
+   fc::time_point start = fc::time_point::now();
+   for( uint32_t i = 0; i < rounds; ++i )
+   {
+      db_api.get_vaults_info( vaults );
+      db_api.get_all_cycle_balances_for_accounts( vaults );
+      db_api.get_dascoin_balances_for_accounts( vaults );
+      db_api.get_queue_submissions_with_pos_for_accounts( vaults );
+   }
+   const int64_t separate_us = ( fc::time_point::now() - start ).count() / rounds;
+
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < rounds; ++i )
+      db_api.get_vault_dashboards( vaults );
+   const int64_t batched_us = ( fc::time_point::now() - start ).count() / rounds;
+
+   ilog( "${n} vaults, ${q} queue entries: separate calls ${s} us, get_vault_dashboards ${b} us",
+         ("n", vault_count)("q", db_api.get_reward_queue_size())("s", separate_us)("b", batched_us) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
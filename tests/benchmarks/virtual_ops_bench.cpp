@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( virtual_ops_benchmarks, database_fixture )
+
+/**
+ * Pushes a block's worth of virtual operations and compares collecting them with the old
+ * per-operation search through everything collected so far.
+ */
+BOOST_AUTO_TEST_CASE( virtual_op_collection_bench )
+{ try {
+#ifdef NDEBUG
+   const uint32_t ops_per_block = 50000;
+#else
+   const uint32_t ops_per_block = 5000;
+#endif
+
+   generate_block();
+   db.get_virtual_ops_and_clear_collection();
+
+   for( uint32_t i = 0; i < ops_per_block; ++i )
+      db.push_applied_operation( record_distribute_dascoin_operation() );
+   const auto& applied = db.get_applied_operations();
+
+   // what applied_ops_to_virtual_ops used to do
+   fc::time_point start_time = fc::time_point::now();
+   vector<optional<operation_history_object>> searched;
+   for( const auto& ooho : applied )
+   {
+      auto it = std::find_if( searched.begin(), searched.end(), [&ooho]( const optional<operation_history_object>& e ) {
+         return e->virtual_op == ooho->virtual_op;
+      });
+      if( it == searched.end() )
+         searched.push_back( ooho );
+   }
+   const auto search_time = fc::time_point::now() - start_time;
+
+   start_time = fc::time_point::now();
+   db.applied_ops_to_virtual_ops();
+   const auto collect_time = fc::time_point::now() - start_time;
+
+   // a second pass over the same operations must not take them again
+   db.applied_ops_to_virtual_ops();
+
+   start_time = fc::time_point::now();
+   const auto collected = db.get_virtual_ops_and_clear_collection();
+   const auto drain_time = fc::time_point::now() - start_time;
+
+   BOOST_CHECK_EQUAL( collected.size(), ops_per_block );
+   BOOST_CHECK( db.get_virtual_ops_and_clear_collection().empty() );
+
+   ilog( "${n} virtual ops: search ${search} us, collect ${collect} us, drain ${drain} us",
+         ("n", ops_per_block)("search", search_time.count())("collect", collect_time.count())("drain", drain_time.count()) );
+
+   // nothing is drained any more, the buffer stays bounded and reports what it dropped
+   const uint64_t dropped_before = db.get_dropped_virtual_ops_count();
+   for( uint32_t round = 0; round < 3; ++round )
+   {
+      for( uint32_t i = 0; i < ops_per_block; ++i )
+         db.push_applied_operation( record_distribute_dascoin_operation() );
+      db.applied_ops_to_virtual_ops();
+   }
+   const uint64_t pushed = 3 * uint64_t(ops_per_block);
+   BOOST_CHECK_EQUAL( db.get_dropped_virtual_ops_count() - dropped_before,
+                      pushed > GRAPHENE_MAX_BUFFERED_VIRTUAL_OPS ? pushed - GRAPHENE_MAX_BUFFERED_VIRTUAL_OPS : 0 );
+   BOOST_CHECK_LE( db.get_virtual_ops_and_clear_collection().size(), GRAPHENE_MAX_BUFFERED_VIRTUAL_OPS );
+
+   generate_block();
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
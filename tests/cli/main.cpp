@@ -599,3 +599,73 @@ BOOST_AUTO_TEST_CASE( account_history_pagination )
    app1->shutdown();
 
 }
+
+/******
+ * Sign and broadcast a batch in which some transactions fail, the others still go through
+ */
+BOOST_AUTO_TEST_CASE( cli_sign_and_broadcast_batch )
+{
+   using namespace graphene::chain;
+   using namespace graphene::app;
+   std::shared_ptr<graphene::app::application> app1;
+   try
+   {
+      fc::temp_directory app_dir ( graphene::utilities::temp_directory_path() );
+
+      int server_port_number = 0;
+      app1 = start_application(app_dir, server_port_number);
+
+      // connect to the server
+      client_connection con(app1, app_dir, server_port_number);
+
+      BOOST_TEST_MESSAGE("Setting wallet password");
+      con.wallet_api_ptr->set_password("supersecret");
+      con.wallet_api_ptr->unlock("supersecret");
+
+      // import Nathan account
+      BOOST_TEST_MESSAGE("Importing nathan key and balance");
+      std::vector<std::string> nathan_keys{"5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3"};
+      BOOST_CHECK(con.wallet_api_ptr->import_key("nathan", nathan_keys[0]));
+      con.wallet_api_ptr->import_balance("nathan", nathan_keys, true);
+      BOOST_CHECK(generate_block(app1));
+
+      const account_id_type nathan_id = con.wallet_api_ptr->get_account("nathan").id;
+      const account_id_type init0_id = con.wallet_api_ptr->get_account("init0").id;
+      auto make_transfer = [&]( int64_t amount ) {
+         transfer_operation op;
+         op.from = nathan_id;
+         op.to = init0_id;
+         op.amount = asset( amount, asset_id_type() );
+         return operation( op );
+      };
+
+      // a transfer of nothing fails validate(), one of more than nathan has is rejected by the node
+      BOOST_TEST_MESSAGE("Broadcasting a batch with failing transfers in the middle");
+      const vector<operation> ops{ make_transfer(1), make_transfer(2), make_transfer(0),
+                                   make_transfer(GRAPHENE_MAX_SHARE_SUPPLY), make_transfer(5) };
+      const auto results = con.wallet_api_ptr->sign_and_broadcast_batch( ops, 1, 2, true );
+      BOOST_REQUIRE_EQUAL( results.size(), ops.size() );
+      for( size_t i = 0; i < results.size(); ++i )
+      {
+         BOOST_CHECK_EQUAL( results[i].first_operation, i );
+         BOOST_CHECK_EQUAL( results[i].operation_count, 1u );
+         const bool fails = i == 2 || i == 3;
+         BOOST_CHECK_EQUAL( results[i].error.valid(), fails );
+         BOOST_CHECK_EQUAL( results[i].broadcast, !fails );
+      }
+      BOOST_CHECK( results[0].id != results[1].id );
+      BOOST_CHECK(generate_block(app1));
+
+      // without broadcast the signed transactions come back, the failing one with its error only
+      const auto unsent = con.wallet_api_ptr->sign_and_broadcast_batch( { make_transfer(7), make_transfer(0), make_transfer(8) }, 1, 1, false );
+      BOOST_REQUIRE_EQUAL( unsent.size(), 3u );
+      BOOST_CHECK( unsent[0].transaction.valid() && !unsent[0].transaction->signatures.empty() );
+      BOOST_CHECK( unsent[1].error.valid() && !unsent[1].transaction.valid() );
+      BOOST_CHECK( unsent[2].transaction.valid() && !unsent[2].broadcast );
+
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+   app1->shutdown();
+}
@@ -122,6 +122,11 @@ void database_fixture::init_genesis_state()
 }
 
 database_fixture::database_fixture()
+   : database_fixture( boost::program_options::variables_map() )
+{
+}
+
+database_fixture::database_fixture( const boost::program_options::variables_map& options )
    : app(), db( *app.chain_database() ), _dal(db)
 {
    try {
@@ -141,8 +146,6 @@ database_fixture::database_fixture()
 
    init_genesis_state();
 
-   boost::program_options::variables_map options;
-
    genesis_state.initial_timestamp = time_point_sec( GRAPHENE_TESTING_GENESIS_TIMESTAMP );
 
    genesis_state.initial_active_witnesses = 10;
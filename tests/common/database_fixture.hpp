@@ -28,6 +28,8 @@
 #include <graphene/chain/access_layer.hpp>
 #include <fc/io/json.hpp>
 
+#include <boost/program_options/variables_map.hpp>
+
 #include <graphene/chain/operation_history_object.hpp>
 
 #include <iostream>
@@ -181,6 +183,8 @@ struct database_fixture {
    static constexpr uint32_t apply_bonus(uint32_t value, uint32_t bonus);
 
    database_fixture();
+   /// Initializes the built-in plugins with @p plugin_options instead of their defaults
+   explicit database_fixture( const boost::program_options::variables_map& plugin_options );
    ~database_fixture() noexcept(false);
 
    void init_genesis_state();
@@ -28,6 +28,9 @@
 #include <graphene/chain/exceptions.hpp>
 
 #include <graphene/chain/queue_objects.hpp>
+#include <graphene/chain/virtual_op_object.hpp>
+
+#include <fc/io/json.hpp>
 
 #include "../common/database_fixture.hpp"
 
@@ -362,6 +365,36 @@ BOOST_AUTO_TEST_CASE( get_blocks_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( get_raw_blocks_test )
+{ try {
+  VAULT_ACTOR(vault);
+
+  for(int i = 0; i < 20; ++i) {
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, (i+1)*100, 200, "TEST"));
+  }
+  BOOST_CHECK_EQUAL(db.head_block_num(), 22);
+
+  GRAPHENE_REQUIRE_THROW(_dal.get_raw_blocks(55, 2), fc::exception);
+  GRAPHENE_REQUIRE_THROW(_dal.get_raw_blocks(4, 0), fc::exception);
+  GRAPHENE_REQUIRE_THROW(_dal.get_raw_blocks(0, 4), fc::exception);
+
+  // Unlike get_blocks, the head block is included:
+  auto results = _dal.get_raw_blocks(2, 1000);
+  BOOST_CHECK_EQUAL(results.size(), 21);
+  for (uint32_t i = 0; i < results.size(); ++i) {
+    const auto& res = results[i];
+    BOOST_CHECK_EQUAL(res.block_num, i+2);
+    const auto block = fc::raw::unpack<signed_block>(res.data);
+    BOOST_CHECK(block.id() == res.block_id);
+    BOOST_CHECK(block.id() == db.fetch_block_by_number(res.block_num)->id());
+  }
+
+  results = _dal.get_raw_blocks(22, 5);
+  BOOST_CHECK_EQUAL(results.size(), 1);
+  BOOST_CHECK(results[0].block_id == db.head_block_id());
+
+} FC_LOG_AND_RETHROW() }
+
 /*BOOST_AUTO_TEST_CASE( get_all_cycle_balances_for_accounts_unit_test )
 { try {
   VAULT_ACTORS((first)(second)(third)(fourth))
@@ -583,6 +616,48 @@ BOOST_AUTO_TEST_CASE( get_queue_submissions_with_pos_for_accounts_unit_test )
 
 } FC_LOG_AND_RETHROW() }*/
 
+BOOST_AUTO_TEST_CASE( get_vault_dashboards_unit_test )
+{ try {
+  ACTOR(wallet)
+  VAULT_ACTORS((first)(second)(third))
+  auto bogus_id = account_id_type(999999);
+
+  adjust_cycles(second_id, 1000);
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), first_id, 100, 200, ""));
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), second_id, 200, 200, ""));
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), first_id, 110, 200, ""));
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), second_id, 210, 200, ""));
+
+  const vector<account_id_type> ids{bogus_id, wallet_id, second_id, first_id, third_id, second_id};
+  auto res = _dal.get_vault_dashboards(ids);
+  BOOST_CHECK_EQUAL( res.size(), ids.size() );
+  BOOST_CHECK( !res[0].result.valid() );
+  BOOST_CHECK( !res[1].result.valid() );
+
+  // Each vault matches the separate calls:
+  const auto to_json = [](const fc::variant& v) { return fc::json::to_string(v); };
+  for (size_t i = 2; i < ids.size(); ++i)
+  {
+    BOOST_CHECK( res[i].account_id == ids[i] );
+    BOOST_REQUIRE( res[i].result.valid() );
+    const auto& dashboard = *res[i].result;
+    BOOST_CHECK_EQUAL( to_json(fc::variant(dashboard.info, GRAPHENE_MAX_NESTED_OBJECTS)),
+                       to_json(fc::variant(*_dal.get_vault_info(ids[i]), GRAPHENE_MAX_NESTED_OBJECTS)) );
+    BOOST_CHECK_EQUAL( to_json(fc::variant(dashboard.cycle_balances, GRAPHENE_MAX_NESTED_OBJECTS)),
+                       to_json(fc::variant(*_dal.get_all_cycle_balances(ids[i]).result, GRAPHENE_MAX_NESTED_OBJECTS)) );
+    BOOST_CHECK_EQUAL( to_json(fc::variant(dashboard.queue_submissions, GRAPHENE_MAX_NESTED_OBJECTS)),
+                       to_json(fc::variant(*_dal.get_queue_submissions_with_pos(ids[i]).result, GRAPHENE_MAX_NESTED_OBJECTS)) );
+  }
+
+  BOOST_CHECK_EQUAL( res[2].result->queue_submissions.size(), 2 );
+  BOOST_CHECK_EQUAL( res[2].result->queue_submissions[0].position, 1 );
+  BOOST_CHECK_EQUAL( res[2].result->queue_submissions[1].position, 3 );
+  BOOST_CHECK_EQUAL( res[3].result->queue_submissions[1].position, 2 );
+  BOOST_CHECK( res[4].result->queue_submissions.empty() );
+  BOOST_CHECK_EQUAL( res[5].result->queue_submissions.size(), 2 );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( get_block_with_virtual_operations )
 { try {
     ACTOR(alicew);
@@ -693,6 +768,51 @@ BOOST_AUTO_TEST_CASE( get_block_with_virtual_operations )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( virtual_op_store_test )
+{ try {
+    VAULT_ACTOR(bob);
+
+    // The store is opt-in:
+    const auto& idx = db.get_index_type<virtual_op_index>().indices().get<by_block_type>();
+    BOOST_CHECK_EQUAL( db.get_virtual_op_retention(), 0u );
+    BOOST_CHECK( idx.empty() );
+    db.set_virtual_op_retention(1000);
+
+    adjust_dascoin_reward(500 * DASCOIN_DEFAULT_ASSET_PRECISION);
+    adjust_frequency(200);
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), bob_id, 200, 200, ""));
+    toggle_reward_queue(true);
+    generate_blocks(db.head_block_time() + fc::hours(24) + fc::seconds(1));
+    generate_block();
+
+    const operation distribute = record_distribute_dascoin_operation();
+    uint32_t distribute_block = 0;
+    for ( const auto& vop : idx )
+        if ( vop.op_type == distribute.which() )
+            distribute_block = vop.block_num;
+    BOOST_REQUIRE( distribute_block > 0 );
+    BOOST_REQUIRE( distribute_block < db.head_block_num() );
+
+    vector<uint16_t> ids{ static_cast<uint16_t>(distribute.which()) };
+    const auto stored = _dal.get_blocks_with_virtual_operations(distribute_block, 1, ids);
+    BOOST_REQUIRE_EQUAL( stored.size(), 1 );
+    BOOST_REQUIRE( !stored[0].block.virtual_operations.empty() );
+    for ( const auto& op : stored[0].block.virtual_operations )
+        BOOST_CHECK_EQUAL( op.which(), distribute.which() );
+
+    // Only the most recent block is kept from now on:
+    db.set_virtual_op_retention(1);
+    generate_block();
+    for ( const auto& vop : idx )
+        BOOST_CHECK_EQUAL( vop.block_num, db.head_block_num() );
+
+    // Pruned blocks are still served from the operation history:
+    const auto fallback = _dal.get_blocks_with_virtual_operations(distribute_block, 1, ids);
+    BOOST_REQUIRE_EQUAL( fallback.size(), 1 );
+    BOOST_CHECK_EQUAL( fallback[0].block.virtual_operations.size(), stored[0].block.virtual_operations.size() );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
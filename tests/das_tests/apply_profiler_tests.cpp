@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/apply_profiler.hpp>
+#include <numeric>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( apply_profiler_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( apply_profiler_test )
+{ try {
+    VAULT_ACTOR(bob);
+    auto& profiler = db.get_apply_profiler();
+    BOOST_CHECK( !profiler.enabled() );
+
+    // Nothing is collected while profiling is off:
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), bob_id, 200, 200, ""));
+    BOOST_CHECK( profiler.get_profile().phases.empty() );
+    BOOST_CHECK( profiler.get_profile().operations.empty() );
+
+    profiler.enable(true);
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), bob_id, 200, 200, ""));
+    generate_block();
+
+    const auto profile = profiler.get_profile();
+    BOOST_CHECK( profile.enabled );
+    BOOST_CHECK_EQUAL( profile.last_block, db.head_block_num() );
+    const uint32_t blocks = profile.last_block - profile.first_block + 1;
+
+    auto find = [](const vector<apply_profile_entry>& entries, const string& name) {
+        return std::find_if(entries.begin(), entries.end(), [&](const apply_profile_entry& e) { return e.name == name; });
+    };
+    const auto transactions = find(profile.phases, "transactions");
+    BOOST_REQUIRE( transactions != profile.phases.end() );
+    BOOST_CHECK_EQUAL( transactions->count, blocks );
+
+    const auto submit = find(profile.operations, "submit_reserve_cycles_to_queue_operation");
+    BOOST_REQUIRE( submit != profile.operations.end() );
+    BOOST_CHECK( submit->count >= 1 );
+    BOOST_CHECK( submit->max_ticks <= submit->total_ticks );
+    BOOST_CHECK_EQUAL( std::accumulate(submit->histogram.begin(), submit->histogram.end(), uint64_t(0)), submit->count );
+
+    // The samples of each block can be taken on their own:
+    profiler.keep_block_profiles(true);
+    generate_block();
+    const auto block_profile = profiler.take_block_profile();
+    BOOST_CHECK_EQUAL( block_profile.first_block, db.head_block_num() );
+    BOOST_CHECK_EQUAL( find(block_profile.phases, "transactions")->count, 1 );
+    BOOST_CHECK( block_profile.operations.empty() );
+
+    profiler.enable(false);
+    profiler.reset();
+    generate_block();
+    BOOST_CHECK( profiler.get_profile().phases.empty() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // apply_profiler_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
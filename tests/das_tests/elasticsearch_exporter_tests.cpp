@@ -0,0 +1,278 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/utilities/elasticsearch_exporter.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/network/http/server.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+graphene::utilities::es_bulk_exporter::document make_document( uint32_t block_num, uint32_t i )
+{
+   graphene::utilities::es_bulk_exporter::document doc;
+   doc.index_name = "test-index";
+   doc.id = fc::to_string(block_num) + "." + fc::to_string(i);
+   doc.block_num = block_num;
+   doc.make_source = [block_num]() { return "{\"block\":" + fc::to_string(block_num) + "}"; };
+   return doc;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( elasticsearch_exporter_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( exporter_spools_while_sink_is_down )
+{ try {
+   // local stand-in for the elasticsearch bulk endpoint, failing the first requests
+   uint32_t requests = 0;
+   uint32_t failures_left = 3;
+   size_t documents_received = 0;
+   fc::http::server server;
+   server.listen(fc::ip::endpoint(fc::ip::address("127.0.0.1"), 0));
+   server.on_request([&](const fc::http::request& req, const fc::http::server::response& resp) {
+      ++requests;
+      std::string reply;
+      if(failures_left > 0) {
+         --failures_left;
+         resp.set_status(fc::http::reply::InternalServerError);
+      }
+      else {
+         std::string body(req.body.begin(), req.body.end());
+         documents_received += std::count(body.begin(), body.end(), '\n') / 2;
+         reply = "{\"errors\":false}";
+         resp.set_status(fc::http::reply::OK);
+      }
+      resp.set_length(reply.size());
+      resp.write(reply.c_str(), reply.size());
+   });
+
+   fc::temp_directory spool_dir(graphene::utilities::temp_directory_path());
+   graphene::utilities::es_bulk_exporter::options opts;
+   opts.elasticsearch_url = "http://127.0.0.1:" + fc::to_string(server.get_local_endpoint().port()) + "/";
+   opts.spool_dir = spool_dir.path();
+   opts.max_batch_documents = 2;
+   opts.initial_retry_delay = fc::milliseconds(10);
+   opts.max_retry_delay = fc::milliseconds(50);
+   opts.retries_before_spool = 1;
+
+   graphene::utilities::es_bulk_exporter exporter(opts);
+   exporter.start();
+   for(uint32_t block_num = 1; block_num <= 3; ++block_num) {
+      for(uint32_t i = 0; i < 2; ++i)
+         exporter.push(make_document(block_num, i));
+      exporter.end_block(block_num, true);
+   }
+
+   for(int i = 0; i < 500 && exporter.get_status().last_exported_block < 3; ++i)
+      fc::usleep(fc::milliseconds(10));
+   exporter.stop();
+
+   auto status = exporter.get_status();
+   BOOST_CHECK_EQUAL(status.last_exported_block, 3u);
+   BOOST_CHECK_EQUAL(status.lag_blocks, 0u);
+   BOOST_CHECK_GE(status.failed_attempts, 3u);
+   BOOST_CHECK_GT(status.spooled_batches, 0u);
+   BOOST_CHECK_EQUAL(documents_received, 6u);
+   BOOST_CHECK(fc::directory_iterator(spool_dir.path()) == fc::directory_iterator());
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( exporter_batches_by_size )
+{ try {
+   std::vector<std::string> bodies;
+   graphene::utilities::es_bulk_exporter::options opts;
+   opts.max_batch_documents = 4;
+   opts.max_batch_delay = fc::seconds(60);
+   graphene::utilities::es_bulk_exporter exporter(opts, [&](const std::string& body) {
+      bodies.push_back(body);
+      return true;
+   });
+   exporter.start();
+   for(uint32_t i = 0; i < 10; ++i) {
+      graphene::utilities::es_bulk_exporter::document doc;
+      doc.index_name = "test-index";
+      doc.id = fc::to_string(i);
+      doc.block_num = 1;
+      doc.make_source = []() { return std::string("{}"); };
+      exporter.push(std::move(doc));
+   }
+   exporter.end_block(1, false);
+   exporter.stop();
+
+   // two full batches, the remainder is flushed on stop
+   BOOST_REQUIRE_EQUAL(bodies.size(), 3u);
+   BOOST_CHECK_EQUAL(std::count(bodies[0].begin(), bodies[0].end(), '\n'), 8);
+   BOOST_CHECK_EQUAL(std::count(bodies[2].begin(), bodies[2].end(), '\n'), 4);
+   BOOST_CHECK_EQUAL(exporter.get_status().exported_documents, 10u);
+   BOOST_CHECK_EQUAL(exporter.get_status().last_exported_block, 1u);
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( exporter_does_not_report_undelivered_blocks )
+{ try {
+   // no spool and a sink that never accepts anything
+   std::atomic<uint32_t> attempts( 0 );
+   graphene::utilities::es_bulk_exporter::options opts;
+   opts.initial_retry_delay = fc::milliseconds(5);
+   opts.max_retry_delay = fc::milliseconds(20);
+   opts.retries_before_spool = 1;
+   graphene::utilities::es_bulk_exporter exporter(opts, [&](const std::string&) {
+      ++attempts;
+      return false;
+   });
+   exporter.start();
+   exporter.push(make_document(1, 0));
+   exporter.push(make_document(1, 1));
+   exporter.end_block(1, true);
+
+   const fc::time_point deadline = fc::time_point::now() + fc::seconds(5);
+   while( attempts < 4 && fc::time_point::now() < deadline )
+      fc::usleep(fc::milliseconds(5));
+   BOOST_REQUIRE_GE(attempts.load(), 4u);
+   BOOST_CHECK_EQUAL(exporter.get_status().held_batches, 1u);
+   exporter.stop();
+
+   auto status = exporter.get_status();
+   BOOST_CHECK_EQUAL(status.last_exported_block, 0u);
+   BOOST_CHECK_EQUAL(status.lag_blocks, 1u);
+   BOOST_CHECK_EQUAL(status.exported_documents, 0u);
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( exporter_holds_batches_it_cannot_spool )
+{ try {
+   // the spool directory cannot be created below a regular file, so failed batches stay in memory
+   fc::temp_directory temp_dir(graphene::utilities::temp_directory_path());
+   const fc::path not_a_directory = temp_dir.path() / "file";
+   std::ofstream file( not_a_directory.generic_string().c_str() );
+   file << "x";
+   file.close();
+
+   std::atomic<uint32_t> failures_left( 3 );
+   std::atomic<uint32_t> documents_received( 0 );
+   graphene::utilities::es_bulk_exporter::options opts;
+   opts.spool_dir = not_a_directory / "spool";
+   opts.max_batch_documents = 2;
+   opts.initial_retry_delay = fc::milliseconds(10);
+   opts.max_retry_delay = fc::milliseconds(50);
+   opts.retries_before_spool = 1;
+   graphene::utilities::es_bulk_exporter exporter(opts, [&](const std::string& body) {
+      if( failures_left > 0 )
+      {
+         --failures_left;
+         return false;
+      }
+      documents_received += std::count(body.begin(), body.end(), '\n') / 2;
+      return true;
+   });
+   exporter.start();
+   for( uint32_t block_num = 1; block_num <= 3; ++block_num )
+   {
+      for( uint32_t i = 0; i < 2; ++i )
+         exporter.push(make_document(block_num, i));
+      exporter.end_block(block_num, true);
+   }
+
+   const fc::time_point deadline = fc::time_point::now() + fc::seconds(5);
+   while( exporter.get_status().last_exported_block < 3 && fc::time_point::now() < deadline )
+      fc::usleep(fc::milliseconds(10));
+   exporter.stop();
+
+   auto status = exporter.get_status();
+   BOOST_CHECK_EQUAL(status.last_exported_block, 3u);
+   BOOST_CHECK_EQUAL(status.spooled_batches, 0u);
+   BOOST_CHECK_EQUAL(status.held_batches, 0u);
+   BOOST_CHECK_EQUAL(status.exported_documents, 6u);
+   BOOST_CHECK_EQUAL(documents_received.load(), 6u);
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( exporter_waits_for_room_instead_of_dropping )
+{ try {
+   // the sink is down until the releaser thread brings it back, meanwhile the queue fills up
+   std::atomic<bool> accepting( false );
+   graphene::utilities::es_bulk_exporter::options opts;
+   opts.queue_capacity = 2;
+   opts.max_held_batches = 1;
+   opts.max_batch_documents = 1;
+   opts.retries_before_spool = 0;
+   opts.initial_retry_delay = fc::milliseconds(5);
+   opts.max_retry_delay = fc::milliseconds(20);
+   graphene::utilities::es_bulk_exporter exporter(opts, [&](const std::string&) { return accepting.load(); });
+   exporter.start();
+
+   std::thread releaser([&]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      accepting = true;
+   });
+   bool all_queued = true;
+   for(uint32_t i = 0; i < 10; ++i)
+      all_queued = exporter.push(make_document(1, i)) && all_queued;
+   all_queued = exporter.end_block(1, true) && all_queued;
+   releaser.join();
+   BOOST_CHECK(all_queued);
+
+   for(int i = 0; i < 500 && exporter.get_status().last_exported_block < 1; ++i)
+      fc::usleep(fc::milliseconds(10));
+   exporter.stop();
+
+   auto status = exporter.get_status();
+   BOOST_CHECK_EQUAL(status.last_queued_block, 1u);
+   BOOST_CHECK_EQUAL(status.last_exported_block, 1u);
+   BOOST_CHECK_EQUAL(status.exported_documents, 10u);
+   BOOST_CHECK_GT(status.producer_waits, 0u);
+   BOOST_CHECK_GT(status.producer_wait_time.count(), 0);
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( exporter_refuses_documents_it_cannot_queue )
+{ try {
+   graphene::utilities::es_bulk_exporter::options opts;
+   opts.queue_capacity = 2;
+   graphene::utilities::es_bulk_exporter exporter(opts, [](const std::string&) { return true; });
+
+   // not started, nothing drains the queue: the third document is handed back instead of dropped
+   BOOST_CHECK(exporter.push(make_document(1, 0)));
+   BOOST_CHECK(exporter.push(make_document(1, 1)));
+   auto refused = make_document(1, 2);
+   BOOST_CHECK(!exporter.push(std::move(refused)));
+   BOOST_CHECK_EQUAL(refused.id, "1.2");
+   BOOST_CHECK(!exporter.end_block(1, false));
+
+   auto status = exporter.get_status();
+   BOOST_CHECK_EQUAL(status.last_queued_block, 0u);
+   BOOST_CHECK_EQUAL(status.producer_waits, 0u);
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::elasticsearch_exporter_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/impacted.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/io/json.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( fork_retention_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( fork_storm_test )
+{ try {
+    const uint32_t rounds = 10;
+    const uint32_t accounts_per_block = 20;
+    const uint32_t skip = database::skip_witness_signature | database::skip_tapos_check;
+
+    // operations of every account by block number, as a history plugin following applied_block sees them
+    typedef std::map< account_id_type, std::map< uint32_t, vector<string> > > account_histories;
+    auto record_histories = []( database& d, account_histories& histories ) {
+        return d.applied_block.connect( [&d, &histories]( const signed_block& b ) {
+            const uint32_t block_num = b.block_num();
+            // a block of another fork replaces the history from its height on
+            for ( auto itr = histories.begin(); itr != histories.end(); )
+            {
+                itr->second.erase( itr->second.lower_bound( block_num ), itr->second.end() );
+                itr = itr->second.empty() ? histories.erase( itr ) : std::next( itr );
+            }
+            for ( const auto& o : d.get_applied_operations() )
+            {
+                if ( !o.valid() )
+                    continue;
+                flat_set<account_id_type> impacted;
+                operation_get_impacted_accounts( o->op, impacted );
+                for ( const auto& account : impacted )
+                    histories[account][block_num].push_back( fc::json::to_string( *o ) );
+            }
+        } );
+    };
+
+    // A node follows two producers that take turns in outgrowing each other, so it switches forks every round.
+    // Returns the total time of the switches.
+    auto run_storm = [&]( size_t retention ) -> int64_t {
+        fc::temp_directory node_dir( graphene::utilities::temp_directory_path() );
+        fc::temp_directory a_dir( graphene::utilities::temp_directory_path() );
+        fc::temp_directory b_dir( graphene::utilities::temp_directory_path() );
+        database node, producer_a, producer_b;
+        node.open( node_dir.path(), [this]{ return genesis_state; }, "TEST" );
+        producer_a.open( a_dir.path(), [this]{ return genesis_state; }, "TEST" );
+        producer_b.open( b_dir.path(), [this]{ return genesis_state; }, "TEST" );
+        node.set_fork_changes_retention( retention );
+
+        account_histories node_histories, a_histories, b_histories;
+        boost::signals2::scoped_connection node_conn( record_histories( node, node_histories ) );
+        boost::signals2::scoped_connection a_conn( record_histories( producer_a, a_histories ) );
+        boost::signals2::scoped_connection b_conn( record_histories( producer_b, b_histories ) );
+
+        auto produce = [&]( database& producer, const string& branch ) {
+            for ( uint32_t i = 0; i < accounts_per_block; ++i )
+            {
+                signed_transaction trx;
+                set_expiration( producer, trx );
+                trx.operations.push_back( make_account( account_kind::wallet, get_registrar_id(),
+                                                        branch + fc::to_string( producer.head_block_num() ) + "x" + fc::to_string( i ) ) );
+                producer.push_transaction( trx, ~0 );
+            }
+            return producer.generate_block( producer.get_slot_time(1), producer.get_scheduled_witness(1), init_account_priv_key, ~0 );
+        };
+
+        // the branches grow from a block all three have
+        const signed_block common = produce( producer_a, "common" );
+        node.push_block( common, skip );
+        producer_b.push_block( common, skip );
+
+        int64_t switch_us = 0;
+        for ( uint32_t round = 0; round < rounds; ++round )
+        {
+            // the producer behind catches up and takes the lead by one block, the last push switches the node
+            database& producer = round % 2 ? producer_b : producer_a;
+            const account_histories& producer_histories = round % 2 ? b_histories : a_histories;
+            const string branch = round % 2 ? "branch-b" : "branch-a";
+            vector<signed_block> blocks;
+            while ( producer.head_block_num() <= node.head_block_num() )
+                blocks.push_back( produce( producer, branch ) );
+            for ( size_t i = 0; i + 1 < blocks.size(); ++i )
+                node.push_block( blocks[i], skip );
+
+            const fc::time_point start = fc::time_point::now();
+            node.push_block( blocks.back(), skip );
+            switch_us += ( fc::time_point::now() - start ).count();
+
+            BOOST_REQUIRE( node.head_block_id() == producer.head_block_id() );
+            BOOST_CHECK_EQUAL( node.state_digest().str(), producer.state_digest().str() );
+            // from the second round on the node switches back to blocks it popped before
+            BOOST_CHECK( node_histories == producer_histories );
+            if ( retention > 0 && round > 0 )
+                BOOST_CHECK( node.get_retained_fork_changes_size() > 0 );
+        }
+        return switch_us;
+    };
+
+    const int64_t reapplied_us = run_storm( 0 );
+    const int64_t redone_us = run_storm( 64 * 1024 * 1024 );
+    ilog( "${r} fork switches: ${a} us applying the blocks again, ${b} us redoing retained changes",
+          ("r", rounds)("a", reapplied_us)("b", redone_us) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( retained_changes_stay_within_budget_test )
+{ try {
+    auto produce = [&]( uint32_t block ) {
+        for ( uint32_t i = 0; i < 10; ++i )
+            create_new_account( get_registrar_id(), "budget" + fc::to_string( block ) + "x" + fc::to_string( i ),
+                                init_account_pub_key );
+        generate_block();
+    };
+
+    db.set_fork_changes_retention( 64 * 1024 * 1024 );
+    produce( 0 );
+    const size_t block_size = db.get_retained_fork_changes_size();
+    BOOST_REQUIRE( block_size > 0 );
+
+    // room for two blocks and a half: the blocks applied on the main chain count too, the oldest ones go first
+    const size_t budget = block_size * 5 / 2;
+    db.set_fork_changes_retention( budget );
+    for ( uint32_t block = 1; block <= 10; ++block )
+    {
+        produce( block );
+        BOOST_CHECK( db.get_retained_fork_changes_size() <= budget );
+        BOOST_CHECK( db.get_retained_fork_changes_size() > 0 );
+    }
+
+    db.set_fork_changes_retention( 0 );
+    BOOST_CHECK_EQUAL( db.get_retained_fork_changes_size(), 0u );
+    produce( 11 );
+    BOOST_CHECK_EQUAL( db.get_retained_fork_changes_size(), 0u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/worker_pool.hpp>
+#include <graphene/app/database_api.hpp>
+
+#include <fc/io/json.hpp>
+
+#include "../common/database_fixture.hpp"
+
+#include <atomic>
+#include <thread>
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( full_accounts_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( worker_pool_runs_every_shard_once_test )
+{ try {
+  worker_pool pool( 4 );
+  vector<std::atomic<int>> visits( 1000 );
+  for ( auto& v : visits )
+    v = 0;
+
+  // two callers at once share the same four threads
+  auto visit = [&visits]( size_t first, size_t last ) {
+    for ( size_t i = first; i < last; ++i )
+      ++visits[i];
+  };
+  std::thread other( [&pool, &visit]{ pool.run_shards( 1000, 10, visit ); } );
+  pool.run_shards( 1000, 10, visit );
+  other.join();
+  for ( const auto& v : visits )
+    BOOST_CHECK_EQUAL( v.load(), 2 );
+
+  // a batch below the shard size runs on the caller only
+  const auto caller = std::this_thread::get_id();
+  pool.run_shards( 5, 10, [caller]( size_t first, size_t last ) {
+    BOOST_CHECK( std::this_thread::get_id() == caller );
+    BOOST_CHECK_EQUAL( first, 0 );
+    BOOST_CHECK_EQUAL( last, 5 );
+  });
+
+  // a failing shard does not leave the others running behind the caller
+  std::atomic<size_t> done{ 0 };
+  GRAPHENE_REQUIRE_THROW( pool.run_shards( 100, 10, [&done]( size_t first, size_t last ) {
+    FC_ASSERT( first != 0 );
+    done += last - first;
+  }), fc::exception );
+  BOOST_CHECK_EQUAL( done.load(), 75u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( get_full_accounts_with_sections_unit_test )
+{ try {
+  // enough accounts to be built on several threads
+  vector<string> names;
+  for ( int i = 0; i < 100; ++i )
+  {
+    names.push_back( "vault" + fc::to_string( i ) );
+    create_new_vault_account( get_registrar_id(), names.back() );
+  }
+  names.push_back( "unknown" );
+  names.push_back( "1.2.0" );
+  generate_block();
+
+  graphene::app::application_options app_options;
+  graphene::app::database_api db_api( db, &app_options );
+
+  const auto full = db_api.get_full_accounts( names, false );
+  BOOST_CHECK_EQUAL( full.size(), 101 );
+  BOOST_CHECK_EQUAL( full.at( "vault42" ).account.name, "vault42" );
+  BOOST_CHECK_EQUAL( fc::json::to_string( db_api.get_full_accounts_with_sections( names, {}, false ) ),
+                     fc::json::to_string( full ) );
+
+  const auto balances = db_api.get_full_accounts_with_sections( names, { "balances" }, false );
+  BOOST_CHECK_EQUAL( balances.size(), 101 );
+  const auto& vault = balances.at( "vault7" );
+  BOOST_CHECK( vault.account.id == full.at( "vault7" ).account.id );
+  BOOST_CHECK_EQUAL( vault.balances.size(), full.at( "vault7" ).balances.size() );
+  BOOST_CHECK( vault.registrar_name.empty() );
+  BOOST_CHECK( vault.statistics.id == account_statistics_object().id );
+
+  GRAPHENE_REQUIRE_THROW( db_api.get_full_accounts_with_sections( names, { "history" }, false ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // full_accounts_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_evaluator.hpp>
+#include <graphene/chain/exceptions.hpp>
+#include <fc/io/json.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( genesis_accounts_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( genesis_accounts_test )
+{ try {
+    // Genesis accounts are created without their account_create_operation being evaluated:
+    const auto& accounts_by_name = db.get_index_type<account_index>().indices().get<by_name>();
+    for ( const auto& initial : genesis_state.initial_accounts )
+    {
+        const auto itr = accounts_by_name.find(initial.name);
+        BOOST_REQUIRE( itr != accounts_by_name.end() );
+        const account_object& account = *itr;
+        BOOST_CHECK( account.kind == account_kind::special );
+        BOOST_CHECK( account.owner == authority(1, initial.owner_key, 1) );
+        BOOST_CHECK( account.roll_back_enabled );
+        BOOST_CHECK_EQUAL( account.statistics(db).name, initial.name );
+        BOOST_CHECK( account.get_id() == account.statistics(db).owner );
+        BOOST_CHECK_EQUAL( account.is_lifetime_member(), initial.is_lifetime_member );
+
+        BOOST_CHECK_EQUAL( db.get_cycle_balance(account.id).value, 0 );
+        BOOST_CHECK_EQUAL( db.get_balance_object(account.id, get_dascoin_asset_id()).balance.value, 0 );
+        BOOST_CHECK_EQUAL( db.get_balance_object(account.id, get_web_asset_id()).balance.value, 0 );
+        BOOST_CHECK_EQUAL( db.get_balance_object(account.id, get_cycle_asset_id()).balance.value, 0 );
+    }
+
+    // They equal the accounts the evaluator creates from the same operations:
+    transaction_evaluation_state eval_state(&db);
+    eval_state.skip_chain_authority_check = true;
+    for ( const auto& initial : genesis_state.initial_accounts )
+    {
+        account_create_operation cop;
+        cop.name = initial.name + "evaluated";
+        cop.registrar = GRAPHENE_TEMP_ACCOUNT;
+        cop.owner = authority(1, initial.owner_key, 1);
+        cop.kind = static_cast<uint8_t>(account_kind::special);
+        cop.active = initial.active_key == public_key_type() ? cop.owner : authority(1, initial.active_key, 1);
+        cop.options.memo_key = initial.active_key == public_key_type() ? initial.owner_key : initial.active_key;
+        const account_id_type evaluated_id = db.apply_operation(eval_state, cop).get<object_id_type>();
+        if ( initial.is_lifetime_member )
+        {
+            account_upgrade_operation op;
+            op.account_to_upgrade = evaluated_id;
+            op.upgrade_to_lifetime_member = true;
+            db.apply_operation(eval_state, op);
+        }
+
+        const account_object& genesis = *accounts_by_name.find(initial.name);
+        account_object evaluated = evaluated_id(db);
+        BOOST_CHECK_EQUAL( evaluated.statistics(db).is_voting, genesis.statistics(db).is_voting );
+        BOOST_CHECK_EQUAL( db.get_balance_object(evaluated_id, get_web_asset_id()).balance.value, 0 );
+        // the fields that differ by construction, after that the objects must be the same
+        evaluated.id = genesis.id;
+        evaluated.name = genesis.name;
+        evaluated.statistics = genesis.statistics;
+        if ( initial.is_lifetime_member )
+            evaluated.registrar = evaluated.referrer = evaluated.lifetime_referrer = genesis.get_id();
+        BOOST_CHECK_EQUAL( fc::json::to_string(evaluated), fc::json::to_string(genesis) );
+    }
+
+    // The checks of the evaluator that depend on chain state still apply to genesis accounts:
+    account_create_operation unknown_authority;
+    unknown_authority.name = "unknownauthority";
+    unknown_authority.registrar = GRAPHENE_TEMP_ACCOUNT;
+    unknown_authority.owner = authority(1, account_id_type(1000000), 1);
+    unknown_authority.active = unknown_authority.owner;
+    GRAPHENE_REQUIRE_THROW( verify_account_create(db, unknown_authority), account_create_auth_account_not_found );
+    account_create_operation taken = unknown_authority;
+    taken.name = genesis_state.initial_accounts.front().name;
+    taken.owner = taken.active = authority(1, genesis_state.initial_accounts.front().owner_key, 1);
+    GRAPHENE_REQUIRE_THROW( verify_account_create(db, taken), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // genesis_accounts_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,395 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/app/api.hpp>
+#include <graphene/app/api_worker_pool.hpp>
+#include <graphene/account_history/account_history_plugin.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+struct history_dir_holder
+{
+  history_dir_holder() : history_dir( graphene::utilities::temp_directory_path() ) {}
+  fc::temp_directory history_dir;
+};
+
+boost::program_options::variables_map disk_history_options( const fc::path& dir )
+{
+  boost::program_options::variables_map options;
+  options.insert( std::make_pair( "history-backend", boost::program_options::variable_value( std::string( "disk" ), false ) ) );
+  options.insert( std::make_pair( "history-dir",
+                                  boost::program_options::variable_value( boost::filesystem::path( dir.generic_string() ), false ) ) );
+  return options;
+}
+
+/// account_history plugin started with history-backend=disk, the directory outlives the database
+struct disk_history_fixture : history_dir_holder, database_fixture
+{
+  disk_history_fixture() : database_fixture( disk_history_options( history_dir.path() ) ) {}
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( history_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( max_ops_per_account_test )
+{ try {
+  VAULT_ACTOR(vault)
+  generate_block();
+
+  auto plugin = app.get_plugin<graphene::account_history::account_history_plugin>("account_history");
+  graphene::account_history::history_retention retention;
+  retention.max_ops_per_account = 3;
+  plugin->set_retention(retention);
+
+  for( int i = 0; i < 6; ++i )
+  {
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+    generate_block();
+  }
+
+  const auto& stats = vault.statistics(db);
+  const uint32_t total_ops = stats.total_ops;
+  BOOST_CHECK_GT( total_ops, 3u );
+
+  // only the newest three nodes are left and they are still linked
+  const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+  auto itr = by_seq_idx.lower_bound( boost::make_tuple( vault_id, 0 ) );
+  BOOST_REQUIRE( itr != by_seq_idx.end() && itr->account == vault_id );
+  BOOST_CHECK_EQUAL( itr->sequence, total_ops - 2 );
+  BOOST_CHECK( itr->next == account_transaction_history_id_type() );
+
+  graphene::app::history_api hist_api(app);
+  auto history = hist_api.get_account_history(vault_id, operation_history_id_type(), 100, operation_history_id_type());
+  BOOST_CHECK_EQUAL( history.size(), 3u );
+  for( const auto& op : history )
+    BOOST_CHECK_EQUAL( op.op.which(), operation::tag<submit_reserve_cycles_to_queue_operation>::value );
+
+  auto relative = hist_api.get_relative_account_history(vault_id, 0, 100, 0);
+  BOOST_CHECK_LE( relative.size(), 3u );
+
+  // operations still referenced by the cycle issuer's history are kept, pruned ones are gone
+  const auto& by_opid_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_opid>();
+  for( const auto& oho : db.get_index_type<operation_history_index>().indices() )
+    if( !oho.virtual_op && oho.op.which() == operation::tag<submit_reserve_cycles_to_queue_operation>::value )
+      BOOST_CHECK( by_opid_idx.find( oho.id ) != by_opid_idx.end() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( history_max_age_blocks_test )
+{ try {
+  VAULT_ACTOR(vault)
+  generate_block();
+
+  auto plugin = app.get_plugin<graphene::account_history::account_history_plugin>("account_history");
+  graphene::account_history::history_retention retention;
+  retention.max_age_blocks = 2;
+  plugin->set_retention(retention);
+
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+  generate_block();
+  const uint32_t op_block = db.head_block_num();
+
+  graphene::app::history_api hist_api(app);
+  BOOST_CHECK( !hist_api.get_account_history(vault_id, operation_history_id_type(), 100, operation_history_id_type()).empty() );
+
+  generate_blocks(3);
+
+  // nothing older than the window is left, and the account no longer points at removed nodes
+  for( const auto& oho : db.get_index_type<operation_history_index>().indices() )
+    BOOST_CHECK_GT( oho.block_num, op_block );
+  BOOST_CHECK( vault.statistics(db).most_recent_op == account_transaction_history_id_type() );
+  BOOST_CHECK( hist_api.get_account_history(vault_id, operation_history_id_type(), 100, operation_history_id_type()).empty() );
+  BOOST_CHECK( hist_api.get_relative_account_history(vault_id, 0, 100, 0).empty() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( get_account_history_by_operation_test )
+{ try {
+  VAULT_ACTOR(vault)
+  generate_block();
+
+  const int submit_type = operation::tag<submit_reserve_cycles_to_queue_operation>::value;
+  for( int i = 0; i < 5; ++i )
+  {
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+    generate_block();
+  }
+
+  // every node carries the type of its operation
+  const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+  for( auto itr = by_seq_idx.lower_bound( boost::make_tuple( vault_id, 0 ) ); itr != by_seq_idx.end() && itr->account == vault_id; ++itr )
+    BOOST_CHECK_EQUAL( itr->operation_type, itr->operation_id(db).op.which() );
+
+  graphene::app::history_api hist_api(app);
+  auto history = hist_api.get_account_history_by_operation(vault_id, {static_cast<uint32_t>(submit_type)},
+                                                          operation_history_id_type(), 100, operation_history_id_type());
+  BOOST_REQUIRE_EQUAL( history.size(), 5u );
+  for( size_t i = 1; i < history.size(); ++i )
+    BOOST_CHECK( history[i-1].id > history[i].id );
+
+  // start and stop bound the range just like in get_account_history
+  auto newest_two = hist_api.get_account_history_by_operation(vault_id, {static_cast<uint32_t>(submit_type)},
+                                                             history[2].id, 100, operation_history_id_type());
+  BOOST_REQUIRE_EQUAL( newest_two.size(), 2u );
+  BOOST_CHECK( newest_two[0].id == history[0].id );
+
+  auto from_middle = hist_api.get_account_history_by_operation(vault_id, {static_cast<uint32_t>(submit_type)},
+                                                              operation_history_id_type(), 2, history[1].id);
+  BOOST_REQUIRE_EQUAL( from_middle.size(), 2u );
+  BOOST_CHECK( from_middle[0].id == history[1].id );
+  BOOST_CHECK( from_middle[1].id == history[2].id );
+
+  // the account creation is found through its own type
+  auto created = hist_api.get_account_history_by_operation(vault_id, {static_cast<uint32_t>(operation::tag<account_create_operation>::value)},
+                                                          operation_history_id_type(), 100, operation_history_id_type());
+  BOOST_CHECK_EQUAL( created.size(), 1u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( history_store_test )
+{ try {
+  VAULT_ACTOR(vault)
+  generate_block();
+
+  for( int i = 0; i < 3; ++i )
+  {
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+    generate_block();
+  }
+
+  fc::temp_directory temp_dir( graphene::utilities::temp_directory_path() );
+  const auto& by_id_idx = db.get_index_type<operation_history_index>().indices().get<by_id>();
+  const auto& by_opid_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_opid>();
+  auto append_all = [&]( graphene::account_history::history_store& store ) {
+    for( const operation_history_object& op : by_id_idx )
+    {
+      vector<account_transaction_history_object> nodes;
+      for( auto itr = by_opid_idx.lower_bound( op.id ); itr != by_opid_idx.end() && itr->operation_id == op.id; ++itr )
+        nodes.push_back( *itr );
+      store.append( op, nodes );
+    }
+  };
+
+  uint64_t record_count = 0;
+  {
+    graphene::account_history::history_store store;
+    store.open( temp_dir.path() );
+    append_all( store );
+    record_count = store.record_count();
+    BOOST_CHECK_GT( record_count, 0u );
+    BOOST_REQUIRE( store.last_operation().valid() );
+    BOOST_CHECK( *store.last_operation() == by_id_idx.rbegin()->id );
+    store.close();
+  }
+
+  graphene::account_history::history_store store;
+  store.open( temp_dir.path() );
+  BOOST_CHECK_EQUAL( store.record_count(), record_count );
+
+  // appending the same operations again changes nothing
+  append_all( store );
+  BOOST_CHECK_EQUAL( store.record_count(), record_count );
+
+  // the account chain on disk matches the in memory history, newest first
+  const auto& stats = vault.statistics(db);
+  const account_transaction_history_object* node = &stats.most_recent_op(db);
+  uint64_t position = store.newest_record( vault_id );
+  while( node != nullptr )
+  {
+    BOOST_REQUIRE( position != 0 );
+    const auto record = store.fetch_record( position );
+    BOOST_CHECK_EQUAL( record.sequence, node->sequence );
+    BOOST_CHECK_EQUAL( record.operation, node->operation_id.instance.value );
+    const auto op = store.fetch_operation( node->operation_id );
+    BOOST_REQUIRE( op.valid() );
+    BOOST_CHECK_EQUAL( op->op.which(), node->operation_id(db).op.which() );
+    BOOST_CHECK_EQUAL( op->block_num, node->operation_id(db).block_num );
+    position = record.previous;
+    node = node->next == account_transaction_history_id_type() ? nullptr : &node->next(db);
+  }
+  BOOST_CHECK_EQUAL( position, 0u );
+
+  // the per type chain only visits operations of that type
+  const uint16_t submit_type = operation::tag<submit_reserve_cycles_to_queue_operation>::value;
+  uint32_t submits = 0;
+  for( position = store.newest_record( vault_id, submit_type ); position != 0; ++submits )
+  {
+    const auto record = store.fetch_record( position );
+    BOOST_CHECK_EQUAL( record.operation_type, submit_type );
+    position = record.previous_of_type;
+  }
+  BOOST_CHECK_EQUAL( submits, 3u );
+
+  BOOST_CHECK( !store.fetch_operation( by_id_idx.rbegin()->id + 1 ).valid() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( disk_history_backend_test, disk_history_fixture )
+{ try {
+  auto plugin = app.get_plugin<graphene::account_history::account_history_plugin>("account_history");
+  BOOST_REQUIRE( plugin->get_history_store() != nullptr );
+
+  VAULT_ACTOR(vault)
+  generate_block();
+  for( int i = 0; i < 3; ++i )
+  {
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+    generate_block();
+  }
+
+  graphene::app::history_api hist_api(app);
+  const uint16_t submit_type = operation::tag<submit_reserve_cycles_to_queue_operation>::value;
+  const auto expected = hist_api.get_account_history(vault_id, operation_history_id_type(), 100, operation_history_id_type());
+  BOOST_REQUIRE_GE( expected.size(), 4u );
+  const operation_history_id_type newest = expected.front().id;
+  const uint32_t total_ops = vault.statistics(db).total_ops;
+  const auto expected_of_type = hist_api.get_account_history_by_operation(vault_id, {submit_type}, operation_history_id_type(), 100, newest);
+  const auto expected_relative = hist_api.get_relative_account_history(vault_id, 0, 100, total_ops);
+  BOOST_REQUIRE_EQUAL( expected_of_type.size(), 3u );
+  BOOST_CHECK( db.find( newest ) != nullptr );
+
+  // once their blocks are irreversible the operations leave the object database for the store
+  for( int i = 0; i < 100 && db.get_dynamic_global_properties().last_irreversible_block_num < expected.front().block_num; ++i )
+    generate_block();
+  BOOST_REQUIRE_GE( db.get_dynamic_global_properties().last_irreversible_block_num, expected.front().block_num );
+  BOOST_CHECK( db.find( newest ) == nullptr );
+  BOOST_CHECK_GE( plugin->get_history_store()->record_count(), expected.size() );
+
+  // the API reads them back from disk
+  auto check_same = []( const vector<operation_history_object>& actual, const vector<operation_history_object>& wanted ) {
+    BOOST_REQUIRE_EQUAL( actual.size(), wanted.size() );
+    for( size_t i = 0; i < actual.size(); ++i )
+    {
+      BOOST_CHECK( actual[i].id == wanted[i].id );
+      BOOST_CHECK_EQUAL( actual[i].op.which(), wanted[i].op.which() );
+      BOOST_CHECK_EQUAL( actual[i].block_num, wanted[i].block_num );
+    }
+  };
+  check_same( hist_api.get_account_history(vault_id, operation_history_id_type(), 100, newest), expected );
+  check_same( hist_api.get_account_history_by_operation(vault_id, {submit_type}, operation_history_id_type(), 100, newest),
+              expected_of_type );
+  check_same( hist_api.get_relative_account_history(vault_id, 0, 100, total_ops), expected_relative );
+
+  // paging continues across calls
+  const auto first_page = hist_api.get_account_history(vault_id, operation_history_id_type(), 2, newest);
+  BOOST_REQUIRE_EQUAL( first_page.size(), 2u );
+  const auto second_page = hist_api.get_account_history(vault_id, operation_history_id_type(), 2, operation_history_id_type( first_page.back().id.instance.value - 1 ));
+  BOOST_REQUIRE( !second_page.empty() );
+  BOOST_CHECK( second_page.front().id == expected[2].id );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( disk_history_popped_block_test, disk_history_fixture )
+{ try {
+  VAULT_ACTOR(vault)
+  generate_block();
+  for( int i = 0; i < 3; ++i )
+  {
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+    generate_block();
+  }
+
+  graphene::app::history_api hist_api(app);
+  const uint16_t submit_type = operation::tag<submit_reserve_cycles_to_queue_operation>::value;
+  const auto expected = hist_api.get_account_history(vault_id, operation_history_id_type(), 100, operation_history_id_type());
+  const operation_history_id_type newest = expected.front().id;
+  const uint32_t total_ops = vault.statistics(db).total_ops;
+  const auto expected_of_type = hist_api.get_account_history_by_operation(vault_id, {submit_type}, operation_history_id_type(), 100, newest);
+  const auto expected_relative = hist_api.get_relative_account_history(vault_id, 0, 100, total_ops);
+
+  // stop at the block that moved the newest operation to disk
+  for( int i = 0; i < 100 && db.find( newest ) != nullptr; ++i )
+    generate_block();
+  BOOST_REQUIRE( db.find( newest ) == nullptr );
+
+  auto check_same = []( const vector<operation_history_object>& actual, const vector<operation_history_object>& wanted ) {
+    BOOST_REQUIRE_EQUAL( actual.size(), wanted.size() );
+    for( size_t i = 0; i < actual.size(); ++i )
+      BOOST_CHECK( actual[i].id == wanted[i].id );
+  };
+  auto check_history = [&]() {
+    check_same( hist_api.get_account_history(vault_id, operation_history_id_type(), 100, newest), expected );
+    check_same( hist_api.get_account_history_by_operation(vault_id, {submit_type}, operation_history_id_type(), 100, newest),
+                expected_of_type );
+    check_same( hist_api.get_relative_account_history(vault_id, 0, 100, total_ops), expected_relative );
+  };
+
+  // popping it brings the operations back in memory while the store keeps them, each is returned once
+  db.pop_block();
+  BOOST_REQUIRE( db.find( newest ) != nullptr );
+  check_history();
+
+  generate_block();
+  BOOST_CHECK( db.find( newest ) == nullptr );
+  check_history();
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( api_worker_pool_test )
+{ try {
+  VAULT_ACTOR(vault)
+  generate_block();
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+  generate_block();
+
+  graphene::app::api_worker_pool pool( db, 2 );
+  fc::api<graphene::app::history_api> offloaded( std::make_shared<graphene::app::history_api>( app ) );
+  pool.offload( offloaded, {} );
+
+  graphene::app::history_api hist_api(app);
+  const auto expected = hist_api.get_account_history(vault_id, operation_history_id_type(), 100, operation_history_id_type());
+  BOOST_REQUIRE( !expected.empty() );
+  for( int i = 0; i < 4; ++i )
+  {
+    const auto history = offloaded->get_account_history(vault_id, operation_history_id_type(), 100, operation_history_id_type());
+    BOOST_REQUIRE_EQUAL( history.size(), expected.size() );
+    BOOST_CHECK( history.front().id == expected.front().id );
+  }
+
+  // errors raised on the worker reach the caller
+  GRAPHENE_REQUIRE_THROW( offloaded->get_account_history(vault_id, operation_history_id_type(), 1000, operation_history_id_type()), fc::exception );
+
+  // the worker result reflects blocks applied in between
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+  generate_block();
+  BOOST_CHECK_GT( offloaded->get_account_history(vault_id, operation_history_id_type(), 100, operation_history_id_type()).size(),
+                  expected.size() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::history_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
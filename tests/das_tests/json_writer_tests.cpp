@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/app/database_api.hpp>
+#include <graphene/app/json_api_connection.hpp>
+#include <graphene/app/json_writer.hpp>
+
+#include <fc/io/json.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+template<typename T>
+std::string to_json( const T& value )
+{
+  graphene::app::json_writer out;
+  out.write( value );
+  return out.str();
+}
+
+template<typename T>
+void check_same_json( const T& value )
+{
+  BOOST_CHECK_EQUAL( to_json( value ), fc::json::to_string( fc::variant( value, GRAPHENE_MAX_NESTED_OBJECTS ) ) );
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( json_writer_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( leaf_types_test )
+{ try {
+  BOOST_CHECK_EQUAL( to_json( true ), "true" );
+  BOOST_CHECK_EQUAL( to_json( int64_t(-5) ), "-5" );
+  BOOST_CHECK_EQUAL( to_json( uint64_t(0xffffffff) ), "4294967295" );
+  BOOST_CHECK_EQUAL( to_json( uint64_t(0x100000000) ), "\"4294967296\"" );
+  BOOST_CHECK_EQUAL( to_json( int64_t(-0x100000000) ), "\"-4294967296\"" );
+  check_same_json( std::string("quote \" backslash \\ newline \n tab \t bell \a") );
+  check_same_json( share_type(123456789012345) );
+  check_same_json( account_id_type(42) );
+  check_same_json( object_id_type(account_id_type(42)) );
+  check_same_json( fc::time_point_sec(1500000000) );
+  check_same_json( optional<asset>() );
+  check_same_json( optional<asset>( asset(5, get_dascoin_asset_id()) ) );
+  check_same_json( vector<char>{ 'a', 'b', 0 } );
+  check_same_json( flat_map<account_id_type, share_type>{ {account_id_type(1), 2}, {account_id_type(3), 4} } );
+  check_same_json( operation( transfer_operation() ) );
+  check_same_json( init_account_pub_key );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( api_results_test )
+{ try {
+  VAULT_ACTOR(vault)
+  ACTOR(wallet)
+  generate_block();
+  for( int i = 0; i < 3; ++i )
+  {
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), vault_id, 200, 200, ""));
+    generate_block();
+  }
+
+  graphene::app::application_options app_options;
+  graphene::app::database_api db_api(db, &app_options);
+
+  check_same_json( db_api.get_blocks( 1, db.head_block_num() ) );
+  check_same_json( db_api.get_vaults_info( { vault_id, wallet_id, account_id_type(999999) } ) );
+  check_same_json( db_api.get_full_accounts( { "vault", "wallet" }, false ) );
+  check_same_json( db_api.get_accounts( { vault_id, wallet_id } ) );
+  check_same_json( db_api.get_dynamic_global_properties() );
+  check_same_json( db_api.get_global_properties() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( method_table_test )
+{ try {
+  VAULT_ACTOR(vault)
+  generate_block();
+
+  graphene::app::application_options app_options;
+  fc::api<graphene::app::database_api> api( std::make_shared<graphene::app::database_api>( std::ref(db), &app_options ) );
+  graphene::app::json_method_table<graphene::app::database_api> table( api, GRAPHENE_MAX_NESTED_OBJECTS );
+
+  // callbacks and void methods stay with fc
+  BOOST_CHECK( table.find( "set_subscribe_callback" ) == nullptr );
+  BOOST_CHECK( table.find( "cancel_all_subscriptions" ) == nullptr );
+
+  const auto* get_blocks = table.find( "get_blocks" );
+  BOOST_REQUIRE( get_blocks != nullptr );
+  graphene::app::json_writer out;
+  (*get_blocks)( fc::variants{ fc::variant(1), fc::variant(db.head_block_num()) }, out );
+  BOOST_CHECK_EQUAL( out.str(), fc::json::to_string( fc::variant( api->get_blocks( 1, db.head_block_num() ), GRAPHENE_MAX_NESTED_OBJECTS ) ) );
+
+  const auto* get_vaults_info = table.find( "get_vaults_info" );
+  BOOST_REQUIRE( get_vaults_info != nullptr );
+  graphene::app::json_writer vault_out;
+  (*get_vaults_info)( fc::variants{ fc::variant( vector<account_id_type>{ vault_id }, 2 ) }, vault_out );
+  BOOST_CHECK_EQUAL( vault_out.str(), fc::json::to_string( fc::variant( api->get_vaults_info( { vault_id } ), GRAPHENE_MAX_NESTED_OBJECTS ) ) );
+
+  graphene::app::json_writer bad_out;
+  GRAPHENE_REQUIRE_THROW( (*get_blocks)( fc::variants{ fc::variant(1) }, bad_out ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::json_writer_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
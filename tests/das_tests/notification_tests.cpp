@@ -0,0 +1,192 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/app/database_api.hpp>
+#include <graphene/app/notification_cache.hpp>
+#include <graphene/app/object_cache.hpp>
+#include <graphene/app/subscription_router.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/thread/thread.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/// notifications are delivered by fc::async on this thread, lets them run until @p done holds or the deadline passes
+template<typename Condition>
+bool wait_for( Condition done, fc::microseconds timeout = fc::seconds(5) )
+{
+  const fc::time_point deadline = fc::time_point::now() + timeout;
+  while( !done() && fc::time_point::now() < deadline )
+    fc::usleep( fc::milliseconds(1) );
+  return done();
+}
+
+/// runs every notification queued so far, fc runs the tasks of a thread in the order they were posted
+void run_queued_notifications()
+{
+  fc::async( []{} ).wait( fc::seconds(5) );
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( notification_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( shared_encoding_test )
+{ try {
+  uint32_t notices1 = 0;
+  uint32_t notices2 = 0;
+
+  graphene::app::application_options app_options;
+  auto notifications = std::make_shared<graphene::app::notification_cache>( db );
+  graphene::app::database_api db_api1( db, &app_options, notifications );
+  graphene::app::database_api db_api2( db, &app_options, notifications );
+  db_api1.set_subscribe_callback( [&]( const variant& ){ ++notices1; }, false );
+  db_api2.set_subscribe_callback( [&]( const variant& ){ ++notices2; }, false );
+
+  // both sessions watch the dynamic global properties, which change with every block
+  const vector<object_id_type> ids{ dynamic_global_property_id_type() };
+  db_api1.get_objects( ids );
+  db_api2.get_objects( ids );
+
+  generate_block();
+  const uint32_t measured_block = db.head_block_num();
+  generate_block();
+
+  const graphene::app::notification_metrics metrics = db_api1.get_notification_metrics();
+  BOOST_CHECK_EQUAL( metrics.block_num, measured_block );
+  BOOST_CHECK_GE( metrics.rounds, 1u );
+  BOOST_CHECK_GE( metrics.objects_serialized, 1u );
+  BOOST_CHECK_GE( metrics.cache_hits, 1u );
+  BOOST_CHECK_GE( metrics.sessions_notified, 2u );
+  BOOST_CHECK_EQUAL( db_api2.get_notification_metrics().cache_hits, metrics.cache_hits );
+
+  BOOST_CHECK( wait_for( [&]{ return notices1 >= 2u; } ) );
+  run_queued_notifications();
+  BOOST_CHECK_EQUAL( notices1, notices2 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( subscription_router_test )
+{ try {
+  vector<variant> notices1;
+  uint32_t notices2 = 0;
+
+  graphene::app::application_options app_options;
+  auto router = std::make_shared<graphene::app::subscription_router>( db );
+  {
+    graphene::app::database_api db_api1( db, &app_options, nullptr, router );
+    graphene::app::database_api db_api2( db, &app_options, nullptr, router );
+    BOOST_CHECK_EQUAL( router->session_count(), 0u );
+
+    db_api1.set_subscribe_callback( [&]( const variant& v ){ notices1.push_back( v ); }, false );
+    db_api2.set_subscribe_callback( [&]( const variant& ){ ++notices2; }, false );
+    BOOST_CHECK_EQUAL( router->session_count(), 2u );
+
+    db_api1.get_objects( { dynamic_global_property_id_type() } );
+
+    // only the subscribed session hears about the dynamic global properties
+    generate_block();
+    BOOST_CHECK( wait_for( [&]{ return !notices1.empty(); } ) );
+    run_queued_notifications();
+    BOOST_CHECK_EQUAL( notices2, 0u );
+
+    // a reset callback drops the earlier subscriptions
+    db_api1.set_subscribe_callback( [&]( const variant& v ){ notices1.push_back( v ); }, false );
+    notices1.clear();
+    generate_block();
+    run_queued_notifications();
+    BOOST_CHECK( notices1.empty() );
+  }
+  BOOST_CHECK_EQUAL( router->session_count(), 0u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( object_cache_test )
+{ try {
+  graphene::app::application_options app_options;
+  auto objects = std::make_shared<graphene::app::object_cache>();
+  objects->observe<dynamic_global_property_object>( db );
+  objects->observe<asset_dynamic_data_object>( db );
+  graphene::app::database_api db_api( db, &app_options, nullptr, nullptr, objects );
+
+  // accounts are not observed here and always go to the database
+  const vector<object_id_type> ids{ dynamic_global_property_id_type(), asset_dynamic_data_id_type(), account_id_type() };
+  const auto first = db_api.get_objects( ids );
+  const auto second = db_api.get_objects( ids );
+  BOOST_CHECK_EQUAL( objects->misses(), 2 );
+  BOOST_CHECK_EQUAL( objects->hits(), 2 );
+  BOOST_CHECK_EQUAL( objects->size(), 2 );
+  BOOST_CHECK_EQUAL( fc::json::to_string( first ), fc::json::to_string( second ) );
+
+  // applying a block modifies the dynamic global properties
+  generate_block();
+  const auto third = db_api.get_objects( ids );
+  BOOST_CHECK_EQUAL( third[0]["head_block_number"].as_uint64(), db.head_block_num() );
+
+  // undone changes are dropped as well
+  const int64_t supply = asset_dynamic_data_id_type()(db).current_supply.value;
+  {
+    auto session = db._undo_db.start_undo_session();
+    db.modify( asset_dynamic_data_id_type()(db), []( asset_dynamic_data_object& d ){ d.current_supply += 1; } );
+    BOOST_CHECK_EQUAL( db_api.get_objects( ids )[1]["current_supply"].as<share_type>( 1 ).value, supply + 1 );
+  }
+  BOOST_CHECK_EQUAL( db_api.get_objects( ids )[1]["current_supply"].as<share_type>( 1 ).value, supply );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( object_cache_eviction_test )
+{ try {
+  graphene::app::application_options app_options;
+  auto objects = std::make_shared<graphene::app::object_cache>( 2 );
+  objects->observe<account_object>( db );
+  graphene::app::database_api db_api( db, &app_options, nullptr, nullptr, objects );
+  const object_id_type a0 = account_id_type( 0 ), a1 = account_id_type( 1 ), a2 = account_id_type( 2 );
+
+  db_api.get_objects( { a0, a1 } );
+  db_api.get_objects( { a0 } );
+  BOOST_CHECK_EQUAL( objects->misses(), 2 );
+  BOOST_CHECK_EQUAL( objects->hits(), 1 );
+
+  // the cache is full, the least recently read account makes room
+  db_api.get_objects( { a2 } );
+  BOOST_CHECK_EQUAL( objects->size(), 2 );
+  BOOST_CHECK_EQUAL( objects->evictions(), 1 );
+  db_api.get_objects( { a0 } );
+  BOOST_CHECK_EQUAL( objects->hits(), 2 );
+  db_api.get_objects( { a1 } );
+  BOOST_CHECK_EQUAL( objects->misses(), 4 );
+  BOOST_CHECK_EQUAL( objects->evictions(), 2 );
+  BOOST_CHECK_EQUAL( objects->size(), 2 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::notification_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/virtual_op_object.hpp>
+#include <graphene/app/database_api.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( state_digest_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( state_digest_test )
+{ try {
+    // the digests kept up to date equal the ones hashed from scratch
+    auto check_digests = [&]() {
+        std::map<std::pair<uint8_t, uint8_t>, fc::uint128> tracked;
+        db.inspect_all_indexes([&](const graphene::db::index& idx) {
+            tracked[std::make_pair(idx.object_space_id(), idx.object_type_id())] = idx.state_digest();
+        });
+        const bool tracking = db.tracks_state_digest();
+        db.track_state_digest(false);
+        db.inspect_all_indexes([&](const graphene::db::index& idx) {
+            BOOST_CHECK( idx.state_digest() == tracked[std::make_pair(idx.object_space_id(), idx.object_type_id())] );
+        });
+        db.track_state_digest(tracking);
+    };
+
+    const fc::sha256 before = db.state_digest();
+    db.track_state_digest(true);
+    BOOST_CHECK( db.tracks_state_digest() );
+    BOOST_CHECK_EQUAL( db.state_digest().str(), before.str() );
+
+    // Objects are created, modified and removed:
+    VAULT_ACTOR(bob);
+    adjust_dascoin_reward(500 * DASCOIN_DEFAULT_ASSET_PRECISION);
+    adjust_frequency(200);
+    do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), bob_id, 200, 200, ""));
+    toggle_reward_queue(true);
+    generate_blocks(db.head_block_time() + fc::seconds(get_chain_parameters().reward_interval_time_seconds * 2));
+    check_digests();
+    BOOST_CHECK( db.state_digest() != before );
+
+    // Undoing a block takes the digest back:
+    const fc::sha256 head_digest = db.state_digest();
+    generate_block();
+    db.pop_block();
+    check_digests();
+    BOOST_CHECK_EQUAL( db.state_digest().str(), head_digest.str() );
+
+    db.track_state_digest(false);
+    generate_block();
+    check_digests();
+
+    // Node local objects are not part of the digest, whether it is tracked or not:
+    BOOST_CHECK( !db.covered_by_state_digest(implementation_ids, impl_virtual_op_object_type) );
+    BOOST_CHECK( !db.covered_by_state_digest(protocol_ids, operation_history_object_type) );
+    BOOST_CHECK( db.covered_by_state_digest(protocol_ids, account_object_type) );
+    for ( bool tracked : { false, true } )
+    {
+        db.track_state_digest(tracked);
+        const fc::sha256 digest = db.state_digest();
+        const auto& vop = db.create<virtual_op_object>([&](virtual_op_object& o) {
+            o.block_num = db.head_block_num();
+        });
+        BOOST_CHECK_EQUAL( db.state_digest().str(), digest.str() );
+        db.remove(vop);
+    }
+    db.track_state_digest(false);
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( state_digest_leaves_out_node_local_state_test )
+{ try {
+    VAULT_ACTOR(bob);
+    generate_block();
+    db.track_state_digest(true);
+
+    // The history fields of account statistics depend on the plugins of a node:
+    const auto& stats = bob.statistics(db);
+    const fc::sha256 digest = db.state_digest();
+    db.modify(stats, [](account_statistics_object& s) {
+        s.total_ops += 10;
+        s.most_recent_op = account_transaction_history_id_type(12345);
+    });
+    BOOST_CHECK_EQUAL( db.state_digest().str(), digest.str() );
+    db.modify(stats, [](account_statistics_object& s) { s.lifetime_fees_paid += 1; });
+    BOOST_CHECK( db.state_digest() != digest );
+    generate_block();
+
+    // Pending transactions are not part of the head state digest:
+    const fc::sha256 head_digest = db.head_state_digest();
+    BOOST_CHECK_EQUAL( head_digest.str(), db.state_digest().str() );
+    create_new_account(get_registrar_id(), "pending", init_account_pub_key);
+    BOOST_CHECK( db.state_digest() != head_digest );
+    BOOST_CHECK_EQUAL( db.head_state_digest().str(), head_digest.str() );
+
+    graphene::app::application_options app_options;
+    graphene::app::database_api db_api(db, &app_options);
+    const auto reported = db_api.get_state_digest();
+    BOOST_CHECK_EQUAL( reported.head_block_num, db.head_block_num() );
+    BOOST_CHECK_EQUAL( reported.digest.str(), head_digest.str() );
+
+    // Without tracking the public call does not hash the whole state:
+    db.track_state_digest(false);
+    GRAPHENE_REQUIRE_THROW( db_api.get_state_digest(), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // state_digest_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
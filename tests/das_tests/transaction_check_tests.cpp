@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( transaction_check_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( prevalidate_pending_transactions_test )
+{ try {
+    // Enough transactions to be checked on several threads:
+    const uint32_t count = 64;
+    auto push = [&]( uint32_t first, uint32_t last ) {
+        for ( uint32_t i = first; i < last; ++i )
+        {
+            signed_transaction trx;
+            set_expiration(db, trx);
+            trx.operations.push_back(make_account(account_kind::wallet, get_registrar_id(), "prevalidated" + fc::to_string(i)));
+            db.push_transaction(trx, ~0);
+        }
+    };
+
+    // The checks run in the background, an unchanged pool is not checked again:
+    push( 0, count / 2 );
+    db.prevalidate_pending_transactions();
+    db.prevalidate_pending_transactions();
+    // Transactions arriving while the checks run are left to generate_block() or to the next call:
+    push( count / 2, count );
+    db.prevalidate_pending_transactions();
+
+    const auto block = db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, ~0);
+    BOOST_CHECK_EQUAL( block.transactions.size(), count );
+    BOOST_CHECK( fc::raw::pack_size(block) <= db.get_global_properties().parameters.maximum_block_size );
+    const auto& accounts_by_name = db.get_index_type<account_index>().indices().get<by_name>();
+    for ( uint32_t i = 0; i < count; ++i )
+        BOOST_CHECK( accounts_by_name.find("prevalidated" + fc::to_string(i)) != accounts_by_name.end() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( block_transactions_checked_in_parallel_test )
+{ try {
+    // Enough transactions for the checks of the block to be split across the worker pool:
+    const uint32_t count = 300;
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+        signed_transaction trx;
+        set_expiration(db, trx);
+        trx.operations.push_back(make_account(account_kind::wallet, get_registrar_id(), "checked" + fc::to_string(i)));
+        db.push_transaction(trx, ~0);
+    }
+    const auto block = db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, ~0);
+    BOOST_REQUIRE_EQUAL( block.transactions.size(), count );
+    const fc::sha256 digest = db.state_digest();
+    db.pop_block();
+    db.clear_pending();
+
+    // A block with a transaction that fails validate() does not apply:
+    signed_block bad_block = block;
+    bad_block.transactions.insert(bad_block.transactions.begin() + count / 2, processed_transaction());
+    BOOST_CHECK_THROW( db.push_block(bad_block, ~0), fc::exception );
+    BOOST_CHECK( db.head_block_id() == block.previous );
+
+    // Checked serially or split across threads, the block gives the state it was generated with:
+    for ( size_t threads : { 1, 4, 0 } )
+    {
+        db.set_worker_threads(threads);
+        db.push_block(block, ~0);
+        BOOST_CHECK( db.head_block_id() == block.id() );
+        BOOST_CHECK_EQUAL( db.state_digest().str(), digest.str() );
+        if ( threads != 0 )
+        {
+            db.pop_block();
+            db.clear_pending();
+        }
+    }
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( resigned_transaction_checked_again_test )
+{ try {
+    const auto registrar_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("sys.registrar")));
+    signed_transaction trx;
+    set_expiration(db, trx);
+    trx.operations.push_back(make_account(account_kind::wallet, get_registrar_id(), "resigned"));
+    signed_transaction forged = trx;
+    trx.sign(registrar_key, db.get_chain_id());
+    forged.sign(generate_private_key("forger"), db.get_chain_id());
+    BOOST_REQUIRE( forged.id() == trx.id() );
+
+    // A block with the copy signed by the wrong key, generated without checking signatures:
+    db.push_transaction(forged, ~0);
+    const auto block = db.generate_block(db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, ~0);
+    BOOST_REQUIRE_EQUAL( block.transactions.size(), 1u );
+    db.pop_block();
+    db.clear_pending();
+
+    // The correctly signed copy is pending and the keys of its signatures are kept:
+    db.push_transaction(trx);
+    db.prevalidate_pending_transactions();
+    db.set_worker_threads(1);               // waits for the checks
+    db.prevalidate_pending_transactions();  // keeps their results
+
+    // The copy in the block has the same id, but its own signatures are checked and do not authorize it:
+    BOOST_CHECK_THROW( db.push_block(block, database::skip_witness_signature), fc::exception );
+    BOOST_CHECK( db.head_block_id() == block.previous );
+
+    // The correctly signed copy still goes through:
+    generate_block();
+    BOOST_CHECK( db.get_index_type<account_index>().indices().get<by_name>().count("resigned") == 1 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // transaction_check_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,151 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/app/api.hpp>
+#include <graphene/wallet/wallet.hpp>
+
+#include <graphene/utilities/key_conversion.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using graphene::wallet::utility;
+
+namespace {
+
+// a wallet talking to the fixture's node through the same APIs a remote one would log into
+std::shared_ptr<graphene::wallet::wallet_api> connect_wallet( graphene::app::application& app, const fc::path& dir )
+{
+  graphene::app::api_access_info access;
+  access.password_hash_b64 = "*";
+  access.password_salt_b64 = "*";
+  access.allowed_apis.push_back( "database_api" );
+  access.allowed_apis.push_back( "network_broadcast_api" );
+  access.allowed_apis.push_back( "history_api" );
+  app.set_api_access_info( "*", std::move( access ) );
+
+  auto login = std::make_shared<graphene::app::login_api>( app );
+  FC_ASSERT( login->login( "", "" ) );
+
+  graphene::wallet::wallet_data data;
+  data.chain_id = app.chain_database()->get_chain_id();
+  auto wallet = std::make_shared<graphene::wallet::wallet_api>( data, fc::api<graphene::app::login_api>( login ) );
+  wallet->set_wallet_filename( ( dir / "wallet.json" ).generic_string() );
+  wallet->set_password( "supersecret" );
+  wallet->unlock( "supersecret" );
+  return wallet;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( wallet_batch_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( batch_window_size_test )
+{ try {
+  // fast round trips fill the whole window:
+  BOOST_CHECK_EQUAL( utility::batch_window_size( 10, fc::milliseconds(1) ), 1000u );
+  BOOST_CHECK_EQUAL( utility::batch_window_size( 1, fc::microseconds() ), 1000u );
+
+  // slow ones leave only as many rounds of max_in_flight broadcasts as end in ten seconds:
+  BOOST_CHECK_EQUAL( utility::batch_window_size( 10, fc::milliseconds(500) ), 200u );
+  BOOST_CHECK_EQUAL( utility::batch_window_size( 4, fc::seconds(5) ), 8u );
+
+  // a round trip beyond that still sends one round, and no window is bigger than 1000 transactions:
+  BOOST_CHECK_EQUAL( utility::batch_window_size( 4, fc::seconds(20) ), 4u );
+  BOOST_CHECK_EQUAL( utility::batch_window_size( 5000, fc::seconds(20) ), 1000u );
+
+  GRAPHENE_REQUIRE_THROW( utility::batch_window_size( 0, fc::milliseconds(1) ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( sign_and_broadcast_batch_test )
+{ try {
+  VAULT_ACTOR(vault);
+  ACTOR(wallet);
+  CUSTODIAN_ACTOR(custodian);
+
+  tether_accounts(wallet_id, vault_id);
+  issue_dascoin(vault_id, 100);
+  db.adjust_balance_limit(vault, get_dascoin_asset_id(), 100 * DASCOIN_DEFAULT_ASSET_PRECISION);
+  transfer_dascoin_vault_to_wallet(vault_id, wallet_id, 50 * DASCOIN_DEFAULT_ASSET_PRECISION);
+  generate_block();
+
+  fc::temp_directory wallet_dir( graphene::utilities::temp_directory_path() );
+  auto wapi = connect_wallet( app, wallet_dir.path() );
+  BOOST_REQUIRE( wapi->import_key( "wallet", graphene::utilities::key_to_wif( wallet_private_key ) ) );
+
+  const auto make_transfer = [&]( share_type amount ) {
+    transfer_operation op;
+    op.from = wallet_id;
+    op.to = custodian_id;
+    op.amount = asset{ amount, get_dascoin_asset_id() };
+    return operation( op );
+  };
+
+  // More transactions than broadcasts in flight, a transfer of nothing fails validate() and does not stop the others:
+  vector<operation> ops;
+  for( int64_t amount = 1; amount <= 20; ++amount )
+    ops.push_back( make_transfer( amount == 7 ? 0 : amount ) );
+  const auto results = wapi->sign_and_broadcast_batch( ops, 1, 3, true );
+  BOOST_REQUIRE_EQUAL( results.size(), ops.size() );
+  for( size_t i = 0; i < results.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( results[i].first_operation, i );
+    BOOST_CHECK_EQUAL( results[i].error.valid(), i == 6 );
+    BOOST_CHECK_EQUAL( results[i].broadcast, i != 6 );
+  }
+
+  // The node took every broadcast transaction, they all make it into the next block:
+  generate_block();
+  BOOST_CHECK_EQUAL( get_dascoin_balance( custodian_id ), 210 - 7 );
+
+  // Without broadcast the signed transactions come back, referring to the head block and expiring after it:
+  const auto unsent = wapi->sign_and_broadcast_batch( { make_transfer(1), make_transfer(2) }, 1, 1, false );
+  BOOST_REQUIRE_EQUAL( unsent.size(), 2u );
+  for( const auto& result : unsent )
+  {
+    BOOST_REQUIRE( result.transaction.valid() );
+    BOOST_CHECK( !result.broadcast );
+    BOOST_CHECK_EQUAL( result.transaction->ref_block_num, db.head_block_num() & 0xffff );
+    BOOST_CHECK( result.transaction->expiration >= db.head_block_time() + 30 );
+  }
+  BOOST_CHECK( unsent[0].id != unsent[1].id );
+
+  // Their signatures hold when they are pushed later:
+  db.push_transaction( *unsent[0].transaction );
+  db.push_transaction( *unsent[1].transaction );
+  generate_block();
+  BOOST_CHECK_EQUAL( get_dascoin_balance( custodian_id ), 210 - 7 + 3 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::wallet_batch_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+
+# Load benchmark for the websocket API of a local node.
+#
+# Many clients issue heavy read-only queries (get_full_accounts, get_blocks, get_objects) while
+# the node keeps producing or receiving blocks.  Reports call latency percentiles and how far the
+# head block time falls behind the wall clock, run it against a node started with and without
+# --api-worker-threads to compare.
+#
+#   api_load_bench.py [ws://127.0.0.1:8090/] [clients] [seconds]
+
+import asyncio
+import calendar
+import json
+import random
+import sys
+import time
+
+try:
+    import websockets
+except ImportError:
+    print("websockets module not found (try pip install websockets)")
+    sys.exit(1)
+
+url = sys.argv[1] if len(sys.argv) > 1 else "ws://127.0.0.1:8090/"
+clients = int(sys.argv[2]) if len(sys.argv) > 2 else 50
+duration = float(sys.argv[3]) if len(sys.argv) > 3 else 60.0
+
+latencies = {}
+block_lag = []
+
+async def call(ws, call_id, method, params):
+    await ws.send(json.dumps({"id": call_id, "method": "call", "params": [0, method, params]}))
+    while True:
+        reply = json.loads(await ws.recv())
+        if reply.get("id") == call_id:
+            return reply
+
+async def client(seed, account_count, head_block):
+    rand = random.Random(seed)
+    async with websockets.connect(url, max_size=None) as ws:
+        call_id = 0
+        deadline = time.time() + duration
+        while time.time() < deadline:
+            call_id += 1
+            choice = rand.random()
+            if choice < 0.4:
+                accounts = ["1.2." + str(rand.randrange(0, account_count)) for _ in range(10)]
+                method, params = "get_full_accounts", [accounts, False]
+            elif choice < 0.7:
+                start = rand.randrange(1, max(2, head_block - 100))
+                method, params = "get_blocks", [start, 100]
+            else:
+                method, params = "get_objects", [["1.2." + str(rand.randrange(0, account_count)) for _ in range(50)]]
+            started = time.time()
+            await call(ws, call_id, method, params)
+            latencies.setdefault(method, []).append(time.time() - started)
+
+async def watch_head():
+    async with websockets.connect(url, max_size=None) as ws:
+        call_id = 0
+        deadline = time.time() + duration
+        while time.time() < deadline:
+            call_id += 1
+            reply = await call(ws, call_id, "get_dynamic_global_properties", [])
+            head_time = calendar.timegm(time.strptime(reply["result"]["time"], "%Y-%m-%dT%H:%M:%S"))
+            block_lag.append(time.time() - head_time)
+            await asyncio.sleep(1)
+
+async def main():
+    async with websockets.connect(url, max_size=None) as ws:
+        account_count = (await call(ws, 1, "get_account_count", []))["result"]
+        head_block = (await call(ws, 2, "get_dynamic_global_properties", []))["result"]["head_block_number"]
+    tasks = [client(seed, account_count, head_block) for seed in range(clients)]
+    tasks.append(watch_head())
+    await asyncio.gather(*tasks)
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p))]
+
+asyncio.get_event_loop().run_until_complete(main())
+
+print("%d clients, %.0f seconds against %s" % (clients, duration, url))
+for method, values in sorted(latencies.items()):
+    print("%-20s calls %7d  %7.1f/s  p50 %7.1f ms  p99 %7.1f ms" % (method, len(values), len(values) / duration,
+          percentile(values, 0.5) * 1000, percentile(values, 0.99) * 1000))
+if block_lag:
+    print("head block behind wall clock: p50 %.1f s  max %.1f s" % (percentile(block_lag, 0.5), max(block_lag)))